@@ -0,0 +1,514 @@
+/*
+Copyright (C) 1996-2001 Id Software, Inc.
+Copyright (C) 2002-2009 John Fitzgibbons and others
+Copyright (C) 2010-2014 QuakeSpasm developers
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+// bench.c -- microbenchmarks for engine kernels, "make bench"
+
+#include "quakedef.h"
+
+/*
+==============================================================================
+
+This takes the place of main_sdl.c in a separate executable.  It brings
+the engine up headless, so nothing touches the GPU, loads one map from
+the pak files and times the CPU kernels on its data:
+
+	quakebench [-basedir dir] [-game dir] [-benchmap e1m1] [-benchreps 5]
+
+Every kernel does the same number of passes over the same data on every
+run, so numbers from two builds can be compared directly.  Each repeat
+is timed on its own; the best and the mean of the repeats are reported.
+
+==============================================================================
+*/
+
+#define	BENCH_TRACES		4096
+#define	BENCH_MSGRECORDS	1024
+#define	BENCH_PAINTSAMPLES	512
+#define	BENCH_PAINTSOUNDS	8
+
+typedef struct
+{
+	byte	*data;		// 32 bit pixels
+	int		width, height;
+	byte	*crop;		// same image one texel smaller, for the resampler
+} benchtex_t;
+
+static qmodel_t		*bench_model;
+static vec3_t		bench_trace[BENCH_TRACES][2];
+static benchtex_t	*bench_tex;
+static int			bench_numtex;
+static byte			*bench_mipbuf;
+static byte			*bench_lightbuf;
+static sfx_t		*bench_sfx[BENCH_PAINTSOUNDS];
+static int			bench_numsfx;
+static sizebuf_t	bench_msg;
+static int			bench_reps = 5;
+
+static volatile int	bench_sink;	// keeps results alive
+
+static unsigned int	bench_seed;
+
+static float Bench_Random (void)
+{
+	bench_seed = bench_seed * 1103515245 + 12345;
+	return ((bench_seed >> 8) & 0xffff) / 65536.0f;
+}
+
+/*
+=================
+Bench_Run
+
+Times passes calls of func per repeat.  Each call returns the number of
+operations it did.
+=================
+*/
+static void Bench_Run (const char *name, int (*func) (void), int passes)
+{
+	Uint64	start, freq;
+	double	ns, best, total;
+	int		i, rep, ops;
+
+	freq = SDL_GetPerformanceFrequency ();
+	func ();	// warm up the caches
+
+	best = total = 0;
+	for (rep = 0; rep < bench_reps; rep++)
+	{
+		ops = 0;
+		start = SDL_GetPerformanceCounter ();
+		for (i = 0; i < passes; i++)
+			ops += func ();
+		ns = (double)(SDL_GetPerformanceCounter () - start) * 1e9 / freq;
+
+		if (!ops)
+		{
+			Sys_Printf ("%-24s no data\n", name);
+			return;
+		}
+		ns /= ops;
+		if (!rep || ns < best)
+			best = ns;
+		total += ns;
+	}
+
+	Sys_Printf ("%-24s %10.1f %10.1f ns/op %9i ops\n", name, best, total / bench_reps, ops);
+}
+
+//==============================================================================
+
+static int Bench_DecompressVis (void)
+{
+	int		i;
+
+	for (i = 1; i <= bench_model->numleafs; i++)
+		bench_sink += Mod_DecompressVis (bench_model->leafs[i].compressed_vis, bench_model)[0];
+
+	return bench_model->numleafs;
+}
+
+/*
+=================
+Bench_SetupTraces
+
+Player hull traces between the centres of random empty leafs.
+=================
+*/
+static void Bench_SetupTraces (void)
+{
+	mleaf_t	*leaf;
+	int		i, j, tries;
+
+	bench_seed = 1;
+	for (i = 0; i < BENCH_TRACES; i++)
+	{
+		for (j = 0; j < 2; j++)
+		{
+			for (tries = 0; tries < 100; tries++)
+			{
+				leaf = &bench_model->leafs[1 + (int)(Bench_Random () * bench_model->numleafs)];
+				if (leaf->contents == CONTENTS_EMPTY)
+					break;
+			}
+			bench_trace[i][j][0] = (leaf->minmaxs[0] + leaf->minmaxs[3]) * 0.5f;
+			bench_trace[i][j][1] = (leaf->minmaxs[1] + leaf->minmaxs[4]) * 0.5f;
+			bench_trace[i][j][2] = (leaf->minmaxs[2] + leaf->minmaxs[5]) * 0.5f;
+		}
+	}
+}
+
+static int Bench_HullCheck (void)
+{
+	hull_t	*hull;
+	trace_t	trace;
+	int		i;
+
+	hull = &bench_model->hulls[1];
+	for (i = 0; i < BENCH_TRACES; i++)
+	{
+		memset (&trace, 0, sizeof(trace));
+		trace.fraction = 1;
+		trace.allsolid = true;
+		VectorCopy (bench_trace[i][1], trace.endpos);
+		SV_RecursiveHullCheck (hull, hull->firstclipnode, 0, 1, bench_trace[i][0], bench_trace[i][1], &trace);
+		bench_sink += trace.allsolid;
+	}
+
+	return BENCH_TRACES;
+}
+
+static int Bench_BuildLightMap (void)
+{
+	msurface_t	*surf;
+	int		i, count, smax;
+
+	for (i = 0, count = 0; i < bench_model->numsurfaces; i++)
+	{
+		surf = &bench_model->surfaces[i];
+		if (surf->flags & SURF_DRAWTILED)
+			continue;
+		smax = (surf->extents[0]>>4)+1;
+		R_BuildLightMap (surf, bench_lightbuf, smax*lightmap_bytes);
+		count++;
+	}
+	bench_sink += bench_lightbuf[0];
+
+	return count;
+}
+
+/*
+=================
+Bench_SetupTextures
+
+32 bit copies of the map's textures.  Most are already power of two, so
+the resampler gets them one texel smaller on each side.
+=================
+*/
+static void Bench_SetupTextures (void)
+{
+	texture_t	*tx;
+	benchtex_t	*bt;
+	byte		*src;
+	int			i, j, maxsize;
+
+	bench_tex = (benchtex_t *) calloc (bench_model->numtextures, sizeof(benchtex_t));
+	maxsize = 0;
+
+	for (i = 0; i < bench_model->numtextures; i++)
+	{
+		tx = bench_model->textures[i];
+		if (!tx || tx->width < 2 || tx->height < 2)
+			continue;
+
+		bt = &bench_tex[bench_numtex++];
+		bt->width = tx->width;
+		bt->height = tx->height;
+		bt->data = (byte *) malloc (tx->width * tx->height * 4);
+		bt->crop = (byte *) malloc ((tx->width-1) * (tx->height-1) * 4);
+		if (!bt->data || !bt->crop)
+			Sys_Error ("Bench_SetupTextures: out of memory");
+
+		src = (byte *)(tx + 1);
+		for (j = 0; j < tx->width * tx->height; j++)
+			((unsigned *)bt->data)[j] = d_8to24table[src[j]];
+		for (j = 0; j < tx->height - 1; j++)
+			memcpy (bt->crop + j*(tx->width-1)*4, bt->data + j*tx->width*4, (tx->width-1)*4);
+
+		maxsize = q_max(maxsize, tx->width * tx->height * 4);
+	}
+
+	bench_mipbuf = (byte *) malloc (maxsize);
+	if (!bench_mipbuf)
+		Sys_Error ("Bench_SetupTextures: out of memory");
+}
+
+static int Bench_ResampleTexture (void)
+{
+	unsigned	*out;
+	int		i, mark;
+
+	for (i = 0; i < bench_numtex; i++)
+	{
+		mark = Hunk_LowMark ();
+		out = TexMgr_ResampleTexture ((unsigned *)bench_tex[i].crop, bench_tex[i].width - 1, bench_tex[i].height - 1, true);
+		bench_sink += out[0];
+		Hunk_FreeToLowMark (mark);
+	}
+
+	return bench_numtex;
+}
+
+/*
+=================
+Bench_MipMap
+
+The whole chain, the way TexMgr_LoadImage32 builds it.
+=================
+*/
+static int Bench_MipMap (void)
+{
+	int		i, mipwidth, mipheight;
+
+	for (i = 0; i < bench_numtex; i++)
+	{
+		mipwidth = bench_tex[i].width;
+		mipheight = bench_tex[i].height;
+		memcpy (bench_mipbuf, bench_tex[i].data, mipwidth * mipheight * 4);
+
+		while (mipwidth > 1 || mipheight > 1)
+		{
+			if (mipwidth > 1)
+			{
+				TexMgr_MipMapW ((unsigned *)bench_mipbuf, mipwidth, mipheight);
+				mipwidth >>= 1;
+			}
+			if (mipheight > 1)
+			{
+				TexMgr_MipMapH ((unsigned *)bench_mipbuf, mipwidth, mipheight);
+				mipheight >>= 1;
+			}
+		}
+		bench_sink += bench_mipbuf[0];
+	}
+
+	return bench_numtex;
+}
+
+static void Bench_SetupSounds (void)
+{
+	static const char *names[BENCH_PAINTSOUNDS] =
+	{
+		"ambience/water1.wav", "ambience/wind2.wav", "ambience/fire1.wav", "plats/train1.wav",
+		"weapons/guncock.wav", "weapons/lhit.wav", "weapons/r_exp3.wav", "items/r_item2.wav"
+	};
+	int		i;
+
+	for (i = 0; i < BENCH_PAINTSOUNDS; i++)
+	{
+		bench_sfx[bench_numsfx] = S_PrecacheSound (names[i]);
+		if (bench_sfx[bench_numsfx] && S_LoadSound (bench_sfx[bench_numsfx]))
+			bench_numsfx++;
+	}
+
+	memset (snd_channels, 0, sizeof(snd_channels));
+	total_channels = q_max(total_channels, bench_numsfx);
+}
+
+/*
+=================
+Bench_PaintChannels
+
+One call mixes BENCH_PAINTSAMPLES samples of every test sound into the
+DMA buffer.  Sounds that ran out are restarted first.
+=================
+*/
+static int Bench_PaintChannels (void)
+{
+	channel_t	*ch;
+	int		i;
+
+	if (!shm)
+		return 0;
+
+	for (i = 0; i < bench_numsfx; i++)
+	{
+		ch = &snd_channels[i];
+		if (ch->sfx)
+			continue;
+		ch->sfx = bench_sfx[i];
+		ch->leftvol = 160 + i * 8;
+		ch->rightvol = 220 - i * 8;
+		ch->pos = 0;
+		ch->end = paintedtime + S_LoadSound (ch->sfx)->length;
+	}
+
+	S_PaintChannels (paintedtime + BENCH_PAINTSAMPLES);
+
+	return 1;
+}
+
+static int Bench_ParseEntities (void)
+{
+	const char	*data;
+	int		tokens;
+
+	tokens = 0;
+	data = bench_model->entities;
+	while (data)
+	{
+		data = COM_Parse (data);
+		tokens++;
+	}
+
+	return tokens;
+}
+
+/*
+=================
+Bench_MsgWrite
+
+Records laid out like a fast entity update.
+=================
+*/
+static int Bench_MsgWrite (void)
+{
+	int		i;
+
+	SZ_Clear (&bench_msg);
+	for (i = 0; i < BENCH_MSGRECORDS; i++)
+	{
+		MSG_WriteByte (&bench_msg, 0x80 | (i & 0x7f));
+		MSG_WriteShort (&bench_msg, i);
+		MSG_WriteCoord (&bench_msg, i * 1.5f);
+		MSG_WriteCoord (&bench_msg, i * -2.25f);
+		MSG_WriteCoord (&bench_msg, 64.125f);
+		MSG_WriteAngle (&bench_msg, i * 7.0f);
+		MSG_WriteAngle (&bench_msg, i * 3.0f);
+		MSG_WriteLong (&bench_msg, i * 31);
+		MSG_WriteFloat (&bench_msg, i * 0.1f);
+		if (!(i & 15))
+			MSG_WriteString (&bench_msg, "player/land.wav");
+	}
+
+	return BENCH_MSGRECORDS;
+}
+
+static int Bench_MsgRead (void)
+{
+	sizebuf_t	save;
+	int		i;
+
+	save = net_message;
+	net_message = bench_msg;
+
+	MSG_BeginReading ();
+	for (i = 0; i < BENCH_MSGRECORDS; i++)
+	{
+		bench_sink += MSG_ReadByte ();
+		bench_sink += MSG_ReadShort ();
+		bench_sink += MSG_ReadCoord ();
+		bench_sink += MSG_ReadCoord ();
+		bench_sink += MSG_ReadCoord ();
+		bench_sink += MSG_ReadAngle ();
+		bench_sink += MSG_ReadAngle ();
+		bench_sink += MSG_ReadLong ();
+		bench_sink += MSG_ReadFloat ();
+		if (!(i & 15))
+			bench_sink += MSG_ReadString ()[0];
+	}
+
+	net_message = save;
+	return BENCH_MSGRECORDS;
+}
+
+//==============================================================================
+
+static void Bench_Main (void)
+{
+	const char	*mapname;
+	msurface_t	*surf;
+	int		i, maxsize;
+
+	i = COM_CheckParm ("-benchmap");
+	mapname = (i && i < com_argc-1) ? com_argv[i+1] : "e1m1";
+	i = COM_CheckParm ("-benchreps");
+	if (i && i < com_argc-1)
+		bench_reps = q_max(1, Q_atoi (com_argv[i+1]));
+
+	bench_model = Mod_ForName (va("maps/%s.bsp", mapname), false);
+	if (!bench_model || bench_model->type != mod_brush)
+		Sys_Error ("Couldn't load maps/%s.bsp", mapname);
+
+	// R_BuildLightMap works on the client's world, with styles at normal
+	// brightness and no dynamic lights
+	cl.worldmodel = bench_model;
+	r_framecount = 1;
+	if (!lightmap_bytes)
+		lightmap_bytes = 4;
+	for (i = 0; i < 256; i++)
+		d_lightstylevalue[i] = 264;
+	for (i = 0, maxsize = 0; i < bench_model->numsurfaces; i++)
+	{
+		surf = &bench_model->surfaces[i];
+		maxsize = q_max(maxsize, ((surf->extents[0]>>4)+1) * ((surf->extents[1]>>4)+1));
+	}
+	bench_lightbuf = (byte *) malloc (maxsize * lightmap_bytes);
+
+	bench_msg.data = (byte *) malloc (MAX_MSGLEN);
+	if (!bench_lightbuf || !bench_msg.data)
+		Sys_Error ("Bench_Main: out of memory");
+	bench_msg.maxsize = MAX_MSGLEN;
+	bench_msg.cursize = 0;
+	bench_msg.growsize = 0;
+
+	Bench_SetupTraces ();
+	Bench_SetupTextures ();
+	Bench_SetupSounds ();
+
+	Sys_Printf ("\nmaps/%s.bsp: %i leafs, %i surfaces, %i textures, %i sounds, best of %i\n",
+				mapname, bench_model->numleafs, bench_model->numsurfaces, bench_numtex, bench_numsfx, bench_reps);
+	Sys_Printf ("%-24s %10s %10s\n", "kernel", "best", "mean");
+
+	Bench_Run ("Mod_DecompressVis", Bench_DecompressVis, 20);
+	Bench_Run ("SV_RecursiveHullCheck", Bench_HullCheck, 20);
+	Bench_Run ("R_BuildLightMap", Bench_BuildLightMap, 20);
+	Bench_Run ("TexMgr_ResampleTexture", Bench_ResampleTexture, 5);
+	Bench_Run ("TexMgr_MipMap", Bench_MipMap, 10);
+	Bench_Run ("S_PaintChannels", Bench_PaintChannels, 200);
+	Bench_Run ("COM_Parse", Bench_ParseEntities, 20);
+	Bench_Run ("MSG_Write", Bench_MsgWrite, 200);
+	Bench_Run ("MSG_Read", Bench_MsgRead, 200);
+}
+
+#define DEFAULT_MEMORY (256 * 1024 * 1024)
+
+static quakeparms_t	parms;
+
+int main (int argc, char *argv[])
+{
+	host_parms = &parms;
+	parms.basedir = ".";
+
+	parms.argc = argc;
+	parms.argv = argv;
+
+	COM_InitArgv (parms.argc, parms.argv);
+
+	isDedicated = false;
+	isHeadless = true;
+
+	if (SDL_Init (0) < 0)
+		Sys_Error ("Couldn't init SDL: %s", SDL_GetError ());
+	atexit (SDL_Quit);
+
+	Sys_Init ();
+
+	parms.memsize = DEFAULT_MEMORY;
+	parms.membase = malloc (parms.memsize);
+	if (!parms.membase)
+		Sys_Error ("Not enough memory free; check disk space\n");
+
+	Host_Init ();
+
+	Bench_Main ();
+
+	Sys_Quit ();
+	return 0;
+}
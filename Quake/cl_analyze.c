@@ -0,0 +1,822 @@
+/*
+Copyright (C) 1996-2001 Id Software, Inc.
+Copyright (C) 2002-2009 John Fitzgibbons and others
+Copyright (C) 2010-2014 QuakeSpasm developers
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+// cl_analyze.c -- batch demo statistics, parsed in parallel
+
+#include "quakedef.h"
+
+#if defined(SDL_FRAMEWORK) || defined(NO_SDL_CONFIG)
+#include <SDL2/SDL.h>
+#else
+#include "SDL.h"
+#endif
+
+/*
+==============================================================================
+
+Reads a list of demos on a pool of worker threads and writes one JSON
+array with an object per demo, holding an object per map played in it.
+
+The client parser works on the global cl and net_message and reaches
+into the renderer and sound, so it can't run more than once at a time.
+The workers walk the messages with CL_MessageLayout, which works out
+where each one ends from its bytes alone, and read only what the
+statistics need (scores, player origins, stats, the POV player's health)
+into a per-demo context.  Workers never print or raise errors; a demo
+that can't be read or runs out of memory gets an "error" member and the
+batch goes on.
+
+	vkquake -analyze stats.json match*.dem [-threads 8]
+	demo_analyze stats.json match1 match2
+
+==============================================================================
+*/
+
+#define	DA_TRACK_INTERVAL	1.0		// seconds between samples of the POV player's origin
+#define	DA_TELEPORT_DIST	256		// moves longer than this in one update don't count as distance
+
+typedef struct
+{
+	char	*data;
+	size_t	len, max;
+	qboolean	failed;		// out of memory, the text is cut short
+} dabuf_t;
+
+typedef struct
+{
+	char	name[MAX_SCOREBOARDNAME];
+	int		frags;
+	int		kills;
+	int		suicides;
+	vec3_t	baseline;
+	vec3_t	origin;
+	qboolean	seen;
+	float	distance;
+} daplayer_t;
+
+typedef struct
+{
+// reader
+	byte	*data;
+	int		size;
+	int		readcount;
+	char	string[2048];
+
+// demo
+	dabuf_t	*out;
+	int		messages;
+	int		nummaps;
+	const char	*error;
+
+// current map
+	qboolean	inmap;
+	int		protocol;
+	int		signon;
+	int		maxclients;
+	int		viewentity;
+	char	mapname[MAX_QPATH];
+	char	title[128];
+	double	time, starttime, intermission;
+	int		stats[MAX_CL_STATS];
+	int		health;
+	int		deaths;
+	daplayer_t	players[MAX_SCOREBOARD];
+	dabuf_t	track;
+	double	nextsample;
+} dactx_t;
+
+typedef struct
+{
+	const char	*name;
+	char		*result;
+	SDL_atomic_t	done;
+} dajob_t;
+
+static dajob_t		*da_jobs;
+static int			da_numjobs;
+static SDL_atomic_t	da_nextjob;
+
+/*
+==============================================================================
+
+OUTPUT
+
+==============================================================================
+*/
+
+static void DA_Printf (dabuf_t *buf, const char *fmt, ...) __attribute__((__format__(__printf__,2,3)));
+static void DA_Printf (dabuf_t *buf, const char *fmt, ...)
+{
+	va_list	argptr;
+	char	*data;
+	size_t	max;
+	int		len;
+
+	if (buf->failed)
+		return;
+
+	for (;;)
+	{
+		va_start (argptr, fmt);
+		len = q_vsnprintf (buf->data + buf->len, buf->max - buf->len, fmt, argptr);
+		va_end (argptr);
+
+		if (buf->data && len >= 0 && (size_t)len < buf->max - buf->len)
+			break;
+
+		max = buf->max ? buf->max * 2 : 4096;
+		data = (char *) realloc (buf->data, max);
+		if (!data)
+		{
+			buf->failed = true;	// runs on a worker, DA_WorkerThread reports it
+			return;
+		}
+		buf->data = data;
+		buf->max = max;
+	}
+	buf->len += len;
+}
+
+/* Quake strings use the high bit for colored text and carry no escaping */
+static void DA_String (dabuf_t *buf, const char *s)
+{
+	int	c;
+
+	DA_Printf (buf, "\"");
+	for ( ; *s; s++)
+	{
+		c = *s & 127;
+		if (c == '"' || c == '\\')
+			DA_Printf (buf, "\\%c", c);
+		else if (c < 32 || c == 127)
+			DA_Printf (buf, "\\u%04x", c);
+		else
+			DA_Printf (buf, "%c", c);
+	}
+	DA_Printf (buf, "\"");
+}
+
+/*
+==============================================================================
+
+MESSAGE READER
+
+Same encoding as the MSG_Read functions in common.c, on the context.
+CL_MessageLayout has already checked that the message is all there.
+
+==============================================================================
+*/
+
+static int DA_ReadByte (dactx_t *ctx)
+{
+	if (ctx->readcount + 1 > ctx->size)
+		return -1;
+	return ctx->data[ctx->readcount++];
+}
+
+static int DA_ReadShort (dactx_t *ctx)
+{
+	int	c;
+
+	if (ctx->readcount + 2 > ctx->size)
+		return -1;
+	c = (short)(ctx->data[ctx->readcount] + (ctx->data[ctx->readcount + 1] << 8));
+	ctx->readcount += 2;
+	return c;
+}
+
+static int DA_ReadLong (dactx_t *ctx)
+{
+	int	c;
+
+	if (ctx->readcount + 4 > ctx->size)
+		return -1;
+	c = ctx->data[ctx->readcount]
+		+ (ctx->data[ctx->readcount + 1] << 8)
+		+ (ctx->data[ctx->readcount + 2] << 16)
+		+ (ctx->data[ctx->readcount + 3] << 24);
+	ctx->readcount += 4;
+	return c;
+}
+
+static float DA_ReadFloat (dactx_t *ctx)
+{
+	union
+	{
+		byte	b[4];
+		float	f;
+		int	l;
+	} dat;
+
+	if (ctx->readcount + 4 > ctx->size)
+		return -1;
+	memcpy (dat.b, ctx->data + ctx->readcount, 4);
+	ctx->readcount += 4;
+	dat.l = LittleLong (dat.l);
+	return dat.f;
+}
+
+static const char *DA_ReadString (dactx_t *ctx)
+{
+	int	c, l;
+
+	l = 0;
+	do
+	{
+		c = DA_ReadByte (ctx);
+		if (c == -1 || c == 0)
+			break;
+		ctx->string[l++] = c;
+	} while (l < (int)sizeof(ctx->string) - 1);
+	ctx->string[l] = 0;
+
+	return ctx->string;
+}
+
+static float DA_ReadCoord (dactx_t *ctx)
+{
+	return DA_ReadShort (ctx) * (1.0 / 8);
+}
+
+/*
+==============================================================================
+
+PARSING
+
+==============================================================================
+*/
+
+static daplayer_t *DA_Player (dactx_t *ctx, int num)
+{
+	if (num < 1 || num > ctx->maxclients)
+		return NULL;
+	return &ctx->players[num - 1];
+}
+
+static void DA_BeginMap (dactx_t *ctx)
+{
+	memset (ctx->players, 0, sizeof(ctx->players));
+	memset (ctx->stats, 0, sizeof(ctx->stats));
+	ctx->track.len = 0;
+	ctx->signon = 0;
+	ctx->viewentity = 0;
+	ctx->time = ctx->starttime = ctx->intermission = 0;
+	ctx->health = 0;
+	ctx->deaths = 0;
+	ctx->nextsample = 0;
+	ctx->inmap = true;
+}
+
+static void DA_EndMap (dactx_t *ctx)
+{
+	daplayer_t	*p;
+	int			i, n;
+
+	if (!ctx->inmap)
+		return;
+	ctx->inmap = false;
+
+	DA_Printf (ctx->out, "%s\n\t\t{ \"map\": ", ctx->nummaps++ ? "," : "");
+	DA_String (ctx->out, ctx->mapname);
+	DA_Printf (ctx->out, ", \"title\": ");
+	DA_String (ctx->out, ctx->title);
+	DA_Printf (ctx->out, ", \"protocol\": %i, \"start\": %.2f, \"end\": %.2f, ", ctx->protocol, ctx->starttime, ctx->time);
+	if (ctx->intermission)
+		DA_Printf (ctx->out, "\"intermission\": %.2f,\n", ctx->intermission);
+	else
+		DA_Printf (ctx->out, "\"intermission\": null,\n");
+	DA_Printf (ctx->out, "\t\t  \"monsters\": %i, \"total_monsters\": %i, \"secrets\": %i, \"total_secrets\": %i, \"deaths\": %i,\n",
+			ctx->stats[STAT_MONSTERS], ctx->stats[STAT_TOTALMONSTERS], ctx->stats[STAT_SECRETS], ctx->stats[STAT_TOTALSECRETS], ctx->deaths);
+
+	DA_Printf (ctx->out, "\t\t  \"players\": [");
+	for (i = 0, n = 0; i < ctx->maxclients; i++)
+	{
+		p = &ctx->players[i];
+		if (!p->name[0])
+			continue;
+		DA_Printf (ctx->out, "%s\n\t\t\t{ \"slot\": %i, \"name\": ", n++ ? "," : "", i);
+		DA_String (ctx->out, p->name);
+		DA_Printf (ctx->out, ", \"frags\": %i, \"kills\": %i, \"suicides\": %i, \"distance\": %.0f }",
+				p->frags, p->kills, p->suicides, p->distance);
+	}
+	DA_Printf (ctx->out, " ],\n");
+
+	if (ctx->track.failed)
+		ctx->out->failed = true;	// a track cut short isn't valid JSON
+	DA_Printf (ctx->out, "\t\t  \"track\": [%s] }", ctx->track.len ? ctx->track.data : "");
+}
+
+static void DA_ParseServerInfo (dactx_t *ctx)
+{
+	DA_EndMap (ctx);
+	DA_BeginMap (ctx);
+
+	ctx->protocol = DA_ReadLong (ctx);
+	if (ctx->protocol != PROTOCOL_NETQUAKE && ctx->protocol != PROTOCOL_FITZQUAKE)
+	{
+		ctx->error = "unknown protocol";
+		return;
+	}
+	ctx->maxclients = DA_ReadByte (ctx);
+	if (ctx->maxclients < 1 || ctx->maxclients > MAX_SCOREBOARD)
+	{
+		ctx->error = "bad maxclients";
+		return;
+	}
+	DA_ReadByte (ctx);	// gametype
+	q_strlcpy (ctx->title, DA_ReadString (ctx), sizeof(ctx->title));
+
+// the world is the first model, keep its name
+	COM_FileBase (DA_ReadString (ctx), ctx->mapname, sizeof(ctx->mapname));
+}
+
+static void DA_ParseUpdate (dactx_t *ctx, int start, const svclayout_t *layout)
+{
+	daplayer_t	*p;
+	vec3_t		org, move;
+	float		dist;
+	int			i;
+
+	if (ctx->signon == SIGNONS - 1)
+		ctx->signon = SIGNONS;
+
+	p = DA_Player (ctx, layout->entity);
+	if (!p)
+		return;
+
+	for (i = 0; i < 3; i++)
+	{
+		if (layout->origin[i] < 0)
+		{
+			org[i] = p->baseline[i];
+			continue;
+		}
+		ctx->readcount = start + layout->origin[i];
+		org[i] = DA_ReadCoord (ctx);
+	}
+
+	if (p->seen)
+	{
+		VectorSubtract (org, p->origin, move);
+		dist = VectorLength (move);
+		if (dist < DA_TELEPORT_DIST)
+			p->distance += dist;
+	}
+	VectorCopy (org, p->origin);
+	p->seen = true;
+}
+
+static void DA_ParseBaseline (dactx_t *ctx, int start, const svclayout_t *layout)
+{
+	daplayer_t	*p;
+	int			i;
+
+	p = DA_Player (ctx, layout->entity);
+	if (!p)
+		return;
+
+	for (i = 0; i < 3; i++)
+	{
+		ctx->readcount = start + layout->origin[i];
+		p->baseline[i] = DA_ReadCoord (ctx);
+	}
+}
+
+static void DA_ParseClientdata (dactx_t *ctx, int start, const svclayout_t *layout)
+{
+	int	health;
+
+	ctx->readcount = start + layout->health;
+	health = DA_ReadShort (ctx);
+
+	if (health <= 0 && ctx->health > 0 && ctx->signon == SIGNONS)
+		ctx->deaths++;
+	ctx->health = health;
+}
+
+static void DA_UpdateFrags (dactx_t *ctx, int slot, int frags)
+{
+	daplayer_t	*p;
+
+	if (slot >= ctx->maxclients)
+		return;
+	p = &ctx->players[slot];
+
+// scores sent during the signon are the state so far, not events
+	if (ctx->signon >= SIGNONS - 1)
+	{
+		if (frags > p->frags)
+			p->kills += frags - p->frags;
+		else
+			p->suicides += p->frags - frags;
+	}
+	p->frags = frags;
+}
+
+/*
+==================
+DA_ParseMessage
+
+CL_MessageLayout finds where each message ends and where its fields are,
+so only the messages the statistics use are read here
+==================
+*/
+static void DA_ParseMessage (dactx_t *ctx)
+{
+	svclayout_t	layout;
+	daplayer_t	*p;
+	int			cmd, start, i;
+
+	ctx->readcount = 0;
+
+	while (!ctx->error)
+	{
+		cmd = DA_ReadByte (ctx);
+		if (cmd == -1)
+			break;
+
+		start = ctx->readcount;
+		if (!CL_MessageLayout (ctx->data + start, ctx->size - start, cmd, ctx->protocol, &layout))
+		{
+			ctx->error = "bad message";
+			return;
+		}
+
+		if (cmd & U_SIGNAL)
+		{
+			if (!ctx->inmap)
+			{
+				ctx->error = "entity update before serverinfo";
+				return;
+			}
+			DA_ParseUpdate (ctx, start, &layout);
+			ctx->readcount = start + layout.size;
+			continue;
+		}
+
+		switch (cmd)
+		{
+		case svc_killedmonster:
+			ctx->stats[STAT_MONSTERS]++;
+			break;
+
+		case svc_foundsecret:
+			ctx->stats[STAT_SECRETS]++;
+			break;
+
+		case svc_disconnect:
+			layout.size = ctx->size - start;
+			break;
+
+		case svc_time:
+			ctx->time = DA_ReadFloat (ctx);
+			if (!ctx->starttime)
+				ctx->starttime = ctx->time;
+			break;
+
+		case svc_clientdata:
+			DA_ParseClientdata (ctx, start, &layout);
+			break;
+
+		case svc_version:
+			ctx->protocol = DA_ReadLong (ctx);
+			break;
+
+		case svc_finale:
+		case svc_cutscene:
+		case svc_intermission:
+			if (!ctx->intermission)
+				ctx->intermission = ctx->time;
+			break;
+
+		case svc_serverinfo:
+			DA_ParseServerInfo (ctx);
+			break;
+
+		case svc_setview:
+			ctx->viewentity = DA_ReadShort (ctx);
+			break;
+
+		case svc_updatename:
+			i = DA_ReadByte (ctx);
+			DA_ReadString (ctx);
+			if (i >= 0 && i < ctx->maxclients)
+				q_strlcpy (ctx->players[i].name, ctx->string, MAX_SCOREBOARDNAME);
+			break;
+
+		case svc_updatefrags:
+			i = DA_ReadByte (ctx);
+			DA_UpdateFrags (ctx, i, DA_ReadShort (ctx));
+			break;
+
+		case svc_spawnbaseline:
+		case svc_spawnbaseline2:
+			DA_ParseBaseline (ctx, start, &layout);
+			break;
+
+		case svc_signonnum:
+			ctx->signon = DA_ReadByte (ctx);
+			break;
+
+		case svc_updatestat:
+			i = DA_ReadByte (ctx);
+			if (i < 0 || i >= MAX_CL_STATS)
+			{
+				ctx->error = "bad stat";
+				return;
+			}
+			ctx->stats[i] = DA_ReadLong (ctx);
+			break;
+		}
+
+		ctx->readcount = start + layout.size;
+	}
+
+// sample the POV player's path once per interval of demo time
+	p = DA_Player (ctx, ctx->viewentity);
+	if (p && p->seen && ctx->signon == SIGNONS && ctx->time >= ctx->nextsample)
+	{
+		DA_Printf (&ctx->track, "%s[%.1f,%.0f,%.0f,%.0f]", ctx->track.len ? "," : "",
+				ctx->time, p->origin[0], p->origin[1], p->origin[2]);
+		ctx->nextsample = ctx->time + DA_TRACK_INTERVAL;
+	}
+}
+
+/*
+==================
+DA_AnalyzeDemo
+
+Appends the JSON object for one demo to out
+==================
+*/
+static void DA_AnalyzeDemo (const char *name, dabuf_t *out)
+{
+	char		path[MAX_OSPATH];
+	dactx_t		*ctx;
+	FILE		*f;
+	long		bytes;
+	int			len, c, i;
+	float		angles[3];
+
+	DA_Printf (out, "\t{ \"file\": ");
+	DA_String (out, name);
+
+// try the name as given, then in the game directory like playdemo
+	q_strlcpy (path, name, sizeof(path));
+	f = fopen (path, "rb");
+	if (!f)
+	{
+		q_snprintf (path, sizeof(path), "%s/%s", com_gamedir, name);
+		COM_AddExtension (path, ".dem", sizeof(path));
+		f = fopen (path, "rb");
+	}
+	if (!f)
+	{
+		DA_Printf (out, ", \"error\": \"couldn't open\" }");
+		return;
+	}
+
+	ctx = (dactx_t *) calloc (1, sizeof(dactx_t));
+	if (ctx)
+		ctx->data = (byte *) malloc (MAX_MSGLEN);
+	if (!ctx || !ctx->data)
+	{
+		free (ctx);
+		fclose (f);
+		out->failed = true;
+		return;
+	}
+	ctx->out = out;
+
+// skip the cd track line
+	for (i = 0; i < 13; i++)
+	{
+		c = getc (f);
+		if (c == '\n' || c == EOF)
+			break;
+	}
+	if (c != '\n')
+		ctx->error = "not a demo";
+
+	DA_Printf (out, ", \"maps\": [");
+	while (!ctx->error)
+	{
+		if (fread (&len, 4, 1, f) != 1 || fread (angles, 4, 3, f) != 3)
+			break;
+		len = LittleLong (len);
+		if (len < 0 || len > MAX_MSGLEN)
+		{
+			ctx->error = "message > MAX_MSGLEN";
+			break;
+		}
+		if (len && fread (ctx->data, len, 1, f) != 1)
+			break;	// cut short, count what we have
+		ctx->size = len;
+		ctx->messages++;
+		DA_ParseMessage (ctx);
+	}
+	DA_EndMap (ctx);
+	bytes = ftell (f);
+	fclose (f);
+
+	DA_Printf (out, " ],\n\t  \"messages\": %i, \"bytes\": %ld", ctx->messages, bytes);
+	if (ctx->error)
+	{
+		DA_Printf (out, ", \"error\": ");
+		DA_String (out, ctx->error);
+	}
+	DA_Printf (out, " }");
+
+	free (ctx->track.data);
+	free (ctx->data);
+	free (ctx);
+}
+
+static int SDLCALL DA_WorkerThread (void *unused)
+{
+	dabuf_t	out;
+	int		i;
+
+	for (;;)
+	{
+		i = SDL_AtomicAdd (&da_nextjob, 1);
+		if (i >= da_numjobs)
+			return 0;
+
+		memset (&out, 0, sizeof(out));
+		DA_AnalyzeDemo (da_jobs[i].name, &out);
+		if (out.failed)
+		{
+			// replace what was written with an error object, if even that
+			// doesn't fit the result stays NULL and CL_AnalyzeDemos quits
+			free (out.data);
+			memset (&out, 0, sizeof(out));
+			DA_Printf (&out, "\t{ \"file\": ");
+			DA_String (&out, da_jobs[i].name);
+			DA_Printf (&out, ", \"error\": \"out of memory\" }");
+			if (out.failed)
+			{
+				free (out.data);
+				out.data = NULL;
+			}
+		}
+		da_jobs[i].result = out.data;
+		SDL_AtomicSet (&da_jobs[i].done, 1);
+	}
+}
+
+/*
+==================
+CL_AnalyzeDemos
+
+Runs the workers and writes the results in the order of the list, as
+soon as each one is ready
+==================
+*/
+void CL_AnalyzeDemos (const char *output, const char **names, int count, int threads)
+{
+	SDL_Thread	*workers[64];
+	FILE		*f;
+	double		start;
+	int			i, numworkers, next;
+
+	if (count <= 0)
+		return;
+
+	f = fopen (output, "w");
+	if (!f)
+	{
+		Con_Printf ("ERROR: couldn't open %s\n", output);
+		return;
+	}
+
+	if (threads <= 0)
+		threads = SDL_GetCPUCount ();
+	threads = CLAMP (1, threads, (int)(sizeof(workers) / sizeof(workers[0])));
+	threads = q_min (threads, count);
+
+	da_jobs = (dajob_t *) calloc (count, sizeof(dajob_t));
+	if (!da_jobs)
+		Sys_Error ("CL_AnalyzeDemos: out of memory");
+	for (i = 0; i < count; i++)
+		da_jobs[i].name = names[i];
+	da_numjobs = count;
+	SDL_AtomicSet (&da_nextjob, 0);
+
+	Con_Printf ("Analyzing %i demos on %i threads\n", count, threads);
+	start = Sys_DoubleTime ();
+
+	for (numworkers = 0; numworkers < threads; numworkers++)
+	{
+		workers[numworkers] = SDL_CreateThread (DA_WorkerThread, "DemoAnalyze", NULL);
+		if (!workers[numworkers])
+			break;
+	}
+	if (!numworkers)
+		DA_WorkerThread (NULL);	// no threads, do it all here
+
+	fprintf (f, "[\n");
+	for (next = 0; next < count; )
+	{
+		if (!SDL_AtomicGet (&da_jobs[next].done))
+		{
+			SDL_Delay (5);
+			continue;
+		}
+		if (!da_jobs[next].result)
+			Sys_Error ("CL_AnalyzeDemos: out of memory");
+		fprintf (f, "%s%s", da_jobs[next].result, (next < count - 1) ? ",\n" : "\n");
+		free (da_jobs[next].result);
+		next++;
+		if (next % 100 == 0)
+			Con_Printf ("%i/%i demos\n", next, count);
+	}
+	fprintf (f, "]\n");
+	fclose (f);
+
+	for (i = 0; i < numworkers; i++)
+		SDL_WaitThread (workers[i], NULL);
+
+	free (da_jobs);
+	da_jobs = NULL;
+	da_numjobs = 0;
+
+	Con_Printf ("Analyzed %i demos in %.1f seconds, wrote %s\n", count, Sys_DoubleTime () - start, output);
+}
+
+/*
+==================
+CL_AnalyzeDemos_f
+
+demo_analyze <output> <demo> [demo ...]
+==================
+*/
+void CL_AnalyzeDemos_f (void)
+{
+	const char	**names;
+	int			i;
+
+	if (Cmd_Argc() < 3)
+	{
+		Con_Printf ("demo_analyze <output.json> <demo> [demo ...] : write statistics for demos\n");
+		return;
+	}
+
+	names = (const char **) malloc ((Cmd_Argc() - 2) * sizeof(char *));
+	if (!names)
+		Sys_Error ("CL_AnalyzeDemos_f: out of memory");
+	for (i = 2; i < Cmd_Argc(); i++)
+		names[i - 2] = Cmd_Argv(i);
+	CL_AnalyzeDemos (Cmd_Argv(1), names, Cmd_Argc() - 2, 0);
+	free (names);
+}
+
+/*
+==================
+CL_AnalyzeCommandLine
+
+-analyze <output> <demo> [demo ...] [-threads n]
+The demo list ends at the next option.
+==================
+*/
+void CL_AnalyzeCommandLine (void)
+{
+	int		i, first, count, threads;
+
+	i = COM_CheckParm ("-analyze");
+	if (!i || i + 2 >= com_argc)
+	{
+		Con_Printf ("-analyze <output.json> <demo> [demo ...] [-threads n]\n");
+		return;
+	}
+
+	first = i + 2;
+	for (count = 0; first + count < com_argc; count++)
+	{
+		if (com_argv[first + count][0] == '-' || com_argv[first + count][0] == '+')
+			break;
+	}
+
+	i = COM_CheckParm ("-threads");
+	threads = (i && i + 1 < com_argc) ? Q_atoi (com_argv[i + 1]) : 0;
+
+	CL_AnalyzeDemos (com_argv[first - 1], (const char **) &com_argv[first], count, threads);
+}
@@ -0,0 +1,348 @@
+/*
+Copyright (C) 1996-2001 Id Software, Inc.
+Copyright (C) 2002-2009 John Fitzgibbons and others
+Copyright (C) 2010-2014 QuakeSpasm developers
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+// cl_bots.c -- headless network clients for server load tests
+
+#include "quakedef.h"
+
+/*
+==============================================================================
+
+Bots are bare network connections that go through the normal signon
+(prespawn, spawn, begin) and then send a clc_move every host frame, the
+same way CL_SendMove does.  They never parse the game state beyond what
+they need: the protocol from svc_serverinfo, to pick the angle encoding,
+and svc_time, to echo back for ping.  Movement follows a fixed script
+keyed on the bot number and its time in game, so two runs against the
+same map load the server the same way.
+
+Connecting blocks like "connect" does, so bots are meant to run in a
+dedicated server process of their own, started with something like
+	vkquake -dedicated +bots_connect 32 192.168.0.10
+Combine with net_fakelag and friends to load the server through a bad
+network, and with host_loadreport on the server to see what it costs.
+
+==============================================================================
+*/
+
+#define	MAX_BOTS	255
+
+typedef struct
+{
+	struct qsocket_s	*netcon;
+	int		protocol;		// 0 until the server info arrived
+	int		signon;			// signon commands sent so far
+	float	servertime;		// last svc_time, echoed back for ping
+	double	jointime;
+} bot_t;
+
+static bot_t	bots[MAX_BOTS];
+static int		numbots;
+
+static cvar_t	bots_report = {"bots_report", "10", CVAR_NONE};	// seconds between traffic reports, 0 = off
+
+static int		bot_moves;
+static int		bot_reliables;
+static int		bot_datagrams;
+static double	bot_reporttime;
+static netstats_t	bot_laststats;
+
+int CL_NumBots (void)
+{
+	return numbots;
+}
+
+static void Bot_Drop (int num)
+{
+	sizebuf_t	buf;
+	byte		data[8];
+	bot_t		*bot;
+
+	bot = &bots[num];
+
+	buf.data = data;
+	buf.maxsize = sizeof(data);
+	buf.cursize = 0;
+	buf.growsize = 0;
+	MSG_WriteByte (&buf, clc_disconnect);
+	NET_SendUnreliableMessage (bot->netcon, &buf);
+	NET_Close (bot->netcon);
+
+	// keep the list packed, bot numbers are only used for the script
+	*bot = bots[--numbots];
+	memset (&bots[numbots], 0, sizeof(bot_t));
+}
+
+/*
+=================
+Bot_ParseServerInfo
+
+The first reliable message is svc_print with the version banner followed
+by svc_serverinfo.
+=================
+*/
+static void Bot_ParseServerInfo (bot_t *bot)
+{
+	int		cmd;
+
+	MSG_BeginReading ();
+	while (!msg_badread)
+	{
+		cmd = MSG_ReadByte ();
+		if (cmd == svc_print)
+			MSG_ReadString ();
+		else if (cmd == svc_serverinfo)
+		{
+			bot->protocol = MSG_ReadLong ();
+			return;
+		}
+		else
+			break;
+	}
+
+	Con_Printf ("bot: no server info, assuming protocol %i\n", PROTOCOL_FITZQUAKE);
+	bot->protocol = PROTOCOL_FITZQUAKE;
+}
+
+static void Bot_SendSignon (bot_t *bot, int num)
+{
+	sizebuf_t	buf;
+	byte		data[128];
+
+	buf.data = data;
+	buf.maxsize = sizeof(data);
+	buf.cursize = 0;
+	buf.growsize = 0;
+
+	switch (bot->signon)
+	{
+	case 0:
+		MSG_WriteByte (&buf, clc_stringcmd);
+		MSG_WriteString (&buf, "prespawn");
+		break;
+	case 1:
+		MSG_WriteByte (&buf, clc_stringcmd);
+		MSG_WriteString (&buf, va("name \"bot%i\"\n", num));
+		MSG_WriteByte (&buf, clc_stringcmd);
+		MSG_WriteString (&buf, va("color %i %i\n", num & 15, (num >> 4) & 15));
+		MSG_WriteByte (&buf, clc_stringcmd);
+		MSG_WriteString (&buf, "spawn");
+		break;
+	case 2:
+		MSG_WriteByte (&buf, clc_stringcmd);
+		MSG_WriteString (&buf, "begin");
+		bot->jointime = realtime;
+		break;
+	}
+
+	if (NET_SendMessage (bot->netcon, &buf) == 1)
+		bot->signon++;
+}
+
+/*
+=================
+Bot_SendMove
+
+Runs forward while turning, strafes back and forth, and jumps and fires
+now and then.
+=================
+*/
+static void Bot_SendMove (bot_t *bot, int num)
+{
+	sizebuf_t	buf;
+	byte		data[128];
+	usercmd_t	cmd;
+	vec3_t		angles;
+	double		t;
+	int			buttons;
+
+	t = realtime - bot->jointime;
+
+	memset (&cmd, 0, sizeof(cmd));
+	cmd.forwardmove = 200;
+	cmd.sidemove = (((int)(t * 0.5) + num) & 1) ? 350 : -350;
+
+	angles[PITCH] = 0;
+	angles[YAW] = anglemod (num * 37 + t * 45);
+	angles[ROLL] = 0;
+
+	buttons = 0;
+	if (((int)t + num) % 3 == 0)
+		buttons |= 1;
+	if (((int)(t * 2) + num) % 4 == 0)
+		buttons |= 2;
+
+	buf.data = data;
+	buf.maxsize = sizeof(data);
+	buf.cursize = 0;
+	buf.growsize = 0;
+	CL_WriteMove (&buf, &cmd, angles, bot->servertime, bot->protocol, buttons, 0);
+
+	NET_SendUnreliableMessage (bot->netcon, &buf);
+	bot_moves++;
+}
+
+static void Bot_Report (void)
+{
+	netstats_t	stats;
+	double		span;
+	int			i, ingame;
+
+	if (bots_report.value <= 0 || !numbots)
+		return;
+	if (realtime < bot_reporttime)
+		return;
+
+	span = bots_report.value;
+	NET_GetStats (&stats);
+	if (bot_reporttime)
+	{
+		for (i = 0, ingame = 0; i < numbots; i++)
+			if (bots[i].signon == 3)
+				ingame++;
+
+		Con_Printf ("bots: %i/%i in game, %.0f moves/s, in %.1f kB/s (%i reliable, %i datagrams), out %.1f kB/s, %i resent\n",
+					ingame, numbots, bot_moves / span,
+					(stats.bytesreceived - bot_laststats.bytesreceived) / (1024 * span), bot_reliables, bot_datagrams,
+					(stats.bytessent - bot_laststats.bytessent) / (1024 * span),
+					stats.packetsresent - bot_laststats.packetsresent);
+	}
+
+	bot_laststats = stats;
+	bot_moves = bot_reliables = bot_datagrams = 0;
+	bot_reporttime = realtime + span;
+}
+
+/*
+=================
+CL_RunBots
+
+Called every host frame.
+=================
+*/
+void CL_RunBots (void)
+{
+	bot_t	*bot;
+	int		i, ret;
+
+	for (i = 0; i < numbots; i++)
+	{
+		bot = &bots[i];
+
+		while ((ret = NET_GetMessage (bot->netcon)) > 0)
+		{
+			if (ret == 1)
+			{
+				bot_reliables++;
+				if (!bot->protocol)
+					Bot_ParseServerInfo (bot);
+			}
+			else
+			{
+				bot_datagrams++;
+				MSG_BeginReading ();
+				if (MSG_ReadByte () == svc_time)
+					bot->servertime = MSG_ReadFloat ();
+			}
+		}
+
+		if (ret == -1)
+		{
+			Con_Printf ("bot%i: lost server connection\n", i);
+			Bot_Drop (i--);
+			continue;
+		}
+
+		if (!bot->protocol)
+			continue;
+		if (bot->signon < 3)
+		{
+			if (NET_CanSendMessage (bot->netcon))
+				Bot_SendSignon (bot, i);
+			continue;
+		}
+
+		Bot_SendMove (bot, i);
+	}
+
+	Bot_Report ();
+}
+
+/*
+=================
+CL_Bots_Connect_f
+
+bots_connect <count> [host]
+=================
+*/
+static void CL_Bots_Connect_f (void)
+{
+	const char	*host;
+	struct qsocket_s	*sock;
+	int		i, count;
+
+	if (Cmd_Argc() < 2)
+	{
+		Con_Printf ("bots_connect <count> [host] : connect headless clients\n");
+		return;
+	}
+
+	count = Q_atoi (Cmd_Argv(1));
+	host = (Cmd_Argc() > 2) ? Cmd_Argv(2) : "localhost";
+	if (count > MAX_BOTS - numbots)
+		count = MAX_BOTS - numbots;
+	if (count <= 0)
+	{
+		Con_Printf ("%i bots already connected\n", numbots);
+		return;
+	}
+
+	NET_AddQSockets (count);
+
+	for (i = 0; i < count; i++)
+	{
+		sock = NET_ConnectDirect (host);
+		if (!sock)
+		{
+			Con_Printf ("bots_connect: only %i of %i bots connected\n", i, count);
+			break;
+		}
+		memset (&bots[numbots], 0, sizeof(bot_t));
+		bots[numbots].netcon = sock;
+		numbots++;
+	}
+
+	bot_reporttime = 0;
+}
+
+static void CL_Bots_Disconnect_f (void)
+{
+	while (numbots)
+		Bot_Drop (numbots - 1);
+}
+
+void CL_InitBots (void)
+{
+	Cvar_RegisterVariable (&bots_report);
+
+	Cmd_AddCommand ("bots_connect", CL_Bots_Connect_f);
+	Cmd_AddCommand ("bots_disconnect", CL_Bots_Disconnect_f);
+}
@@ -21,7 +21,14 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "quakedef.h"
 
+#if defined(SDL_FRAMEWORK) || defined(NO_SDL_CONFIG)
+#include <SDL2/SDL.h>
+#else
+#include "SDL.h"
+#endif
+
 static void CL_FinishTimeDemo (void);
+static void Demo_ClearIndex (void);
 
 /*
 ==============================================================================
@@ -55,13 +62,201 @@ void CL_StopPlayback (void)
 	fclose (cls.demofile);
 	cls.demoplayback = false;
 	cls.demopaused = false;
+	cls.demoseeking = false;
 	cls.demofile = NULL;
 	cls.state = ca_disconnected;
+	Demo_ClearIndex ();
 
 	if (cls.timedemo)
 		CL_FinishTimeDemo ();
 }
 
+/*
+==============================================================================
+
+DEMO WRITER
+
+Recording copies each message into a ring buffer and returns; a writer
+thread drains the ring into the file and flushes it at most every
+DEMO_FLUSH_MS, so a crash loses at most that much of the demo.  The main
+thread only blocks when the ring is full, which means the disk can't
+keep up at all.  Stopping the recording, by hand or from Host_Shutdown
+on the way out of Sys_Error, waits for the writer to finish the file.
+==============================================================================
+*/
+
+#define	DEMO_RING_SIZE	(1 << 20)	// must be a power of two, and hold several MAX_MSGLEN
+#define	DEMO_FLUSH_MS	500
+
+static struct
+{
+	FILE		*file;
+	byte		*ring;
+	size_t		head, tail;		// bytes queued / written so far, wrap with the ring
+	SDL_mutex	*lock;
+	SDL_cond	*queued;		// data or close request for the writer
+	SDL_cond	*drained;		// space for the main thread
+	SDL_Thread	*thread;
+	qboolean	closing;
+	qboolean	failed;
+	int			stalls;			// times the main thread waited for space
+} demowriter;
+
+static int SDLCALL Demo_WriterThread (void *unused)
+{
+	Uint32	lastflush;
+	size_t	offset, count;
+	qboolean	dirty;
+
+	lastflush = SDL_GetTicks ();
+	dirty = false;
+
+	SDL_LockMutex (demowriter.lock);
+	for (;;)
+	{
+		if (demowriter.head == demowriter.tail)
+		{
+			if (demowriter.closing)
+				break;
+			if (SDL_CondWaitTimeout (demowriter.queued, demowriter.lock, DEMO_FLUSH_MS) == SDL_MUTEX_TIMEDOUT && dirty)
+			{
+				SDL_UnlockMutex (demowriter.lock);
+				fflush (demowriter.file);
+				lastflush = SDL_GetTicks ();
+				dirty = false;
+				SDL_LockMutex (demowriter.lock);
+			}
+			continue;
+		}
+
+	// write the contiguous part, the rest comes around next pass
+		offset = demowriter.tail & (DEMO_RING_SIZE - 1);
+		count = demowriter.head - demowriter.tail;
+		if (count > DEMO_RING_SIZE - offset)
+			count = DEMO_RING_SIZE - offset;
+		SDL_UnlockMutex (demowriter.lock);
+
+		if (fwrite (demowriter.ring + offset, 1, count, demowriter.file) != count)
+		{
+			SDL_LockMutex (demowriter.lock);
+			demowriter.failed = true;
+			SDL_CondSignal (demowriter.drained);
+			break;
+		}
+		dirty = true;
+		if (SDL_GetTicks () - lastflush >= DEMO_FLUSH_MS)
+		{
+			fflush (demowriter.file);
+			lastflush = SDL_GetTicks ();
+			dirty = false;
+		}
+
+		SDL_LockMutex (demowriter.lock);
+		demowriter.tail += count;
+		SDL_CondSignal (demowriter.drained);
+	}
+	SDL_UnlockMutex (demowriter.lock);
+
+	return 0;
+}
+
+static qboolean Demo_OpenWriter (FILE *f)
+{
+	demowriter.file = f;
+	demowriter.head = demowriter.tail = 0;
+	demowriter.closing = demowriter.failed = false;
+	demowriter.stalls = 0;
+
+	if (!demowriter.ring)
+	{
+		demowriter.ring = (byte *) malloc (DEMO_RING_SIZE);
+		demowriter.lock = SDL_CreateMutex ();
+		demowriter.queued = SDL_CreateCond ();
+		demowriter.drained = SDL_CreateCond ();
+		if (!demowriter.ring || !demowriter.lock || !demowriter.queued || !demowriter.drained)
+			Sys_Error ("Demo_OpenWriter: couldn't allocate the demo buffer");
+	}
+
+	demowriter.thread = SDL_CreateThread (Demo_WriterThread, "DemoWriter", NULL);
+	if (!demowriter.thread)
+	{
+		Con_Printf ("ERROR: couldn't start demo writer: %s\n", SDL_GetError ());
+		return false;
+	}
+	return true;
+}
+
+/*
+====================
+Demo_Write
+
+Queues data for the writer, waiting only if the ring is full.  Returns
+false once the writer has failed.
+====================
+*/
+static qboolean Demo_Write (const void *data, size_t len)
+{
+	size_t	offset, count;
+
+	SDL_LockMutex (demowriter.lock);
+	if (DEMO_RING_SIZE - (demowriter.head - demowriter.tail) < len && !demowriter.failed)
+	{
+		demowriter.stalls++;
+		do
+			SDL_CondWait (demowriter.drained, demowriter.lock);
+		while (DEMO_RING_SIZE - (demowriter.head - demowriter.tail) < len && !demowriter.failed);
+	}
+
+	if (demowriter.failed)
+	{
+		SDL_UnlockMutex (demowriter.lock);
+		return false;
+	}
+
+	offset = demowriter.head & (DEMO_RING_SIZE - 1);
+	count = q_min (len, DEMO_RING_SIZE - offset);
+	memcpy (demowriter.ring + offset, data, count);
+	memcpy (demowriter.ring, (const byte *) data + count, len - count);
+	demowriter.head += len;
+
+	SDL_CondSignal (demowriter.queued);
+	SDL_UnlockMutex (demowriter.lock);
+	return true;
+}
+
+/*
+====================
+Demo_CloseWriter
+
+Waits for everything queued to reach the file, then closes it.  Returns
+false if some of it didn't make it.
+====================
+*/
+static qboolean Demo_CloseWriter (void)
+{
+	qboolean	ok;
+
+	SDL_LockMutex (demowriter.lock);
+	demowriter.closing = true;
+	SDL_CondSignal (demowriter.queued);
+	SDL_UnlockMutex (demowriter.lock);
+
+	SDL_WaitThread (demowriter.thread, NULL);
+	demowriter.thread = NULL;
+
+	ok = !demowriter.failed;
+	if (fflush (demowriter.file) != 0)
+		ok = false;
+	if (fclose (demowriter.file) != 0)
+		ok = false;
+	demowriter.file = NULL;
+
+	if (demowriter.stalls)
+		Con_DPrintf ("demo writer fell behind %i times\n", demowriter.stalls);
+
+	return ok;
+}
+
 /*
 ====================
 CL_WriteDemoMessage
@@ -71,26 +266,417 @@ Dumps the current net message, prefixed by the length and view angles
 */
 static void CL_WriteDemoMessage (void)
 {
-	int	len;
+	int	header[4];
 	int	i;
 	float	f;
 
-	len = LittleLong (net_message.cursize);
-	fwrite (&len, 4, 1, cls.demofile);
+	if (!cls.demorecording)
+		return;	// the writer gave up earlier in this batch
+
+	header[0] = LittleLong (net_message.cursize);
 	for (i = 0; i < 3; i++)
 	{
 		f = LittleFloat (cl.viewangles[i]);
-		fwrite (&f, 4, 1, cls.demofile);
+		memcpy (&header[i + 1], &f, 4);
+	}
+
+	if (!Demo_Write (header, sizeof(header)) || !Demo_Write (net_message.data, net_message.cursize))
+	{
+		Con_Printf ("ERROR: couldn't write demo, recording stopped\n");
+		CL_FinishRecording ();
 	}
-	fwrite (net_message.data, net_message.cursize, 1, cls.demofile);
-	fflush (cls.demofile);
 }
 
-static int CL_GetDemoMessage (void)
+/*
+====================
+CL_WriteStateMessage
+
+Writes the client state that persists between messages and isn't sent
+again with every datagram: scores, light styles, stats and the view
+entity.  Used to start a demo in the middle of a game and to rebuild the
+state at a demo keyframe.
+====================
+*/
+static void CL_WriteStateMessage (sizebuf_t *msg)
+{
+	int	i;
+
+	// current names, colors, and frag counts
+	for (i = 0; i < cl.maxclients; i++)
+	{
+		MSG_WriteByte (msg, svc_updatename);
+		MSG_WriteByte (msg, i);
+		MSG_WriteString (msg, cl.scores[i].name);
+		MSG_WriteByte (msg, svc_updatefrags);
+		MSG_WriteByte (msg, i);
+		MSG_WriteShort (msg, cl.scores[i].frags);
+		MSG_WriteByte (msg, svc_updatecolors);
+		MSG_WriteByte (msg, i);
+		MSG_WriteByte (msg, cl.scores[i].colors);
+	}
+
+	// send all current light styles
+	for (i = 0; i < MAX_LIGHTSTYLES; i++)
+	{
+		MSG_WriteByte (msg, svc_lightstyle);
+		MSG_WriteByte (msg, i);
+		MSG_WriteString (msg, cl_lightstyle[i].map);
+	}
+
+	// what about the CD track or SVC fog... future consideration.
+	for (i = 0; i < MAX_CL_STATS; i++)
+	{
+		MSG_WriteByte (msg, svc_updatestat);
+		MSG_WriteByte (msg, i);
+		MSG_WriteLong (msg, cl.stats[i]);
+	}
+
+	// view entity
+	MSG_WriteByte (msg, svc_setview);
+	MSG_WriteShort (msg, cl.viewentity);
+}
+
+/*
+====================
+CL_ReadDemoMessage
+
+Reads the next message into net_message, returns 0 at the end of the file
+====================
+*/
+static long	demo_msgoffset;		// where the last message read started
+
+static int CL_ReadDemoMessage (void)
 {
-	int	r, i;
+	int	i;
 	float	f;
 
+	demo_msgoffset = ftell (cls.demofile);
+	if (fread (&net_message.cursize, 4, 1, cls.demofile) != 1)
+		return 0;
+	VectorCopy (cl.mviewangles[0], cl.mviewangles[1]);
+	for (i = 0 ; i < 3 ; i++)
+	{
+		if (fread (&f, 4, 1, cls.demofile) != 1)
+			return 0;
+		cl.mviewangles[0][i] = LittleFloat (f);
+	}
+
+	net_message.cursize = LittleLong (net_message.cursize);
+	if (net_message.cursize > MAX_MSGLEN)
+		Sys_Error ("Demo message > MAX_MSGLEN");
+	if (fread (net_message.data, net_message.cursize, 1, cls.demofile) != 1)
+		return 0;
+
+	return 1;
+}
+
+/*
+==============================================================================
+
+DEMO INDEX
+
+Demos can only be played forward, so seeking works from keyframes: every
+DEMO_KEY_INTERVAL seconds of demo time the file offset of the next
+message is stored together with a message rebuilding the client state
+there (see CL_WriteStateMessage).  Entities need no snapshot, every
+datagram carries all visible entities relative to their baselines.
+
+Seeking jumps to the last keyframe before the target and parses forward
+from there without rendering; with no keyframe that early, it replays the
+map from its serverinfo.  The index is built as the demo is read, by
+normal playback or by fast-forwarding, so the first seek forward in a
+long demo pays for the parsing once and every later seek is short.
+Times are server time within the current map, as shown by demo_seek.
+==============================================================================
+*/
+
+#define	DEMO_KEY_INTERVAL	10
+
+typedef struct
+{
+	long	offset;			// of the first message after the keyframe
+	double	time;
+	int		map;
+	byte	*state;
+	int		statesize;
+} demokey_t;
+
+static demokey_t	*demo_keys;
+static int			demo_numkeys, demo_maxkeys;
+
+static long			*demo_maps;	// offset of the message with each map's serverinfo
+static int			demo_nummaps, demo_maxmaps;
+static int			demo_curmap = -1;
+
+static void Demo_ClearIndex (void)
+{
+	int	i;
+
+	for (i = 0; i < demo_numkeys; i++)
+		free (demo_keys[i].state);
+	free (demo_keys);
+	demo_keys = NULL;
+	demo_numkeys = demo_maxkeys = 0;
+
+	free (demo_maps);
+	demo_maps = NULL;
+	demo_nummaps = demo_maxmaps = 0;
+	demo_curmap = -1;
+}
+
+/*
+====================
+CL_DemoNewMap
+
+Called by the parser before it handles an svc_serverinfo from a demo
+====================
+*/
+void CL_DemoNewMap (void)
+{
+	int	i;
+
+	for (i = 0; i < demo_nummaps; i++)
+	{
+		if (demo_maps[i] == demo_msgoffset)
+		{
+			demo_curmap = i;	// replaying a map we have seen
+			return;
+		}
+	}
+
+	if (demo_nummaps == demo_maxmaps)
+	{
+		demo_maxmaps = demo_maxmaps ? demo_maxmaps * 2 : 16;
+		demo_maps = (long *) realloc (demo_maps, demo_maxmaps * sizeof(long));
+		if (!demo_maps)
+			Sys_Error ("CL_DemoNewMap: out of memory");
+	}
+	demo_maps[demo_nummaps] = demo_msgoffset;
+	demo_curmap = demo_nummaps++;
+}
+
+/*
+====================
+Demo_CheckKeyframe
+
+Called before each message is read, so the client state is complete up
+to the current file offset.
+====================
+*/
+static void Demo_CheckKeyframe (void)
+{
+	static byte	buf[MAX_MSGLEN];
+	sizebuf_t	msg;
+	demokey_t	*last, *key;
+	long		offset;
+
+	if (cls.signon != SIGNONS || demo_curmap < 0 || cl.mtime[0] <= 0)
+		return;
+
+	offset = ftell (cls.demofile);
+	last = demo_numkeys ? &demo_keys[demo_numkeys - 1] : NULL;
+	if (last && offset <= last->offset)
+		return;	// already indexed this far
+	if (last && last->map == demo_curmap && cl.mtime[0] < last->time + DEMO_KEY_INTERVAL)
+		return;
+
+	msg.data = buf;
+	msg.maxsize = sizeof(buf);
+	msg.cursize = 0;
+	msg.growsize = 0;
+	CL_WriteStateMessage (&msg);
+
+	if (demo_numkeys == demo_maxkeys)
+	{
+		demo_maxkeys = demo_maxkeys ? demo_maxkeys * 2 : 256;
+		demo_keys = (demokey_t *) realloc (demo_keys, demo_maxkeys * sizeof(demokey_t));
+		if (!demo_keys)
+			Sys_Error ("Demo_CheckKeyframe: out of memory");
+	}
+
+	key = &demo_keys[demo_numkeys++];
+	key->offset = offset;
+	key->time = cl.mtime[0];
+	key->map = demo_curmap;
+	key->statesize = msg.cursize;
+	key->state = (byte *) malloc (msg.cursize);
+	if (!key->state)
+		Sys_Error ("Demo_CheckKeyframe: out of memory");
+	memcpy (key->state, buf, msg.cursize);
+}
+
+/*
+====================
+Demo_EndsConnection
+
+True if the message just read carries an svc_disconnect
+====================
+*/
+static qboolean Demo_EndsConnection (void)
+{
+	svclayout_t	layout;
+	int			pos, cmd, protocol;
+
+	protocol = cl.protocol;
+	for (pos = 0; pos < net_message.cursize; pos += layout.size)
+	{
+		cmd = net_message.data[pos++];
+		if (cmd == svc_disconnect)
+			return true;
+		if (!CL_MessageLayout (net_message.data + pos, net_message.cursize - pos, cmd, protocol, &layout))
+			return false;	// the parser will complain about it
+		if ((cmd == svc_version || cmd == svc_serverinfo) && layout.size >= 4)
+			protocol = net_message.data[pos] + (net_message.data[pos + 1] << 8) +
+				(net_message.data[pos + 2] << 16) + (net_message.data[pos + 3] << 24);
+	}
+	return false;
+}
+
+/*
+====================
+Demo_Seek
+
+Moves playback to the first message at or after target, or to the end
+of the map or demo if it comes first
+====================
+*/
+static void Demo_Seek (double target)
+{
+	demokey_t	*key;
+	int			i, map;
+
+	map = demo_curmap;
+	key = NULL;
+	for (i = demo_numkeys - 1; i >= 0; i--)
+	{
+		if (demo_keys[i].map == map && demo_keys[i].time <= target)
+		{
+			key = &demo_keys[i];
+			break;
+		}
+	}
+
+// jump when going back, or when a keyframe saves parsing ahead
+	if (target < cl.mtime[0] || (key && key->time > cl.mtime[0]))
+	{
+		if (key)
+		{
+			fseek (cls.demofile, key->offset, SEEK_SET);
+			cl.intermission = 0;
+			cl.mtime[0] = key->time;
+			SZ_Clear (&net_message);
+			SZ_Write (&net_message, key->state, key->statesize);
+			CL_ParseServerMessage ();
+		}
+		else
+		{
+			fseek (cls.demofile, demo_maps[map], SEEK_SET);
+			cls.signon = 0;
+		}
+	}
+
+	cls.demoseeking = true;
+	while (cls.signon != SIGNONS || cl.mtime[0] < target)
+	{
+		Demo_CheckKeyframe ();
+		if (!CL_ReadDemoMessage ())
+			break;	// playback stops on the next read
+		if (Demo_EndsConnection ())
+		{
+		// leave the disconnect to normal playback, which ends the demo
+			fseek (cls.demofile, demo_msgoffset, SEEK_SET);
+			VectorCopy (cl.mviewangles[1], cl.mviewangles[0]);
+			break;
+		}
+		CL_ParseServerMessage ();
+		if (demo_curmap != map)
+			break;	// let the next map load at normal speed
+	}
+	cls.demoseeking = false;
+
+// nothing in flight survives a jump, the next messages bring it back
+	cl.mtime[1] = cl.mtime[0];
+	cl.time = cl.oldtime = cl.mtime[0];
+	memset (cl_dlights, 0, sizeof(cl_dlights));
+	memset (cl_beams, 0, sizeof(cl_beams));
+	R_ClearParticles ();
+}
+
+static qboolean Demo_CanSeek (void)
+{
+	if (!cls.demoplayback)
+	{
+		Con_Printf ("Not playing a demo.\n");
+		return false;
+	}
+	if (cls.timedemo)
+	{
+		Con_Printf ("Can't seek in a timedemo\n");
+		return false;
+	}
+	if (cls.signon != SIGNONS || demo_curmap < 0)
+	{
+		Con_Printf ("Can't seek before the demo has started\n");
+		return false;
+	}
+	return true;
+}
+
+/*
+====================
+CL_DemoSeek_f
+
+demo_seek [time | +seconds | -seconds]
+====================
+*/
+void CL_DemoSeek_f (void)
+{
+	const char	*arg;
+	double		target;
+
+	if (!Demo_CanSeek ())
+		return;
+
+	if (Cmd_Argc() != 2)
+	{
+		Con_Printf ("demo_seek <time|+secs|-secs> : at %.1f, %i keyframes\n", cl.mtime[0], demo_numkeys);
+		return;
+	}
+
+	arg = Cmd_Argv(1);
+	target = Q_atof (arg);
+	if (arg[0] == '+' || arg[0] == '-')
+		target += cl.mtime[0];
+
+	Demo_Seek (q_max (target, 0));
+}
+
+/*
+====================
+CL_DemoFastForward_f
+
+demo_ff [seconds]
+====================
+*/
+void CL_DemoFastForward_f (void)
+{
+	double	secs;
+
+	if (!Demo_CanSeek ())
+		return;
+
+	secs = (Cmd_Argc() > 1) ? Q_atof (Cmd_Argv(1)) : DEMO_KEY_INTERVAL;
+	if (secs <= 0)
+	{
+		Con_Printf ("demo_ff [seconds] : skip ahead in the demo\n");
+		return;
+	}
+
+	Demo_Seek (cl.mtime[0] + secs);
+}
+
+static int CL_GetDemoMessage (void)
+{
 	if (cls.demopaused)
 		return 0;
 
@@ -114,19 +700,8 @@ static int CL_GetDemoMessage (void)
 	}
 
 // get the next message
-	fread (&net_message.cursize, 4, 1, cls.demofile);
-	VectorCopy (cl.mviewangles[0], cl.mviewangles[1]);
-	for (i = 0 ; i < 3 ; i++)
-	{
-		r = fread (&f, 4, 1, cls.demofile);
-		cl.mviewangles[0][i] = LittleFloat (f);
-	}
-
-	net_message.cursize = LittleLong (net_message.cursize);
-	if (net_message.cursize > MAX_MSGLEN)
-		Sys_Error ("Demo message > MAX_MSGLEN");
-	r = fread (net_message.data, net_message.cursize, 1, cls.demofile);
-	if (r != 1)
+	Demo_CheckKeyframe ();
+	if (!CL_ReadDemoMessage ())
 	{
 		CL_StopPlayback ();
 		return 0;
@@ -201,12 +776,31 @@ void CL_Stop_f (void)
 	MSG_WriteByte (&net_message, svc_disconnect);
 	CL_WriteDemoMessage ();
 
-// finish up
-	fclose (cls.demofile);
-	cls.demofile = NULL;
+	if (cls.demorecording)
+		CL_FinishRecording ();
+}
+
+/*
+====================
+CL_FinishRecording
+
+Closes the demo file once the writer has caught up.  Also called from
+Host_Shutdown so a demo being recorded when the engine goes down, even
+through Sys_Error, ends up complete on disk.
+====================
+*/
+void CL_FinishRecording (void)
+{
+	if (!cls.demorecording)
+		return;
+
 	cls.demorecording = false;
-	Con_Printf ("Completed demo\n");
-	
+	cls.demofile = NULL;
+	if (Demo_CloseWriter ())
+		Con_Printf ("Completed demo\n");
+	else
+		Con_Printf ("ERROR: demo file is incomplete\n");
+
 // ericw -- update demo tab-completion list
 	DemoList_Rebuild ();
 }
@@ -297,6 +891,13 @@ void CL_Record_f (void)
 	cls.forcetrack = track;
 	fprintf (cls.demofile, "%i\n", cls.forcetrack);
 
+	if (!Demo_OpenWriter (cls.demofile))
+	{
+		fclose (cls.demofile);
+		cls.demofile = NULL;
+		return;
+	}
+
 	cls.demorecording = true;
 
 	// from ProQuake: initialize the demo file if we're already connected
@@ -316,48 +917,7 @@ void CL_Record_f (void)
 		net_message.data = demo_head[2];
 		SZ_Clear (&net_message);
 
-		// current names, colors, and frag counts
-		for (i = 0; i < cl.maxclients; i++)
-		{
-			MSG_WriteByte (&net_message, svc_updatename);
-			MSG_WriteByte (&net_message, i);
-			MSG_WriteString (&net_message, cl.scores[i].name);
-			MSG_WriteByte (&net_message, svc_updatefrags);
-			MSG_WriteByte (&net_message, i);
-			MSG_WriteShort (&net_message, cl.scores[i].frags);
-			MSG_WriteByte (&net_message, svc_updatecolors);
-			MSG_WriteByte (&net_message, i);
-			MSG_WriteByte (&net_message, cl.scores[i].colors);
-		}
-
-		// send all current light styles
-		for (i = 0; i < MAX_LIGHTSTYLES; i++)
-		{
-			MSG_WriteByte (&net_message, svc_lightstyle);
-			MSG_WriteByte (&net_message, i);
-			MSG_WriteString (&net_message, cl_lightstyle[i].map);
-		}
-
-		// what about the CD track or SVC fog... future consideration.
-		MSG_WriteByte (&net_message, svc_updatestat);
-		MSG_WriteByte (&net_message, STAT_TOTALSECRETS);
-		MSG_WriteLong (&net_message, cl.stats[STAT_TOTALSECRETS]);
-
-		MSG_WriteByte (&net_message, svc_updatestat);
-		MSG_WriteByte (&net_message, STAT_TOTALMONSTERS);
-		MSG_WriteLong (&net_message, cl.stats[STAT_TOTALMONSTERS]);
-
-		MSG_WriteByte (&net_message, svc_updatestat);
-		MSG_WriteByte (&net_message, STAT_SECRETS);
-		MSG_WriteLong (&net_message, cl.stats[STAT_SECRETS]);
-
-		MSG_WriteByte (&net_message, svc_updatestat);
-		MSG_WriteByte (&net_message, STAT_MONSTERS);
-		MSG_WriteLong (&net_message, cl.stats[STAT_MONSTERS]);
-
-		// view entity
-		MSG_WriteByte (&net_message, svc_setview);
-		MSG_WriteShort (&net_message, cl.viewentity);
+		CL_WriteStateMessage (&net_message);
 
 		// signon
 		MSG_WriteByte (&net_message, svc_signonnum);
@@ -445,11 +1005,218 @@ void CL_PlayDemo_f (void)
 	cls.demoplayback = true;
 	cls.demopaused = false;
 	cls.state = ca_connected;
+	Demo_ClearIndex ();
 
 // get rid of the menu and/or console
 	key_dest = key_game;
 }
 
+/*
+==============================================================================
+
+TIMEDEMO STATISTICS
+
+_Host_Frame hands in the time spent in each phase of every timedemo frame.
+When the demo ends the frame times are summarized, and with timedemo_dump
+set they are also written out per frame, as JSON if the file name ends in
+.json and as CSV otherwise.
+
+==============================================================================
+*/
+
+cvar_t	timedemo_dump = {"timedemo_dump", "", CVAR_NONE};
+
+enum { TD_HOST, TD_SERVER, TD_RENDER, TD_SOUND, TD_NUMPHASES };
+
+static const char *td_phasenames[TD_NUMPHASES] = { "host", "server", "render", "sound" };
+
+typedef struct
+{
+	float	total;					// wall time since the previous frame
+	float	phase[TD_NUMPHASES];
+} tdframe_t;
+
+static tdframe_t	*td_frames;
+static int			td_numframes, td_maxframes;
+static double		td_lastframetime;
+
+// upper bounds of the histogram buckets in milliseconds, the last one is open
+static const float	td_buckets[] = { 4, 8, 12, 16.7f, 25, 33.3f, 50, 100 };
+#define TD_NUMBUCKETS	(sizeof(td_buckets) / sizeof(td_buckets[0]) + 1)
+
+/*
+====================
+CL_TimeDemoFrame
+
+Called at the end of every host frame while cls.timedemo is set.
+The first frame carries the level load and is not recorded.
+====================
+*/
+void CL_TimeDemoFrame (double host, double server, double render, double sound)
+{
+	tdframe_t	*f;
+	double		now;
+
+	if (!cls.timedemo)
+		return;
+
+	now = Sys_DoubleTime ();
+	if (host_framecount == cls.td_startframe)
+	{
+		td_lastframetime = now;
+		return;
+	}
+
+	if (td_numframes == td_maxframes)
+	{
+		td_maxframes = td_maxframes ? td_maxframes * 2 : 4096;
+		td_frames = (tdframe_t *) realloc (td_frames, td_maxframes * sizeof(tdframe_t));
+		if (!td_frames)
+			Sys_Error ("CL_TimeDemoFrame: out of memory");
+	}
+
+	f = &td_frames[td_numframes++];
+	f->total = (now - td_lastframetime) * 1000;
+	f->phase[TD_HOST] = host * 1000;
+	f->phase[TD_SERVER] = server * 1000;
+	f->phase[TD_RENDER] = render * 1000;
+	f->phase[TD_SOUND] = sound * 1000;
+	td_lastframetime = now;
+}
+
+static int CL_TimeDemoCompare (const void *a, const void *b)
+{
+	float	fa = *(const float *)a, fb = *(const float *)b;
+
+	return (fa < fb) - (fa > fb);	// slowest first
+}
+
+// average of the slowest fraction of the frames, as frames per second
+static float CL_TimeDemoLow (const float *sorted, int count, float fraction)
+{
+	int		i, n;
+	double	sum;
+
+	n = q_max (1, (int)(count * fraction));
+	for (i = 0, sum = 0; i < n; i++)
+		sum += sorted[i];
+	return sum ? 1000 * n / sum : 0;
+}
+
+static void CL_TimeDemoDump (const char *name, float fps, float low1, float low01)
+{
+	FILE	*f;
+	int		i, j;
+	qboolean	json;
+	const char	*ext;
+
+	f = fopen (va("%s/%s", com_gamedir, name), "w");
+	if (!f)
+	{
+		Con_Printf ("Couldn't write %s\n", name);
+		return;
+	}
+
+	ext = COM_FileGetExtension (name);
+	json = !q_strcasecmp (ext, "json");
+
+	if (json)
+	{
+		fprintf (f, "{\n\t\"frames\": %i,\n\t\"fps\": %.2f,\n\t\"low1\": %.2f,\n\t\"low01\": %.2f,\n",
+				td_numframes, fps, low1, low01);
+		fprintf (f, "\t\"columns\": [\"total\"");
+		for (j = 0; j < TD_NUMPHASES; j++)
+			fprintf (f, ", \"%s\"", td_phasenames[j]);
+		fprintf (f, "],\n\t\"frametimes\": [\n");
+		for (i = 0; i < td_numframes; i++)
+		{
+			fprintf (f, "\t\t[%.3f", td_frames[i].total);
+			for (j = 0; j < TD_NUMPHASES; j++)
+				fprintf (f, ", %.3f", td_frames[i].phase[j]);
+			fprintf (f, "]%s\n", (i < td_numframes - 1) ? "," : "");
+		}
+		fprintf (f, "\t]\n}\n");
+	}
+	else
+	{
+		fprintf (f, "frame,total_ms");
+		for (j = 0; j < TD_NUMPHASES; j++)
+			fprintf (f, ",%s_ms", td_phasenames[j]);
+		fprintf (f, "\n");
+		for (i = 0; i < td_numframes; i++)
+		{
+			fprintf (f, "%i,%.3f", i, td_frames[i].total);
+			for (j = 0; j < TD_NUMPHASES; j++)
+				fprintf (f, ",%.3f", td_frames[i].phase[j]);
+			fprintf (f, "\n");
+		}
+	}
+
+	fclose (f);
+	Con_Printf ("Wrote %s\n", name);
+}
+
+static void CL_TimeDemoStats (float fps)
+{
+	float	*sorted;
+	float	low1, low01, sum, peak;
+	int		hist[TD_NUMBUCKETS];
+	int		i, j, most;
+
+	if (td_numframes < 1)
+		return;
+
+	sorted = (float *) malloc (td_numframes * sizeof(float));
+	if (!sorted)
+		Sys_Error ("CL_TimeDemoStats: out of memory");
+	for (i = 0; i < td_numframes; i++)
+		sorted[i] = td_frames[i].total;
+	qsort (sorted, td_numframes, sizeof(float), CL_TimeDemoCompare);
+
+	for (i = 0, sum = 0; i < td_numframes; i++)
+		sum += sorted[i];
+	low1 = CL_TimeDemoLow (sorted, td_numframes, 0.01f);
+	low01 = CL_TimeDemoLow (sorted, td_numframes, 0.001f);
+	Con_Printf ("frame time %.2f min %.2f avg %.2f max ms, lows %.1f fps (1%%) %.1f fps (0.1%%)\n",
+				sorted[td_numframes - 1], sum / td_numframes, sorted[0], low1, low01);
+
+	for (j = 0; j < TD_NUMPHASES; j++)
+	{
+		for (i = 0, sum = 0, peak = 0; i < td_numframes; i++)
+		{
+			sum += td_frames[i].phase[j];
+			peak = q_max (peak, td_frames[i].phase[j]);
+		}
+		Con_Printf ("%8s %6.2f avg %6.2f max ms\n", td_phasenames[j], sum / td_numframes, peak);
+	}
+
+	memset (hist, 0, sizeof(hist));
+	for (i = 0; i < td_numframes; i++)
+	{
+		for (j = 0; j < (int)TD_NUMBUCKETS - 1; j++)
+			if (td_frames[i].total < td_buckets[j])
+				break;
+		hist[j]++;
+	}
+	for (j = 0, most = 1; j < (int)TD_NUMBUCKETS; j++)
+		most = q_max (most, hist[j]);
+	for (j = 0; j < (int)TD_NUMBUCKETS; j++)
+	{
+		if (j < (int)TD_NUMBUCKETS - 1)
+			Con_Printf ("  < %5.1f ms %6i ", td_buckets[j], hist[j]);
+		else
+			Con_Printf (" >= %5.1f ms %6i ", td_buckets[j - 1], hist[j]);
+		for (i = 0; i < hist[j] * 32 / most; i++)
+			Con_Printf ("#");
+		Con_Printf ("\n");
+	}
+
+	if (timedemo_dump.string[0])
+		CL_TimeDemoDump (timedemo_dump.string, fps, low1, low01);
+
+	free (sorted);
+}
+
 /*
 ====================
 CL_FinishTimeDemo
@@ -469,6 +1236,16 @@ static void CL_FinishTimeDemo (void)
 	if (!time)
 		time = 1;
 	Con_Printf ("%i frames %5.1f seconds %5.1f fps\n", frames, time, frames/time);
+
+	CL_TimeDemoStats (frames/time);
+
+	free (td_frames);
+	td_frames = NULL;
+	td_numframes = td_maxframes = 0;
+
+// nobody is watching a headless client, let the build script collect the results
+	if (isHeadless)
+		Cbuf_AddText ("quit\n");
 }
 
 /*
@@ -497,6 +1274,7 @@ void CL_TimeDemo_f (void)
 // all the loading time doesn't get counted
 
 	cls.timedemo = true;
+	td_numframes = 0;
 	cls.td_startframe = host_framecount;
 	cls.td_lastframe = -1;	// get a new message this frame
 }
@@ -338,38 +338,52 @@ void CL_BaseMove (usercmd_t *cmd)
 CL_SendMove
 ==============
 */
-void CL_SendMove (const usercmd_t *cmd)
+/*
+==============
+CL_WriteMove
+
+Builds a clc_move message.  Also used by the bot clients in cl_bots.c,
+which have no cl state of their own.
+==============
+*/
+void CL_WriteMove (sizebuf_t *buf, const usercmd_t *cmd, const vec3_t angles, float time, int protocol, int buttons, int impulse)
 {
 	int		i;
+
+	MSG_WriteByte (buf, clc_move);
+
+	MSG_WriteFloat (buf, time);	// so server can get ping times
+
+	for (i=0 ; i<3 ; i++)
+		//johnfitz -- 16-bit angles for PROTOCOL_FITZQUAKE
+		if (protocol == PROTOCOL_NETQUAKE)
+			MSG_WriteAngle (buf, angles[i]);
+		else
+			MSG_WriteAngle16 (buf, angles[i]);
+		//johnfitz
+
+	MSG_WriteShort (buf, cmd->forwardmove);
+	MSG_WriteShort (buf, cmd->sidemove);
+	MSG_WriteShort (buf, cmd->upmove);
+
+	MSG_WriteByte (buf, buttons);
+
+	MSG_WriteByte (buf, impulse);
+}
+
+void CL_SendMove (const usercmd_t *cmd)
+{
 	int		bits;
 	sizebuf_t	buf;
 	byte	data[128];
 
 	buf.maxsize = 128;
 	buf.cursize = 0;
+	buf.growsize = 0;
 	buf.data = data;
 
 	cl.cmd = *cmd;
 
-//
-// send the movement message
-//
-	MSG_WriteByte (&buf, clc_move);
-
-	MSG_WriteFloat (&buf, cl.mtime[0]);	// so server can get ping times
-
-	for (i=0 ; i<3 ; i++)
-		//johnfitz -- 16-bit angles for PROTOCOL_FITZQUAKE
-		if (cl.protocol == PROTOCOL_NETQUAKE)
-			MSG_WriteAngle (&buf, cl.viewangles[i]);
-		else
-			MSG_WriteAngle16 (&buf, cl.viewangles[i]);
-		//johnfitz
-
-	MSG_WriteShort (&buf, cmd->forwardmove);
-	MSG_WriteShort (&buf, cmd->sidemove);
-	MSG_WriteShort (&buf, cmd->upmove);
-
 //
 // send button bits
 //
@@ -383,9 +397,10 @@ void CL_SendMove (const usercmd_t *cmd)
 		bits |= 2;
 	in_jump.state &= ~2;
 
-	MSG_WriteByte (&buf, bits);
-
-	MSG_WriteByte (&buf, in_impulse);
+//
+// send the movement message
+//
+	CL_WriteMove (&buf, cmd, cl.viewangles, cl.mtime[0], cl.protocol, bits, in_impulse);
 	in_impulse = 0;
 
 //
@@ -143,6 +143,7 @@ void CL_Disconnect (void)
 
 	cls.demoplayback = cls.timedemo = false;
 	cls.demopaused = false;
+	cls.demoseeking = false;	// a seek can end in Host_Error or Host_EndGame
 	cls.signon = 0;
 	cl.intermission = 0;
 }
@@ -802,6 +803,7 @@ void CL_Init (void)
 
 	Cvar_RegisterVariable (&cl_maxpitch); //johnfitz -- variable pitch clamping
 	Cvar_RegisterVariable (&cl_minpitch); //johnfitz -- variable pitch clamping
+	Cvar_RegisterVariable (&timedemo_dump);
 
 	Cmd_AddCommand ("entities", CL_PrintEntities_f);
 	Cmd_AddCommand ("disconnect", CL_Disconnect_f);
@@ -809,6 +811,9 @@ void CL_Init (void)
 	Cmd_AddCommand ("stop", CL_Stop_f);
 	Cmd_AddCommand ("playdemo", CL_PlayDemo_f);
 	Cmd_AddCommand ("timedemo", CL_TimeDemo_f);
+	Cmd_AddCommand ("demo_seek", CL_DemoSeek_f);
+	Cmd_AddCommand ("demo_ff", CL_DemoFastForward_f);
+	Cmd_AddCommand ("demo_analyze", CL_AnalyzeDemos_f);
 
 	Cmd_AddCommand ("tracepos", CL_Tracepos_f); //johnfitz
 	Cmd_AddCommand ("viewpos", CL_Viewpos_f); //johnfitz
@@ -911,6 +911,401 @@ void CL_ParseStaticSound (int version) //johnfitz -- added argument
 	S_StaticSound (cl.sound_precache[sound_num], org, vol, atten);
 }
 
+/*
+==============================================================================
+
+MESSAGE LAYOUT
+
+How long each server message is and where the fields cl_analyze.c keeps
+sit in it, worked out from the bytes alone so it can run on any thread.
+Whatever changes what a message carries has to change this as well as
+the code that parses it.
+
+==============================================================================
+*/
+
+// one byte each, after the always sent part of svc_clientdata
+#define	SU_EXTRABYTES	(SU_WEAPON2|SU_ARMOR2|SU_AMMO2|SU_SHELLS2|SU_NAILS2|SU_ROCKETS2|SU_CELLS2|SU_WEAPONFRAME2|SU_WEAPONALPHA)
+
+// one character per field: b byte or char, s short, l long or float,
+// c coord, a angle, z string.  * is worked out by CL_MessageLayout, NULL
+// is not a server message
+static const char *svc_layouts[] =
+{
+	NULL,		// svc_bad
+	"",			// svc_nop
+	"",			// svc_disconnect
+	"bl",		// svc_updatestat
+	"l",		// svc_version
+	"s",		// svc_setview
+	"*",		// svc_sound
+	"l",		// svc_time
+	"z",		// svc_print
+	"z",		// svc_stufftext
+	"aaa",		// svc_setangle
+	"*",		// svc_serverinfo
+	"bz",		// svc_lightstyle
+	"bz",		// svc_updatename
+	"bs",		// svc_updatefrags
+	"*",		// svc_clientdata
+	"s",		// svc_stopsound
+	"bb",		// svc_updatecolors
+	"cccbbbbb",	// svc_particle
+	"bbccc",	// svc_damage
+	"*",		// svc_spawnstatic
+	NULL,		// svc_spawnbinary
+	"*",		// svc_spawnbaseline
+	"*",		// svc_temp_entity
+	"b",		// svc_setpause
+	"b",		// svc_signonnum
+	"z",		// svc_centerprint
+	"",			// svc_killedmonster
+	"",			// svc_foundsecret
+	"cccbbb",	// svc_spawnstaticsound
+	"",			// svc_intermission
+	"z",		// svc_finale
+	"bb",		// svc_cdtrack
+	"",			// svc_sellscreen
+	"z",		// svc_cutscene
+	NULL,		// 35
+	NULL,		// 36
+	"z",		// svc_skybox
+	NULL,		// 38
+	NULL,		// 39
+	"",			// svc_bf
+	"bbbbs",	// svc_fog
+	"*",		// svc_spawnbaseline2
+	"*",		// svc_spawnstatic2
+	"cccsbb",	// svc_spawnstaticsound2
+};
+
+// svc_temp_entity, after the type byte
+static const char *te_layouts[] =
+{
+	"ccc",		// TE_SPIKE
+	"ccc",		// TE_SUPERSPIKE
+	"ccc",		// TE_GUNSHOT
+	"ccc",		// TE_EXPLOSION
+	"ccc",		// TE_TAREXPLOSION
+	"scccccc",	// TE_LIGHTNING1
+	"scccccc",	// TE_LIGHTNING2
+	"ccc",		// TE_WIZSPIKE
+	"ccc",		// TE_KNIGHTSPIKE
+	"scccccc",	// TE_LIGHTNING3
+	"ccc",		// TE_LAVASPLASH
+	"ccc",		// TE_TELEPORT
+	"cccbb",	// TE_EXPLOSION2
+	"scccccc",	// TE_BEAM
+};
+
+typedef struct
+{
+	const byte	*data;
+	int			size;
+	int			pos;
+} layoutcursor_t;
+
+// reads past the end give 0, CL_MessageLayout fails the message after
+static int CL_LayoutByte (layoutcursor_t *c)
+{
+	c->pos += 1;
+	return (c->pos <= c->size) ? c->data[c->pos - 1] : 0;
+}
+
+static int CL_LayoutShort (layoutcursor_t *c)
+{
+	c->pos += 2;
+	return (c->pos <= c->size) ? (short)(c->data[c->pos - 2] + (c->data[c->pos - 1] << 8)) : 0;
+}
+
+static float CL_LayoutFloat (layoutcursor_t *c)
+{
+	union
+	{
+		byte	b[4];
+		float	f;
+		int	l;
+	} dat;
+
+	c->pos += 4;
+	if (c->pos > c->size)
+		return 0;
+	memcpy (dat.b, c->data + c->pos - 4, 4);
+	dat.l = LittleLong (dat.l);
+	return dat.f;
+}
+
+// same stopping rules as MSG_ReadString, returns the length
+static int CL_LayoutString (layoutcursor_t *c)
+{
+	int	l;
+
+	for (l = 0; l < 2047; l++)
+	{
+		if (c->pos >= c->size)
+		{
+			c->pos++;	// no terminator, fail the message
+			break;
+		}
+		if (!c->data[c->pos++])
+			break;
+	}
+	return l;
+}
+
+static void CL_LayoutFields (layoutcursor_t *c, const char *fields)
+{
+	for ( ; *fields; fields++)
+	{
+		switch (*fields)
+		{
+		case 'b':
+		case 'a':
+			c->pos += 1;
+			break;
+		case 's':
+		case 'c':
+			c->pos += 2;
+			break;
+		case 'l':
+			c->pos += 4;
+			break;
+		case 'z':
+			CL_LayoutString (c);
+			break;
+		}
+	}
+}
+
+/* CL_ParseUpdate */
+static void CL_LayoutUpdate (layoutcursor_t *c, int bits, int protocol, svclayout_t *layout)
+{
+	int	i;
+
+	if (bits & U_MOREBITS)
+		bits |= CL_LayoutByte (c) << 8;
+	if (protocol == PROTOCOL_FITZQUAKE)
+	{
+		if (bits & U_EXTEND1)
+			bits |= CL_LayoutByte (c) << 16;
+		if (bits & U_EXTEND2)
+			bits |= CL_LayoutByte (c) << 24;
+	}
+	layout->bits = bits;
+	layout->entity = (bits & U_LONGENTITY) ? CL_LayoutShort (c) : CL_LayoutByte (c);
+
+	if (bits & U_MODEL)
+		c->pos++;
+	if (bits & U_FRAME)
+		c->pos++;
+	if (bits & U_COLORMAP)
+		c->pos++;
+	if (bits & U_SKIN)
+		c->pos++;
+	if (bits & U_EFFECTS)
+		c->pos++;
+
+	for (i = 0; i < 3; i++)
+	{
+		if (bits & (U_ORIGIN1 << i))
+		{
+			layout->origin[i] = c->pos;
+			c->pos += 2;
+		}
+		if (bits & ((i == 0) ? U_ANGLE1 : (i == 1) ? U_ANGLE2 : U_ANGLE3))
+			c->pos++;
+	}
+
+	if (protocol == PROTOCOL_FITZQUAKE)
+	{
+		if (bits & U_ALPHA)
+			c->pos++;
+		if (bits & U_FRAME2)
+			c->pos++;
+		if (bits & U_MODEL2)
+			c->pos++;
+		if (bits & U_LERPFINISH)
+			c->pos++;
+	}
+	else if (protocol == PROTOCOL_NETQUAKE && (bits & U_TRANS))	// Nehahra
+	{
+		if (CL_LayoutFloat (c) == 2)
+			c->pos += 4;	// fullbright
+		c->pos += 4;	// alpha
+	}
+}
+
+/* CL_ParseBaseline */
+static void CL_LayoutBaseline (layoutcursor_t *c, int version, svclayout_t *layout)
+{
+	int	i;
+
+	layout->bits = (version == 2) ? CL_LayoutByte (c) : 0;
+	c->pos += (layout->bits & B_LARGEMODEL) ? 2 : 1;
+	c->pos += (layout->bits & B_LARGEFRAME) ? 2 : 1;
+	c->pos += 2;	// colormap, skin
+	for (i = 0; i < 3; i++)
+	{
+		layout->origin[i] = c->pos;
+		c->pos += 3;	// coord, angle
+	}
+	if (layout->bits & B_ALPHA)
+		c->pos++;
+}
+
+/* CL_ParseClientdata */
+static void CL_LayoutClientdata (layoutcursor_t *c, svclayout_t *layout)
+{
+	int	bits, i;
+
+	bits = (unsigned short) CL_LayoutShort (c);
+	if (bits & SU_EXTEND1)
+		bits |= CL_LayoutByte (c) << 16;
+	if (bits & SU_EXTEND2)
+		bits |= CL_LayoutByte (c) << 24;
+	layout->bits = bits;
+
+	if (bits & SU_VIEWHEIGHT)
+		c->pos++;
+	if (bits & SU_IDEALPITCH)
+		c->pos++;
+	for (i = 0; i < 3; i++)
+	{
+		if (bits & (SU_PUNCH1 << i))
+			c->pos++;
+		if (bits & (SU_VELOCITY1 << i))
+			c->pos++;
+	}
+	c->pos += 4;	// items
+	if (bits & SU_WEAPONFRAME)
+		c->pos++;
+	if (bits & SU_ARMOR)
+		c->pos++;
+	if (bits & SU_WEAPON)
+		c->pos++;
+	layout->health = c->pos;
+	c->pos += 2 + 1 + 4 + 1;	// health, ammo, shells to cells, active weapon
+	for (i = 16; i < 32; i++)
+		if (bits & SU_EXTRABYTES & (1U << i))
+			c->pos++;
+}
+
+/* CL_ParseStartSoundPacket */
+static void CL_LayoutSound (layoutcursor_t *c)
+{
+	int	mask;
+
+	mask = CL_LayoutByte (c);
+	if (mask & SND_VOLUME)
+		c->pos++;
+	if (mask & SND_ATTENUATION)
+		c->pos++;
+	c->pos += (mask & SND_LARGEENTITY) ? 3 : 2;
+	c->pos += (mask & SND_LARGESOUND) ? 2 : 1;
+	c->pos += 6;	// origin
+}
+
+/*
+==================
+CL_MessageLayout
+
+Fills in layout for the message of type cmd that follows the command
+byte at data.  cmd has U_SIGNAL set for an entity update.  Returns false
+if cmd is not a server message or the message runs past size.
+==================
+*/
+qboolean CL_MessageLayout (const byte *data, int size, int cmd, int protocol, svclayout_t *layout)
+{
+	layoutcursor_t	c;
+	int				i;
+
+	c.data = data;
+	c.size = size;
+	c.pos = 0;
+
+	layout->size = 0;
+	layout->bits = 0;
+	layout->entity = -1;
+	layout->origin[0] = layout->origin[1] = layout->origin[2] = -1;
+	layout->health = -1;
+
+	if (cmd & U_SIGNAL)
+		CL_LayoutUpdate (&c, cmd & 127, protocol, layout);
+	else
+	{
+		if (cmd < 0 || cmd >= (int)(sizeof(svc_layouts) / sizeof(svc_layouts[0])) || !svc_layouts[cmd])
+			return false;
+
+		switch (cmd)
+		{
+		default:
+			CL_LayoutFields (&c, svc_layouts[cmd]);
+			break;
+
+		case svc_sound:
+			CL_LayoutSound (&c);
+			break;
+
+		case svc_serverinfo:
+			CL_LayoutFields (&c, "lbbz");
+			while (CL_LayoutString (&c) && c.pos <= size)	// models
+				;
+			while (CL_LayoutString (&c) && c.pos <= size)	// sounds
+				;
+			break;
+
+		case svc_clientdata:
+			CL_LayoutClientdata (&c, layout);
+			break;
+
+		case svc_spawnbaseline:
+		case svc_spawnbaseline2:
+			layout->entity = CL_LayoutShort (&c);
+			CL_LayoutBaseline (&c, (cmd == svc_spawnbaseline2) ? 2 : 1, layout);
+			break;
+
+		case svc_spawnstatic:
+		case svc_spawnstatic2:
+			CL_LayoutBaseline (&c, (cmd == svc_spawnstatic2) ? 2 : 1, layout);
+			break;
+
+		case svc_temp_entity:
+			i = CL_LayoutByte (&c);
+			if (i >= (int)(sizeof(te_layouts) / sizeof(te_layouts[0])))
+				return false;
+			CL_LayoutFields (&c, te_layouts[i]);
+			break;
+		}
+	}
+
+	layout->size = c.pos;
+	return c.pos <= size;
+}
+
+/*
+==================
+CL_SkippedBySeek
+
+Messages a demo seek passes over: they only print, run commands, or
+start sounds and effects that are over long before the seek lands
+==================
+*/
+static qboolean CL_SkippedBySeek (int cmd)
+{
+	switch (cmd)
+	{
+	case svc_print:
+	case svc_centerprint:
+	case svc_stufftext:
+	case svc_sound:
+	case svc_stopsound:
+	case svc_particle:
+	case svc_damage:
+		return true;
+	default:
+		return false;
+	}
+}
 
 #define SHOWNET(x) if(cl_shownet.value==2)Con_Printf ("%3i:%s\n", msg_readcount-1, x);
 
@@ -925,6 +1320,7 @@ void CL_ParseServerMessage (void)
 	int			i;
 	const char		*str; //johnfitz
 	int			total, j, lastcmd; //johnfitz
+	svclayout_t	layout;
 
 //
 // if recording demos, copy the message out
@@ -964,6 +1360,16 @@ void CL_ParseServerMessage (void)
 
 		SHOWNET(svc_strings[cmd]);
 
+	// a demo seek passes over what would only be shown, heard or run
+		if (cls.demoseeking && CL_SkippedBySeek (cmd))
+		{
+			if (!CL_MessageLayout (net_message.data + msg_readcount, net_message.cursize - msg_readcount, cmd, cl.protocol, &layout))
+				Host_Error ("CL_ParseServerMessage: Bad server message");
+			msg_readcount += layout.size;
+			lastcmd = cmd;
+			continue;
+		}
+
 	// other commands
 		switch (cmd)
 		{
@@ -1017,6 +1423,8 @@ void CL_ParseServerMessage (void)
 			break;
 
 		case svc_serverinfo:
+			if (cls.demoplayback)
+				CL_DemoNewMap ();
 			CL_ParseServerInfo ();
 			vid.recalc_refdef = true;	// leave intermission full screen
 			break;
@@ -108,6 +108,19 @@ void CL_ParseBeam (qmodel_t *m)
 	//johnfitz
 }
 
+/*
+=================
+CL_TempEntitySound
+=================
+*/
+static void CL_TempEntitySound (sfx_t *sfx, vec3_t pos)
+{
+	if (cls.demoseeking)
+		return;
+
+	S_StartSound (-1, 0, sfx, pos, 1, 1);
+}
+
 /*
 =================
 CL_ParseTEnt
@@ -129,7 +142,7 @@ void CL_ParseTEnt (void)
 		pos[1] = MSG_ReadCoord ();
 		pos[2] = MSG_ReadCoord ();
 		R_RunParticleEffect (pos, vec3_origin, 20, 30);
-		S_StartSound (-1, 0, cl_sfx_wizhit, pos, 1, 1);
+		CL_TempEntitySound (cl_sfx_wizhit, pos);
 		break;
 
 	case TE_KNIGHTSPIKE:			// spike hitting wall
@@ -137,7 +150,7 @@ void CL_ParseTEnt (void)
 		pos[1] = MSG_ReadCoord ();
 		pos[2] = MSG_ReadCoord ();
 		R_RunParticleEffect (pos, vec3_origin, 226, 20);
-		S_StartSound (-1, 0, cl_sfx_knighthit, pos, 1, 1);
+		CL_TempEntitySound (cl_sfx_knighthit, pos);
 		break;
 
 	case TE_SPIKE:			// spike hitting wall
@@ -146,16 +159,16 @@ void CL_ParseTEnt (void)
 		pos[2] = MSG_ReadCoord ();
 		R_RunParticleEffect (pos, vec3_origin, 0, 10);
 		if ( rand() % 5 )
-			S_StartSound (-1, 0, cl_sfx_tink1, pos, 1, 1);
+			CL_TempEntitySound (cl_sfx_tink1, pos);
 		else
 		{
 			rnd = rand() & 3;
 			if (rnd == 1)
-				S_StartSound (-1, 0, cl_sfx_ric1, pos, 1, 1);
+				CL_TempEntitySound (cl_sfx_ric1, pos);
 			else if (rnd == 2)
-				S_StartSound (-1, 0, cl_sfx_ric2, pos, 1, 1);
+				CL_TempEntitySound (cl_sfx_ric2, pos);
 			else
-				S_StartSound (-1, 0, cl_sfx_ric3, pos, 1, 1);
+				CL_TempEntitySound (cl_sfx_ric3, pos);
 		}
 		break;
 	case TE_SUPERSPIKE:			// super spike hitting wall
@@ -165,16 +178,16 @@ void CL_ParseTEnt (void)
 		R_RunParticleEffect (pos, vec3_origin, 0, 20);
 
 		if ( rand() % 5 )
-			S_StartSound (-1, 0, cl_sfx_tink1, pos, 1, 1);
+			CL_TempEntitySound (cl_sfx_tink1, pos);
 		else
 		{
 			rnd = rand() & 3;
 			if (rnd == 1)
-				S_StartSound (-1, 0, cl_sfx_ric1, pos, 1, 1);
+				CL_TempEntitySound (cl_sfx_ric1, pos);
 			else if (rnd == 2)
-				S_StartSound (-1, 0, cl_sfx_ric2, pos, 1, 1);
+				CL_TempEntitySound (cl_sfx_ric2, pos);
 			else
-				S_StartSound (-1, 0, cl_sfx_ric3, pos, 1, 1);
+				CL_TempEntitySound (cl_sfx_ric3, pos);
 		}
 		break;
 
@@ -195,7 +208,7 @@ void CL_ParseTEnt (void)
 		dl->radius = 350;
 		dl->die = cl.time + 0.5;
 		dl->decay = 300;
-		S_StartSound (-1, 0, cl_sfx_r_exp3, pos, 1, 1);
+		CL_TempEntitySound (cl_sfx_r_exp3, pos);
 		break;
 
 	case TE_TAREXPLOSION:			// tarbaby explosion
@@ -204,7 +217,7 @@ void CL_ParseTEnt (void)
 		pos[2] = MSG_ReadCoord ();
 		R_BlobExplosion (pos);
 
-		S_StartSound (-1, 0, cl_sfx_r_exp3, pos, 1, 1);
+		CL_TempEntitySound (cl_sfx_r_exp3, pos);
 		break;
 
 	case TE_LIGHTNING1:				// lightning bolts
@@ -251,7 +264,7 @@ void CL_ParseTEnt (void)
 		dl->radius = 350;
 		dl->die = cl.time + 0.5;
 		dl->decay = 300;
-		S_StartSound (-1, 0, cl_sfx_r_exp3, pos, 1, 1);
+		CL_TempEntitySound (cl_sfx_r_exp3, pos);
 		break;
 
 	default:
@@ -120,6 +120,7 @@ typedef struct
 // did the user pause demo playback? (separate from cl.paused because we don't
 // want a svc_setpause inside the demo to actually pause demo playback).
 	qboolean	demopaused;
+	qboolean	demoseeking;		// parsing ahead to a seek target, stay quiet
 
 	qboolean	timedemo;
 	int		forcetrack;		// -1 = use normal cd track
@@ -318,6 +319,14 @@ extern 	kbutton_t 	in_speed;
 void CL_InitInput (void);
 void CL_SendCmd (void);
 void CL_SendMove (const usercmd_t *cmd);
+void CL_WriteMove (sizebuf_t *buf, const usercmd_t *cmd, const vec3_t angles, float time, int protocol, int buttons, int impulse);
+
+//
+// cl_bots.c
+//
+void CL_InitBots (void);
+void CL_RunBots (void);
+int  CL_NumBots (void);
 int  CL_ReadFromServer (void);
 void CL_BaseMove (usercmd_t *cmd);
 
@@ -333,14 +342,40 @@ void CL_StopPlayback (void);
 int CL_GetMessage (void);
 
 void CL_Stop_f (void);
+void CL_FinishRecording (void);
 void CL_Record_f (void);
 void CL_PlayDemo_f (void);
 void CL_TimeDemo_f (void);
+void CL_DemoSeek_f (void);
+void CL_DemoFastForward_f (void);
+
+//
+// cl_analyze.c
+//
+void CL_AnalyzeDemos (const char *output, const char **names, int count, int threads);
+void CL_AnalyzeDemos_f (void);
+void CL_AnalyzeCommandLine (void);
+void CL_TimeDemoFrame (double host, double server, double render, double sound);
+void CL_DemoNewMap (void);
+
+extern	cvar_t	timedemo_dump;
 
 //
 // cl_parse.c
 //
+// where a server message ends and where some of its fields are, as byte
+// offsets from the end of the command byte
+typedef struct
+{
+	int		size;
+	int		bits;			// update, clientdata or baseline flags
+	int		entity;			// update or baseline entity, -1 if none
+	int		origin[3];		// update or baseline coords, -1 if not sent
+	int		health;			// clientdata
+} svclayout_t;
+
 void CL_ParseServerMessage (void);
+qboolean CL_MessageLayout (const byte *data, int size, int cmd, int protocol, svclayout_t *layout);
 void CL_NewTranslation (int slot);
 
 //
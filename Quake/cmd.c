@@ -39,8 +39,6 @@ typedef struct cmdalias_s
 
 cmdalias_t	*cmd_alias;
 
-qboolean	cmd_wait;
-
 //=============================================================================
 
 /*
@@ -65,7 +63,7 @@ void Cmd_Wait_f (void)
 =============================================================================
 */
 
-sizebuf_t	cmd_text;
+// cmd_text and cmd_wait belong to a server instance, see svcontext_t
 
 /*
 ============
@@ -888,17 +888,30 @@ void *SZ_GetSpace (sizebuf_t *buf, int length)
 {
 	void	*data;
 
+	if (buf->cursize + length > buf->maxsize && buf->cursize + length <= buf->growsize)
+	{
+		buf->data = (byte *) Pool_Realloc (buf->data, buf->cursize, buf->cursize + length);
+		buf->maxsize = q_min(Pool_Size (buf->data), buf->growsize);
+	}
+
 	if (buf->cursize + length > buf->maxsize)
 	{
 		if (!buf->allowoverflow)
 			Sys_Error ("SZ_GetSpace: overflow without allowoverflow set");
 
-		if (length > buf->maxsize)
+		if (length > q_max(buf->maxsize, buf->growsize))
 			Sys_Error ("SZ_GetSpace: %i is > full buffer size", length);
 
 		buf->overflowed = true;
 		Con_Printf ("SZ_GetSpace: overflow");
 		SZ_Clear (buf);
+
+		// a growable buffer may still be smaller than this write
+		if (length > buf->maxsize)
+		{
+			buf->data = (byte *) Pool_Realloc (buf->data, 0, length);
+			buf->maxsize = q_min(Pool_Size (buf->data), buf->growsize);
+		}
 	}
 
 	data = buf->data + buf->cursize;
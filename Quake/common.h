@@ -54,6 +54,7 @@ typedef struct sizebuf_s
 	byte		*data;
 	int		maxsize;
 	int		cursize;
+	int		growsize;		// if nonzero, data is a Pool_Alloc block that may grow up to this size
 } sizebuf_t;
 
 void SZ_Alloc (sizebuf_t *buf, int startsize);
@@ -495,9 +495,13 @@ void Draw_Character (int x, int y, int num)
 
 	vkCmdBindVertexBuffers(vulkan_globals.command_buffer, 0, 1, &buffer, &buffer_offset);
 	vkCmdBindPipeline(vulkan_globals.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkan_globals.basic_alphatest_pipeline);
+	COUNT (CNT_PIPELINEBINDS, 1);
 	vkCmdBindDescriptorSets(vulkan_globals.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkan_globals.basic_pipeline_layout, 0, 1, char_texture->sampler_set, 0, NULL);
 	vkCmdBindDescriptorSets(vulkan_globals.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkan_globals.basic_pipeline_layout, 1, 1, &char_texture->descriptor_set, 0, NULL);
+	COUNT (CNT_DESCRIPTORSETS, 2);
 	vkCmdDraw(vulkan_globals.command_buffer, 6, 1, 0, 0);
+	COUNT (CNT_DRAWCALLS, 1);
+	COUNT (CNT_TRIANGLES, 2);
 }
 
 /*
@@ -528,9 +532,13 @@ void Draw_String (int x, int y, const char *str)
 
 	vkCmdBindVertexBuffers(vulkan_globals.command_buffer, 0, 1, &buffer, &buffer_offset);
 	vkCmdBindPipeline(vulkan_globals.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkan_globals.basic_alphatest_pipeline);
+	COUNT (CNT_PIPELINEBINDS, 1);
 	vkCmdBindDescriptorSets(vulkan_globals.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkan_globals.basic_pipeline_layout, 0, 1, char_texture->sampler_set, 0, NULL);
 	vkCmdBindDescriptorSets(vulkan_globals.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkan_globals.basic_pipeline_layout, 1, 1, &char_texture->descriptor_set, 0, NULL);
+	COUNT (CNT_DESCRIPTORSETS, 2);
 	vkCmdDraw(vulkan_globals.command_buffer, num_verts, 1, 0, 0);
+	COUNT (CNT_DRAWCALLS, 1);
+	COUNT (CNT_TRIANGLES, num_verts / 3);
 }
 
 /*
@@ -589,9 +597,13 @@ void Draw_Pic (int x, int y, qpic_t *pic, float alpha)
 
 	vkCmdBindVertexBuffers(vulkan_globals.command_buffer, 0, 1, &buffer, &buffer_offset);
 	vkCmdBindPipeline(vulkan_globals.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkan_globals.basic_blend_pipeline);
+	COUNT (CNT_PIPELINEBINDS, 1);
 	vkCmdBindDescriptorSets(vulkan_globals.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkan_globals.basic_pipeline_layout, 0, 1, gl->gltexture->sampler_set, 0, NULL);
 	vkCmdBindDescriptorSets(vulkan_globals.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkan_globals.basic_pipeline_layout, 1, 1, &gl->gltexture->descriptor_set, 0, NULL);
+	COUNT (CNT_DESCRIPTORSETS, 2);
 	vkCmdDraw(vulkan_globals.command_buffer, 6, 1, 0, 0);
+	COUNT (CNT_DRAWCALLS, 1);
+	COUNT (CNT_TRIANGLES, 2);
 }
 
 /*
@@ -718,7 +730,73 @@ void Draw_Fill (int x, int y, int w, int h, int c, float alpha) //johnfitz -- ad
 
 	vkCmdBindVertexBuffers(vulkan_globals.command_buffer, 0, 1, &buffer, &buffer_offset);
 	vkCmdBindPipeline(vulkan_globals.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkan_globals.basic_notex_blend_pipeline);
+	COUNT (CNT_PIPELINEBINDS, 1);
 	vkCmdDraw(vulkan_globals.command_buffer, 6, 1, 0, 0);
+	COUNT (CNT_DRAWCALLS, 1);
+	COUNT (CNT_TRIANGLES, 2);
+}
+
+/*
+=============
+Draw_Graph
+
+Draws count bars one unit wide from the bottom of a box h units high,
+scaled so that peak fills the box, in a single draw call.  The values
+are read from a ring starting at index start.
+=============
+*/
+void Draw_Graph (int x, int y, int h, const int *values, int count, int start, int peak, int c)
+{
+	byte *pal = (byte *)d_8to24table;
+	int i, j, top;
+
+	if (peak <= 0)
+		return;
+
+	VkBuffer buffer;
+	VkDeviceSize buffer_offset;
+	basicvertex_t * vertices = (basicvertex_t*)R_VertexAllocate(count * 6 * sizeof(basicvertex_t), &buffer, &buffer_offset);
+
+	basicvertex_t corner_verts[4];
+	memset(&corner_verts, 0, sizeof(corner_verts));
+	for (j = 0; j < 4; ++j)
+	{
+		corner_verts[j].color[0] = pal[c*4];
+		corner_verts[j].color[1] = pal[c*4+1];
+		corner_verts[j].color[2] = pal[c*4+2];
+		corner_verts[j].color[3] = 255;
+	}
+
+	for (i = 0; i < count; ++i)
+	{
+		top = y + h - q_min(values[(start + i) % count], peak) * h / peak;
+
+		corner_verts[0].position[0] = x + i;
+		corner_verts[0].position[1] = top;
+
+		corner_verts[1].position[0] = x + i + 1;
+		corner_verts[1].position[1] = top;
+
+		corner_verts[2].position[0] = x + i + 1;
+		corner_verts[2].position[1] = y + h;
+
+		corner_verts[3].position[0] = x + i;
+		corner_verts[3].position[1] = y + h;
+
+		vertices[i*6 + 0] = corner_verts[0];
+		vertices[i*6 + 1] = corner_verts[1];
+		vertices[i*6 + 2] = corner_verts[2];
+		vertices[i*6 + 3] = corner_verts[2];
+		vertices[i*6 + 4] = corner_verts[3];
+		vertices[i*6 + 5] = corner_verts[0];
+	}
+
+	vkCmdBindVertexBuffers(vulkan_globals.command_buffer, 0, 1, &buffer, &buffer_offset);
+	vkCmdBindPipeline(vulkan_globals.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkan_globals.basic_notex_blend_pipeline);
+	COUNT (CNT_PIPELINEBINDS, 1);
+	vkCmdDraw(vulkan_globals.command_buffer, count * 6, 1, 0, 0);
+	COUNT (CNT_DRAWCALLS, 1);
+	COUNT (CNT_TRIANGLES, count * 2);
 }
 
 /*
@@ -761,7 +839,10 @@ void Draw_FadeScreen (void)
 
 	vkCmdBindVertexBuffers(vulkan_globals.command_buffer, 0, 1, &buffer, &buffer_offset);
 	vkCmdBindPipeline(vulkan_globals.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkan_globals.basic_notex_blend_pipeline);
+	COUNT (CNT_PIPELINEBINDS, 1);
 	vkCmdDraw(vulkan_globals.command_buffer, 6, 1, 0, 0);
+	COUNT (CNT_DRAWCALLS, 1);
+	COUNT (CNT_TRIANGLES, 2);
 
 	Sbar_Changed();
 }
@@ -814,6 +895,7 @@ void GL_Viewport(float x, float y, float width, float height)
 	viewport.maxDepth = 1.0f;
 
 	vkCmdSetViewport(vulkan_globals.command_buffer, 0, 1, &viewport);
+	vulkan_globals.viewport = viewport;
 }
 
 /*
@@ -462,6 +462,9 @@ static void GLMesh_LoadVertexBuffer (qmodel_t *m, const aliashdr_t *hdr)
 	int f;
 	VkResult err;
 
+	if (isHeadless)
+		return;
+
 // count the sizes we need
 	
 	// ericw -- RMQEngine stored these vbo*ofs values in aliashdr_t, but we must not
@@ -665,6 +668,9 @@ Delete VBOs for all loaded alias models
 */
 void GLMesh_DeleteVertexBuffers (void)
 {
+	if (isHeadless)
+		return;
+
 	GL_WaitForDeviceIdle();
 
 	int j;
@@ -195,6 +195,26 @@ void Mod_ClearAll (void)
 		}
 }
 
+/*
+===================
+Mod_ClearAbove
+
+Like Mod_ClearAll, for the models loaded since the hunk was at mark
+===================
+*/
+void Mod_ClearAbove (int mark)
+{
+	int		i;
+	qmodel_t	*mod;
+
+	for (i=0 , mod=mod_known ; i<mod_numknown ; i++, mod++)
+		if (mod->type != mod_alias && !mod->needload && mod->hunkmark >= mark)
+		{
+			mod->needload = true;
+			TexMgr_FreeTexturesForOwner (mod);
+		}
+}
+
 void Mod_ResetAll (void)
 {
 	int		i;
@@ -320,6 +340,7 @@ qmodel_t *Mod_LoadModel (qmodel_t *mod, qboolean crash)
 
 // call the apropriate loader
 	mod->needload = false;
+	mod->hunkmark = Hunk_LowMark ();
 
 	mod_type = (buf[0] | (buf[1] << 8) | (buf[2] << 16) | (buf[3] << 24));
 	switch (mod_type)
@@ -1970,6 +1991,7 @@ void Mod_LoadBrushModel (qmodel_t *mod, void *buffer)
 	int			bsp2;
 	dheader_t	*header;
 	dmodel_t 	*bm;
+	qmodel_t	*world;
 	float		radius; //johnfitz
 
 	loadmodel->type = mod_brush;
@@ -2030,6 +2052,14 @@ void Mod_LoadBrushModel (qmodel_t *mod, void *buffer)
 	// we're looping through the submodels starting at 0.  Submodel 0 is the main model, so we don't have to
 	// worry about clobbering data the first time through, since it's the same data.  At the end of the loop,
 	// we create a new copy of the data to use the next time through.
+	// a dedicated server also keeps private copies, the shared "*n" entries
+	// are overwritten when another server instance loads a different map
+	world = mod;
+	if (cls.state == ca_dedicated)
+		world->inlinemodels = (qmodel_t *) Hunk_AllocName (world->numsubmodels * sizeof(qmodel_t), "inlinemodels");
+	else
+		world->inlinemodels = NULL;
+
 	for (i=0 ; i<mod->numsubmodels ; i++)
 	{
 		bm = &mod->submodels[i];
@@ -2068,6 +2098,9 @@ void Mod_LoadBrushModel (qmodel_t *mod, void *buffer)
 
 		mod->numleafs = bm->visleafs;
 
+		if (i > 0 && world->inlinemodels)
+			world->inlinemodels[i] = *mod;
+
 		if (i < mod->numsubmodels-1)
 		{	// duplicate the basic information
 			char	name[10];
@@ -163,6 +163,7 @@ typedef struct msurface_s
 	mtexinfo_t	*texinfo;
 
 	int		vbo_firstvert;		// index of this surface's first vert in the VBO
+	int		cachebuild;			// world index cache build this surface was last put in
 
 // lighting info
 	int			dlightframe;
@@ -412,6 +413,7 @@ typedef struct qmodel_s
 	unsigned int	path_id;		// path id of the game directory
 							// that this model came from
 	qboolean	needload;		// bmodels and sprites don't cache normally
+	int			hunkmark;		// low hunk mark it was loaded at, see Mod_ClearAbove
 
 	modtype_t	type;
 	int			numframes;
@@ -440,6 +442,7 @@ typedef struct qmodel_s
 
 	int			numsubmodels;
 	dmodel_t	*submodels;
+	struct qmodel_s	*inlinemodels;	// dedicated only: this map's own copies of "*1".."*n"
 
 	int			numplanes;
 	mplane_t	*planes;
@@ -504,12 +507,14 @@ typedef struct qmodel_s
 
 void	Mod_Init (void);
 void	Mod_ClearAll (void);
+void	Mod_ClearAbove (int mark);
 void	Mod_ResetAll (void); // for gamedir changes (Host_Game_f)
 qmodel_t *Mod_ForName (const char *name, qboolean crash);
 void	*Mod_Extradata (qmodel_t *mod);	// handles caching
 void	Mod_TouchModel (const char *name);
 
 mleaf_t *Mod_PointInLeaf (float *p, qmodel_t *model);
+byte	*Mod_DecompressVis (byte *in, qmodel_t *model);
 byte	*Mod_LeafPVS (mleaf_t *leaf, qmodel_t *model);
 
 void Mod_SetExtraFlags (qmodel_t *mod);
@@ -104,6 +104,12 @@ cvar_t	r_lavaalpha = {"r_lavaalpha","0",CVAR_NONE};
 cvar_t	r_telealpha = {"r_telealpha","0",CVAR_NONE};
 cvar_t	r_slimealpha = {"r_slimealpha","0",CVAR_NONE};
 
+cvar_t	r_instancing = {"r_instancing","1",CVAR_ARCHIVE};
+cvar_t	r_worldcache = {"r_worldcache","1",CVAR_ARCHIVE};
+cvar_t	r_bindless = {"r_bindless","1",CVAR_ARCHIVE};
+cvar_t	r_parallel = {"r_parallel","1",CVAR_ARCHIVE};
+cvar_t	r_gpuculling = {"r_gpuculling","0",CVAR_ARCHIVE};
+
 float	map_wateralpha, map_lavaalpha, map_telealpha, map_slimealpha;
 
 qboolean r_drawflat_cheatsafe, r_fullbright_cheatsafe, r_lightmap_cheatsafe, r_drawworld_cheatsafe; //johnfitz
@@ -484,7 +490,7 @@ R_SetupScene
 */
 void R_SetupScene (void)
 {
-	vkCmdBeginRenderPass(vulkan_globals.command_buffer, &vulkan_globals.main_render_pass_begin_info, VK_SUBPASS_CONTENTS_INLINE);
+	GL_BeginMainRenderPass ();
 
 	R_PushDlights ();
 	R_AnimateLight ();
@@ -535,7 +541,11 @@ void R_SetupView (void)
 
 	R_CullSurfaces (); //johnfitz -- do after R_SetFrustum and R_MarkSurfaces
 
-	R_UpdateWarpTextures (); //johnfitz -- do this before R_Clear
+	if (!isHeadless)
+	{
+		R_UpdateWarpTextures (); //johnfitz -- do this before R_Clear
+		R_UpdateParticles ();
+	}
 
 	//johnfitz -- cheat-protect some draw modes
 	r_drawflat_cheatsafe = r_fullbright_cheatsafe = r_lightmap_cheatsafe = false;
@@ -569,6 +579,10 @@ void R_DrawEntitiesOnList (qboolean alphapass) //johnfitz -- added parameter
 	if (!r_drawentities.value)
 		return;
 
+	// opaque alias models are collected and drawn instanced afterwards
+	if (!alphapass)
+		R_BeginAliasBatch ();
+
 	//johnfitz -- sprites are not a special case
 	for (i=0 ; i<cl_numvisedicts ; i++)
 	{
@@ -598,6 +612,9 @@ void R_DrawEntitiesOnList (qboolean alphapass) //johnfitz -- added parameter
 				break;
 		}
 	}
+
+	if (!alphapass)
+		R_FlushAliasBatch ();
 }
 
 /*
@@ -867,6 +884,8 @@ R_RenderScene
 */
 void R_RenderScene (void)
 {
+	PROF_BEGIN ("R_RenderScene");
+
 	R_SetupScene (); //johnfitz -- this does everything that should be done once per call to RenderScene
 
 	Fog_EnableGFog (); //johnfitz
@@ -896,6 +915,8 @@ void R_RenderScene (void)
 	R_ShowTris (); //johnfitz
 
 	R_ShowBoundingBoxes (); //johnfitz
+
+	PROF_END ();
 }
 
 /*
@@ -928,7 +949,15 @@ void R_RenderView (void)
 
 	R_SetupView (); //johnfitz -- this does everything that should be done once per frame
 
-	R_RenderScene ();
+	if (isHeadless)
+	{
+		// what R_SetupScene does on the CPU, minus the render pass
+		R_PushDlights ();
+		R_AnimateLight ();
+		r_framecount++;
+	}
+	else
+		R_RenderScene ();
 
 	//johnfitz
 
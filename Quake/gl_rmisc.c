@@ -45,6 +45,11 @@ extern cvar_t r_noshadow_list;
 //johnfitz
 extern cvar_t gl_zfix; // QuakeSpasm z-fighting fix
 extern cvar_t vid_filter;
+extern cvar_t r_instancing;
+extern cvar_t r_worldcache;
+extern cvar_t r_bindless;
+extern cvar_t r_parallel;
+extern cvar_t r_gpuculling;
 
 extern gltexture_t *playertextures[MAX_SCOREBOARD]; //johnfitz
 
@@ -76,6 +81,15 @@ static int				current_staging_buffer = 0;
 /*
 ================
 Dynamic vertex/index & uniform buffer
+
+Each frame allocates linearly from a chain of host visible blocks.  When
+the current block runs out another one is chained on, as large as
+everything the pool owns so far, so the pool doubles and a busy frame
+grows it instead of running dry.  GL_BeginRendering waits for the fence
+of the command buffer it is about to reuse and then calls
+R_SwapDynamicBuffers, which puts the chain of the next slot back on the
+free list.  Slots and command buffers both advance once per frame, so
+that chain belongs to the frame whose fence was just waited on.
 ================
 */
 #define DYNAMIC_VERTEX_BUFFER_SIZE_KB	1024
@@ -83,22 +97,36 @@ Dynamic vertex/index & uniform buffer
 #define DYNAMIC_UNIFORM_BUFFER_SIZE_KB	128
 #define NUM_DYNAMIC_BUFFERS				2
 #define MAX_UNIFORM_ALLOC				2048
+#define MAX_UNIFORM_BLOCKS				16
 
-typedef struct
+typedef struct dynbuffer_s
 {
 	VkBuffer			buffer;
+	VkDeviceMemory		memory;
+	uint32_t			size;
 	uint32_t			current_offset;
 	unsigned char *		data;
+	VkDescriptorSet		descriptor_set;		// uniform blocks only
+	struct dynbuffer_s	*next;
 } dynbuffer_t;
 
-static VkDeviceMemory	dyn_vertex_buffer_memory;
-static VkDeviceMemory	dyn_index_buffer_memory;
-static VkDeviceMemory	dyn_uniform_buffer_memory;
-static dynbuffer_t		dyn_vertex_buffers[NUM_DYNAMIC_BUFFERS];
-static dynbuffer_t		dyn_index_buffers[NUM_DYNAMIC_BUFFERS];
-static dynbuffer_t		dyn_uniform_buffers[NUM_DYNAMIC_BUFFERS];
+typedef struct
+{
+	const char *		name;
+	VkBufferUsageFlags	usage;
+	uint32_t			initial_size;
+	dynbuffer_t *		frames[NUM_DYNAMIC_BUFFERS];	// blocks in use, current one first
+	dynbuffer_t *		free;
+	int					numblocks;
+	uint32_t			capacity;
+	uint32_t			frame_used;
+	uint32_t			peak_used;
+} dynpool_t;
+
+static dynpool_t		dyn_vertex_pool = {"vertex", VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, DYNAMIC_VERTEX_BUFFER_SIZE_KB * 1024};
+static dynpool_t		dyn_index_pool = {"index", VK_BUFFER_USAGE_INDEX_BUFFER_BIT, DYNAMIC_INDEX_BUFFER_SIZE_KB * 1024};
+static dynpool_t		dyn_uniform_pool = {"uniform", VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, DYNAMIC_UNIFORM_BUFFER_SIZE_KB * 1024};
 static int				current_dyn_buffer_index = 0;
-static VkDescriptorSet	ubo_descriptor_sets[2];
 
 /*
 ================
@@ -409,219 +437,168 @@ byte * R_StagingAllocate(int size, VkCommandBuffer * command_buffer, VkBuffer *
 
 	unsigned char *data = staging_buffer->data + staging_buffer->current_offset;
 	staging_buffer->current_offset += size;
+	COUNT (CNT_STAGINGBYTES, size);
 
 	return data;
 }
 
 /*
 ===============
-R_InitDynamicVertexBuffers
+R_CreateDynamicBlock
 ===============
 */
-static void R_InitDynamicVertexBuffers()
+static dynbuffer_t *R_CreateDynamicBlock(dynpool_t *pool, uint32_t size)
 {
-	Con_Printf("Initializing dynamic vertex buffers\n");
-
 	VkResult err;
+	dynbuffer_t *block;
+
+	if ((pool->usage & VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT) && pool->numblocks == MAX_UNIFORM_BLOCKS)
+		Sys_Error("Out of dynamic uniform buffer blocks, increase MAX_UNIFORM_BLOCKS");
+
+	block = (dynbuffer_t *) calloc(1, sizeof(dynbuffer_t));
+	if (!block)
+		Sys_Error("R_CreateDynamicBlock: out of memory");
+	block->size = size;
 
 	VkBufferCreateInfo buffer_create_info;
 	memset(&buffer_create_info, 0, sizeof(buffer_create_info));
 	buffer_create_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-	buffer_create_info.size = DYNAMIC_VERTEX_BUFFER_SIZE_KB * 1024;
-	buffer_create_info.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
-
-	for(int i = 0; i < NUM_DYNAMIC_BUFFERS; ++i)
-	{
-		dyn_vertex_buffers[i].current_offset = 0;
+	buffer_create_info.size = size;
+	buffer_create_info.usage = pool->usage;
 
-		err = vkCreateBuffer(vulkan_globals.device, &buffer_create_info, NULL, &dyn_vertex_buffers[i].buffer);
-		if (err != VK_SUCCESS)
-			Sys_Error("vkCreateBuffer failed");
-	}
+	err = vkCreateBuffer(vulkan_globals.device, &buffer_create_info, NULL, &block->buffer);
+	if (err != VK_SUCCESS)
+		Sys_Error("vkCreateBuffer failed");
 
 	VkMemoryRequirements memory_requirements;
-	vkGetBufferMemoryRequirements(vulkan_globals.device, dyn_vertex_buffers[0].buffer, &memory_requirements);
-
-	const int align_mod = memory_requirements.size % memory_requirements.alignment;
-	const int aligned_size = ((memory_requirements.size % memory_requirements.alignment) == 0) 
-		? memory_requirements.size 
-		: (memory_requirements.size + memory_requirements.alignment - align_mod);
+	vkGetBufferMemoryRequirements(vulkan_globals.device, block->buffer, &memory_requirements);
 
 	VkMemoryAllocateInfo memory_allocate_info;
 	memset(&memory_allocate_info, 0, sizeof(memory_allocate_info));
 	memory_allocate_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-	memory_allocate_info.allocationSize = NUM_DYNAMIC_BUFFERS * aligned_size;
+	memory_allocate_info.allocationSize = memory_requirements.size;
 	memory_allocate_info.memoryTypeIndex = GL_MemoryTypeFromProperties(memory_requirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
 
-	err = vkAllocateMemory(vulkan_globals.device, &memory_allocate_info, NULL, &dyn_vertex_buffer_memory);
+	err = vkAllocateMemory(vulkan_globals.device, &memory_allocate_info, NULL, &block->memory);
 	if (err != VK_SUCCESS)
 		Sys_Error("vkAllocateMemory failed");
 
-	for(int i = 0; i < NUM_DYNAMIC_BUFFERS; ++i)
+	err = vkBindBufferMemory(vulkan_globals.device, block->buffer, block->memory, 0);
+	if (err != VK_SUCCESS)
+		Sys_Error("vkBindBufferMemory failed");
+
+	err = vkMapMemory(vulkan_globals.device, block->memory, 0, size, 0, (void **)&block->data);
+	if (err != VK_SUCCESS)
+		Sys_Error("vkMapMemory failed");
+
+	if (pool->usage & VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT)
 	{
-		err = vkBindBufferMemory(vulkan_globals.device, dyn_vertex_buffers[i].buffer, dyn_vertex_buffer_memory, i * aligned_size);
+		VkDescriptorSetAllocateInfo descriptor_set_allocate_info;
+		memset(&descriptor_set_allocate_info, 0, sizeof(descriptor_set_allocate_info));
+		descriptor_set_allocate_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		descriptor_set_allocate_info.descriptorPool = vulkan_globals.descriptor_pool;
+		descriptor_set_allocate_info.descriptorSetCount = 1;
+		descriptor_set_allocate_info.pSetLayouts = &vulkan_globals.ubo_set_layout;
+
+		err = vkAllocateDescriptorSets(vulkan_globals.device, &descriptor_set_allocate_info, &block->descriptor_set);
 		if (err != VK_SUCCESS)
-			Sys_Error("vkBindBufferMemory failed");
+			Sys_Error("vkAllocateDescriptorSets failed");
+
+		VkDescriptorBufferInfo buffer_info;
+		memset(&buffer_info, 0, sizeof(buffer_info));
+		buffer_info.buffer = block->buffer;
+		buffer_info.offset = 0;
+		buffer_info.range = MAX_UNIFORM_ALLOC;
+
+		VkWriteDescriptorSet ubo_write;
+		memset(&ubo_write, 0, sizeof(ubo_write));
+		ubo_write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		ubo_write.dstSet = block->descriptor_set;
+		ubo_write.dstBinding = 0;
+		ubo_write.dstArrayElement = 0;
+		ubo_write.descriptorCount = 1;
+		ubo_write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+		ubo_write.pBufferInfo = &buffer_info;
+		vkUpdateDescriptorSets(vulkan_globals.device, 1, &ubo_write, 0, NULL);
 	}
 
-	unsigned char * data;
-	err = vkMapMemory(vulkan_globals.device, dyn_vertex_buffer_memory, 0, NUM_DYNAMIC_BUFFERS * aligned_size, 0, &data);
-	if (err != VK_SUCCESS)
-		Sys_Error("vkMapMemory failed");
+	pool->numblocks++;
+	pool->capacity += size;
 
-	for(int i = 0; i < NUM_DYNAMIC_BUFFERS; ++i)
-		dyn_vertex_buffers[i].data = data + (i * aligned_size);
+	return block;
 }
 
 /*
 ===============
-R_InitDynamicIndexBuffers
+R_DynamicAllocate
+
+Returns a block of the current frame's chain with size bytes free at
+the returned offset, rounded up to alignment.  reserve is how much
+must fit past that offset, which is more than size for uniforms since
+the descriptor range always covers MAX_UNIFORM_ALLOC.
 ===============
 */
-static void R_InitDynamicIndexBuffers()
+static dynbuffer_t *R_DynamicAllocate(dynpool_t *pool, uint32_t size, uint32_t reserve, uint32_t alignment, uint32_t *offset)
 {
-	Con_Printf("Initializing dynamic index buffers\n");
+	dynbuffer_t *block = pool->frames[current_dyn_buffer_index];
+	dynbuffer_t **link;
+	uint32_t aligned_offset = 0;
 
-	VkResult err;
-
-	VkBufferCreateInfo buffer_create_info;
-	memset(&buffer_create_info, 0, sizeof(buffer_create_info));
-	buffer_create_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-	buffer_create_info.size = DYNAMIC_INDEX_BUFFER_SIZE_KB * 1024;
-	buffer_create_info.usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+	if (block)
+		aligned_offset = (block->current_offset + alignment - 1) & ~(alignment - 1);
 
-	for(int i = 0; i < NUM_DYNAMIC_BUFFERS; ++i)
+	if (!block || (aligned_offset + reserve) > block->size)
 	{
-		dyn_index_buffers[i].current_offset = 0;
-
-		err = vkCreateBuffer(vulkan_globals.device, &buffer_create_info, NULL, &dyn_index_buffers[i].buffer);
-		if (err != VK_SUCCESS)
-			Sys_Error("vkCreateBuffer failed");
-	}
-
-	VkMemoryRequirements memory_requirements;
-	vkGetBufferMemoryRequirements(vulkan_globals.device, dyn_index_buffers[0].buffer, &memory_requirements);
+		// reuse a recycled block if one is big enough, otherwise chain a new one
+		for (link = &pool->free; *link; link = &(*link)->next)
+			if ((*link)->size >= reserve)
+				break;
 
-	const int align_mod = memory_requirements.size % memory_requirements.alignment;
-	const int aligned_size = ((memory_requirements.size % memory_requirements.alignment) == 0) 
-		? memory_requirements.size 
-		: (memory_requirements.size + memory_requirements.alignment - align_mod);
-
-	VkMemoryAllocateInfo memory_allocate_info;
-	memset(&memory_allocate_info, 0, sizeof(memory_allocate_info));
-	memory_allocate_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-	memory_allocate_info.allocationSize = NUM_DYNAMIC_BUFFERS * aligned_size;
-	memory_allocate_info.memoryTypeIndex = GL_MemoryTypeFromProperties(memory_requirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
-
-	err = vkAllocateMemory(vulkan_globals.device, &memory_allocate_info, NULL, &dyn_index_buffer_memory);
-	if (err != VK_SUCCESS)
-		Sys_Error("vkAllocateMemory failed");
+		if (*link)
+		{
+			block = *link;
+			*link = block->next;
+		}
+		else
+		{
+			uint32_t new_size = q_max(pool->initial_size, q_max(reserve, pool->capacity));
+			block = R_CreateDynamicBlock(pool, new_size);
+			if (pool->numblocks > NUM_DYNAMIC_BUFFERS)
+				Con_DPrintf("Grew dynamic %s buffer to %u KB in %d blocks\n", pool->name, pool->capacity / 1024, pool->numblocks);
+		}
 
-	for(int i = 0; i < NUM_DYNAMIC_BUFFERS; ++i)
-	{
-		err = vkBindBufferMemory(vulkan_globals.device, dyn_index_buffers[i].buffer, dyn_index_buffer_memory, i * aligned_size);
-		if (err != VK_SUCCESS)
-			Sys_Error("vkBindBufferMemory failed");
+		block->current_offset = 0;
+		block->next = pool->frames[current_dyn_buffer_index];
+		pool->frames[current_dyn_buffer_index] = block;
+		aligned_offset = 0;
 	}
 
-	unsigned char * data;
-	err = vkMapMemory(vulkan_globals.device, dyn_index_buffer_memory, 0, NUM_DYNAMIC_BUFFERS * aligned_size, 0, &data);
-	if (err != VK_SUCCESS)
-		Sys_Error("vkMapMemory failed");
+	pool->frame_used += (aligned_offset - block->current_offset) + size;
+	block->current_offset = aligned_offset + size;
+	*offset = aligned_offset;
 
-	for(int i = 0; i < NUM_DYNAMIC_BUFFERS; ++i)
-		dyn_index_buffers[i].data = data + (i * aligned_size);
+	return block;
 }
 
 /*
 ===============
-R_InitDynamicUniformBuffers
+R_RecycleDynamicPool
 ===============
 */
-static void R_InitDynamicUniformBuffers()
+static void R_RecycleDynamicPool(dynpool_t *pool)
 {
-	Con_Printf("Initializing dynamic uniform buffers\n");
+	dynbuffer_t *block, *next;
 
-	VkResult err;
+	pool->peak_used = q_max(pool->peak_used, pool->frame_used);
+	pool->frame_used = 0;
 
-	VkBufferCreateInfo buffer_create_info;
-	memset(&buffer_create_info, 0, sizeof(buffer_create_info));
-	buffer_create_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-	buffer_create_info.size = DYNAMIC_UNIFORM_BUFFER_SIZE_KB * 1024;
-	buffer_create_info.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
-
-	for(int i = 0; i < NUM_DYNAMIC_BUFFERS; ++i)
+	for (block = pool->frames[current_dyn_buffer_index]; block; block = next)
 	{
-		dyn_uniform_buffers[i].current_offset = 0;
-
-		err = vkCreateBuffer(vulkan_globals.device, &buffer_create_info, NULL, &dyn_uniform_buffers[i].buffer);
-		if (err != VK_SUCCESS)
-			Sys_Error("vkCreateBuffer failed");
-	}
-
-	VkMemoryRequirements memory_requirements;
-	vkGetBufferMemoryRequirements(vulkan_globals.device, dyn_uniform_buffers[0].buffer, &memory_requirements);
-
-	const int align_mod = memory_requirements.size % memory_requirements.alignment;
-	const int aligned_size = ((memory_requirements.size % memory_requirements.alignment) == 0) 
-		? memory_requirements.size 
-		: (memory_requirements.size + memory_requirements.alignment - align_mod);
-
-	VkMemoryAllocateInfo memory_allocate_info;
-	memset(&memory_allocate_info, 0, sizeof(memory_allocate_info));
-	memory_allocate_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-	memory_allocate_info.allocationSize = NUM_DYNAMIC_BUFFERS * aligned_size;
-	memory_allocate_info.memoryTypeIndex = GL_MemoryTypeFromProperties(memory_requirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
-
-	err = vkAllocateMemory(vulkan_globals.device, &memory_allocate_info, NULL, &dyn_uniform_buffer_memory);
-	if (err != VK_SUCCESS)
-		Sys_Error("vkAllocateMemory failed");
-
-	for(int i = 0; i < NUM_DYNAMIC_BUFFERS; ++i)
-	{
-		err = vkBindBufferMemory(vulkan_globals.device, dyn_uniform_buffers[i].buffer, dyn_uniform_buffer_memory, i * aligned_size);
-		if (err != VK_SUCCESS)
-			Sys_Error("vkBindBufferMemory failed");
-	}
-
-	unsigned char * data;
-	err = vkMapMemory(vulkan_globals.device, dyn_uniform_buffer_memory, 0, NUM_DYNAMIC_BUFFERS * aligned_size, 0, &data);
-	if (err != VK_SUCCESS)
-		Sys_Error("vkMapMemory failed");
-
-	for(int i = 0; i < NUM_DYNAMIC_BUFFERS; ++i)
-		dyn_uniform_buffers[i].data = data + (i * aligned_size);
-
-	VkDescriptorSetAllocateInfo descriptor_set_allocate_info;
-	memset(&descriptor_set_allocate_info, 0, sizeof(descriptor_set_allocate_info));
-	descriptor_set_allocate_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-	descriptor_set_allocate_info.descriptorPool = vulkan_globals.descriptor_pool;
-	descriptor_set_allocate_info.descriptorSetCount = 1;
-	descriptor_set_allocate_info.pSetLayouts = &vulkan_globals.ubo_set_layout;
-
-	vkAllocateDescriptorSets(vulkan_globals.device, &descriptor_set_allocate_info, &ubo_descriptor_sets[0]);
-	vkAllocateDescriptorSets(vulkan_globals.device, &descriptor_set_allocate_info, &ubo_descriptor_sets[1]);
-
-	VkDescriptorBufferInfo buffer_info;
-	memset(&buffer_info, 0, sizeof(buffer_info));
-	buffer_info.offset = 0;
-	buffer_info.range = MAX_UNIFORM_ALLOC;
-
-	VkWriteDescriptorSet ubo_write;
-	memset(&ubo_write, 0, sizeof(ubo_write));
-	ubo_write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-	ubo_write.dstBinding = 0;
-	ubo_write.dstArrayElement = 0;
-	ubo_write.descriptorCount = 1;
-	ubo_write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
-	ubo_write.pBufferInfo = &buffer_info;
-
-	for(int i = 0; i < NUM_DYNAMIC_BUFFERS; ++i)
-	{
-		buffer_info.buffer = dyn_uniform_buffers[i].buffer;
-		ubo_write.dstSet = ubo_descriptor_sets[i];
-		vkUpdateDescriptorSets(vulkan_globals.device, 1, &ubo_write, 0, NULL);
+		next = block->next;
+		block->next = pool->free;
+		pool->free = block;
 	}
+	pool->frames[current_dyn_buffer_index] = NULL;
 }
 
 /*
@@ -632,9 +609,9 @@ R_SwapDynamicBuffers
 void R_SwapDynamicBuffers()
 {
 	current_dyn_buffer_index = (current_dyn_buffer_index + 1) % NUM_DYNAMIC_BUFFERS;
-	dyn_vertex_buffers[current_dyn_buffer_index].current_offset = 0;
-	dyn_index_buffers[current_dyn_buffer_index].current_offset = 0;
-	dyn_uniform_buffers[current_dyn_buffer_index].current_offset = 0;
+	R_RecycleDynamicPool(&dyn_vertex_pool);
+	R_RecycleDynamicPool(&dyn_index_pool);
+	R_RecycleDynamicPool(&dyn_uniform_pool);
 }
 
 /*
@@ -644,18 +621,13 @@ R_VertexAllocate
 */
 byte * R_VertexAllocate(int size, VkBuffer * buffer, VkDeviceSize * buffer_offset)
 {
-	dynbuffer_t *dyn_vb = &dyn_vertex_buffers[current_dyn_buffer_index];
-
-	if ((dyn_vb->current_offset + size) > (DYNAMIC_VERTEX_BUFFER_SIZE_KB * 1024))
-		Sys_Error("Out of dynamic vertex buffer space, increase DYNAMIC_VERTEX_BUFFER_SIZE_KB");
+	uint32_t offset;
+	dynbuffer_t *dyn_vb = R_DynamicAllocate(&dyn_vertex_pool, size, size, 16, &offset);
 
 	*buffer = dyn_vb->buffer;
-	*buffer_offset = dyn_vb->current_offset;
+	*buffer_offset = offset;
 
-	unsigned char *data = dyn_vb->data + dyn_vb->current_offset;
-	dyn_vb->current_offset += size;
-
-	return data;
+	return dyn_vb->data + offset;
 }
 
 /*
@@ -665,18 +637,13 @@ R_IndexAllocate
 */
 byte * R_IndexAllocate(int size, VkBuffer * buffer, VkDeviceSize * buffer_offset)
 {
-	dynbuffer_t *dyn_ib = &dyn_index_buffers[current_dyn_buffer_index];
-
-	if ((dyn_ib->current_offset + size) > (DYNAMIC_INDEX_BUFFER_SIZE_KB * 1024))
-		Sys_Error("Out of dynamic index buffer space, increase DYNAMIC_INDEX_BUFFER_SIZE_KB");
+	uint32_t offset;
+	dynbuffer_t *dyn_ib = R_DynamicAllocate(&dyn_index_pool, size, size, 4, &offset);
 
 	*buffer = dyn_ib->buffer;
-	*buffer_offset = dyn_ib->current_offset;
-
-	unsigned char *data = dyn_ib->data + dyn_ib->current_offset;
-	dyn_ib->current_offset += size;
+	*buffer_offset = offset;
 
-	return data;
+	return dyn_ib->data + offset;
 }
 
 /*
@@ -692,23 +659,31 @@ byte * R_UniformAllocate(int size, VkBuffer * buffer, uint32_t * buffer_offset,
 	if (size > MAX_UNIFORM_ALLOC)
 		Sys_Error("Increase MAX_UNIFORM_ALLOC");
 
-	const int align_mod = size % 256;
-	const int aligned_size = ((size % 256) == 0) ? size : (size + 256 - align_mod);
-
-	dynbuffer_t *dyn_ub = &dyn_uniform_buffers[current_dyn_buffer_index];
-
-	if ((dyn_ub->current_offset + MAX_UNIFORM_ALLOC) > (DYNAMIC_UNIFORM_BUFFER_SIZE_KB * 1024))
-		Sys_Error("Out of dynamic uniform buffer space, increase DYNAMIC_UNIFORM_BUFFER_SIZE_KB");
+	uint32_t offset;
+	dynbuffer_t *dyn_ub = R_DynamicAllocate(&dyn_uniform_pool, size, MAX_UNIFORM_ALLOC, 256, &offset);
 
 	*buffer = dyn_ub->buffer;
-	*buffer_offset = dyn_ub->current_offset;
+	*buffer_offset = offset;
+	*descriptor_set = dyn_ub->descriptor_set;
 
-	unsigned char *data = dyn_ub->data + dyn_ub->current_offset;
-	dyn_ub->current_offset += aligned_size;
+	return dyn_ub->data + offset;
+}
 
-	*descriptor_set = ubo_descriptor_sets[current_dyn_buffer_index];
+/*
+===============
+R_DynamicBuffers_f
 
-	return data;
+Prints how big each dynamic pool has grown and the most any one frame
+has used of it.
+===============
+*/
+static void R_DynamicBuffers_f(void)
+{
+	dynpool_t *pools[3] = {&dyn_vertex_pool, &dyn_index_pool, &dyn_uniform_pool};
+
+	for (int i = 0; i < 3; ++i)
+		Con_Printf("%-8s %2d blocks %6u KB, peak frame %6u KB, last frame %6u KB\n", pools[i]->name, pools[i]->numblocks,
+			pools[i]->capacity / 1024, pools[i]->peak_used / 1024, pools[i]->frame_used / 1024);
 }
 
 /*
@@ -718,9 +693,22 @@ R_InitDynamicBuffers
 */
 void R_InitDynamicBuffers()
 {
-	R_InitDynamicVertexBuffers();
-	R_InitDynamicIndexBuffers();
-	R_InitDynamicUniformBuffers();
+	dynpool_t *pools[3] = {&dyn_vertex_pool, &dyn_index_pool, &dyn_uniform_pool};
+
+	Con_Printf("Initializing dynamic buffers\n");
+
+	// one block per frame slot up front, like the fixed rings this replaced
+	for (int i = 0; i < 3; ++i)
+	{
+		for (int j = 0; j < NUM_DYNAMIC_BUFFERS; ++j)
+		{
+			dynbuffer_t *block = R_CreateDynamicBlock(pools[i], pools[i]->initial_size);
+			block->next = pools[i]->free;
+			pools[i]->free = block;
+		}
+	}
+
+	Cmd_AddCommand("r_dynbuffers", R_DynamicBuffers_f);
 }
 
 /*
@@ -782,6 +770,81 @@ void R_CreateDescriptorSetLayouts()
 	err = vkCreateDescriptorSetLayout(vulkan_globals.device, &descriptor_set_layout_create_info, NULL, &vulkan_globals.ubo_set_layout);
 	if (err != VK_SUCCESS)
 		Sys_Error("vkCreateDescriptorSetLayout failed");
+
+	if (vulkan_globals.bindless)
+	{
+		// One slot per gltexture_t. Slots of textures a frame in flight does not
+		// draw with are rewritten while it is pending, slots nothing was loaded
+		// into stay empty and freed ones point at nulltexture.
+		VkDescriptorSetLayoutBinding bindless_layout_binding;
+		memset(&bindless_layout_binding, 0, sizeof(bindless_layout_binding));
+		bindless_layout_binding.binding = 0;
+		bindless_layout_binding.descriptorCount = MAX_GLTEXTURES;
+		bindless_layout_binding.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+		bindless_layout_binding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+		VkDescriptorBindingFlagsEXT bindless_binding_flags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT_EXT;
+
+		VkDescriptorSetLayoutBindingFlagsCreateInfoEXT binding_flags_create_info;
+		memset(&binding_flags_create_info, 0, sizeof(binding_flags_create_info));
+		binding_flags_create_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT;
+		binding_flags_create_info.bindingCount = 1;
+		binding_flags_create_info.pBindingFlags = &bindless_binding_flags;
+
+		descriptor_set_layout_create_info.pNext = &binding_flags_create_info;
+		descriptor_set_layout_create_info.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT;
+		descriptor_set_layout_create_info.bindingCount = 1;
+		descriptor_set_layout_create_info.pBindings = &bindless_layout_binding;
+
+		err = vkCreateDescriptorSetLayout(vulkan_globals.device, &descriptor_set_layout_create_info, NULL, &vulkan_globals.bindless_set_layout);
+		if (err != VK_SUCCESS)
+			Sys_Error("vkCreateDescriptorSetLayout failed");
+
+		descriptor_set_layout_create_info.pNext = NULL;
+		descriptor_set_layout_create_info.flags = 0;
+	}
+
+	if (vulkan_globals.gpu_culling)
+	{
+		// Surfaces, their leafs, source indices, PVS bits, culled indices and indirect draws
+		VkDescriptorSetLayoutBinding world_cull_layout_bindings[6];
+		memset(world_cull_layout_bindings, 0, sizeof(world_cull_layout_bindings));
+		for (int i = 0; i < 6; ++i)
+		{
+			world_cull_layout_bindings[i].binding = i;
+			world_cull_layout_bindings[i].descriptorCount = 1;
+			world_cull_layout_bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			world_cull_layout_bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+		}
+
+		descriptor_set_layout_create_info.bindingCount = 6;
+		descriptor_set_layout_create_info.pBindings = world_cull_layout_bindings;
+
+		err = vkCreateDescriptorSetLayout(vulkan_globals.device, &descriptor_set_layout_create_info, NULL, &vulkan_globals.world_cull_set_layout);
+		if (err != VK_SUCCESS)
+			Sys_Error("vkCreateDescriptorSetLayout failed");
+	}
+
+	if (vulkan_globals.gpu_particles)
+	{
+		// Particles, expanded vertices, indirect draw and palette
+		VkDescriptorSetLayoutBinding particle_layout_bindings[4];
+		memset(particle_layout_bindings, 0, sizeof(particle_layout_bindings));
+		for (int i = 0; i < 4; ++i)
+		{
+			particle_layout_bindings[i].binding = i;
+			particle_layout_bindings[i].descriptorCount = 1;
+			particle_layout_bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			particle_layout_bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+		}
+
+		descriptor_set_layout_create_info.bindingCount = 4;
+		descriptor_set_layout_create_info.pBindings = particle_layout_bindings;
+
+		err = vkCreateDescriptorSetLayout(vulkan_globals.device, &descriptor_set_layout_create_info, NULL, &vulkan_globals.particle_compute_set_layout);
+		if (err != VK_SUCCESS)
+			Sys_Error("vkCreateDescriptorSetLayout failed");
+	}
 }
 
 /*
@@ -791,19 +854,21 @@ R_CreateDescriptorPool
 */
 void R_CreateDescriptorPool()
 {
-	VkDescriptorPoolSize pool_sizes[3];
+	VkDescriptorPoolSize pool_sizes[4];
 	pool_sizes[0].type = VK_DESCRIPTOR_TYPE_SAMPLER;
 	pool_sizes[0].descriptorCount = 16;
 	pool_sizes[1].type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
 	pool_sizes[1].descriptorCount = MAX_GLTEXTURES;
 	pool_sizes[2].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
-	pool_sizes[2].descriptorCount = 16;
+	pool_sizes[2].descriptorCount = MAX_UNIFORM_BLOCKS;
+	pool_sizes[3].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	pool_sizes[3].descriptorCount = 2 * 6 + 4; // world culling sets, particle set
 
 	VkDescriptorPoolCreateInfo descriptor_pool_create_info;
 	memset(&descriptor_pool_create_info, 0, sizeof(descriptor_pool_create_info));
 	descriptor_pool_create_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
 	descriptor_pool_create_info.maxSets = MAX_GLTEXTURES + 32;
-	descriptor_pool_create_info.poolSizeCount = 3;
+	descriptor_pool_create_info.poolSizeCount = 4;
 	descriptor_pool_create_info.pPoolSizes = pool_sizes;
 
 	vkCreateDescriptorPool(vulkan_globals.device, &descriptor_pool_create_info, NULL, &vulkan_globals.descriptor_pool);
@@ -817,6 +882,28 @@ void R_CreateDescriptorPool()
 
 	vkAllocateDescriptorSets(vulkan_globals.device, &descriptor_set_allocate_info, &vulkan_globals.sampler_descriptor_set);
 	vkAllocateDescriptorSets(vulkan_globals.device, &descriptor_set_allocate_info, &vulkan_globals.point_sampler_descriptor_set);
+
+	if (vulkan_globals.bindless)
+	{
+		// Update-after-bind sets need a pool of their own
+		VkDescriptorPoolSize bindless_pool_size;
+		bindless_pool_size.type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+		bindless_pool_size.descriptorCount = MAX_GLTEXTURES;
+
+		descriptor_pool_create_info.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT;
+		descriptor_pool_create_info.maxSets = 1;
+		descriptor_pool_create_info.poolSizeCount = 1;
+		descriptor_pool_create_info.pPoolSizes = &bindless_pool_size;
+
+		if (vkCreateDescriptorPool(vulkan_globals.device, &descriptor_pool_create_info, NULL, &vulkan_globals.bindless_descriptor_pool) != VK_SUCCESS)
+			Sys_Error("vkCreateDescriptorPool failed");
+
+		descriptor_set_allocate_info.descriptorPool = vulkan_globals.bindless_descriptor_pool;
+		descriptor_set_allocate_info.pSetLayouts = &vulkan_globals.bindless_set_layout;
+
+		if (vkAllocateDescriptorSets(vulkan_globals.device, &descriptor_set_allocate_info, &vulkan_globals.bindless_descriptor_set) != VK_SUCCESS)
+			Sys_Error("vkAllocateDescriptorSets failed");
+	}
 }
 
 /*
@@ -833,19 +920,25 @@ void R_CreatePipelineLayouts()
 	// Basic
 	VkDescriptorSetLayout basic_descriptor_set_layouts[2] = { vulkan_globals.sampler_set_layout, vulkan_globals.single_texture_set_layout };
 	
-	VkPushConstantRange push_constant_range;
-	memset(&push_constant_range, 0, sizeof(push_constant_range));
-	push_constant_range.offset = 0;
-	push_constant_range.size = 16 * sizeof(float);
-	push_constant_range.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+	// All layouts share the same push constant ranges so the matrix pushed once
+	// per frame stays valid across pipeline switches. The fragment range holds
+	// the texture indices of the bindless world pipeline.
+	VkPushConstantRange push_constant_ranges[2];
+	memset(push_constant_ranges, 0, sizeof(push_constant_ranges));
+	push_constant_ranges[0].offset = 0;
+	push_constant_ranges[0].size = 16 * sizeof(float);
+	push_constant_ranges[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+	push_constant_ranges[1].offset = 16 * sizeof(float);
+	push_constant_ranges[1].size = 4 * sizeof(int32_t);
+	push_constant_ranges[1].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
 
 	VkPipelineLayoutCreateInfo pipeline_layout_create_info;
 	memset(&pipeline_layout_create_info, 0, sizeof(pipeline_layout_create_info));
 	pipeline_layout_create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
 	pipeline_layout_create_info.setLayoutCount = 2;
 	pipeline_layout_create_info.pSetLayouts = basic_descriptor_set_layouts;
-	pipeline_layout_create_info.pushConstantRangeCount = 1;
-	pipeline_layout_create_info.pPushConstantRanges = &push_constant_range;
+	pipeline_layout_create_info.pushConstantRangeCount = 2;
+	pipeline_layout_create_info.pPushConstantRanges = push_constant_ranges;
 
 	err = vkCreatePipelineLayout(vulkan_globals.device, &pipeline_layout_create_info, NULL, &vulkan_globals.basic_pipeline_layout);
 	if (err != VK_SUCCESS)
@@ -866,6 +959,21 @@ void R_CreatePipelineLayouts()
 	if (err != VK_SUCCESS)
 		Sys_Error("vkCreatePipelineLayout failed");
 
+	if (vulkan_globals.bindless)
+	{
+		VkDescriptorSetLayout world_bindless_descriptor_set_layouts[2] = {
+			vulkan_globals.sampler_set_layout,
+			vulkan_globals.bindless_set_layout
+		};
+
+		pipeline_layout_create_info.setLayoutCount = 2;
+		pipeline_layout_create_info.pSetLayouts = world_bindless_descriptor_set_layouts;
+
+		err = vkCreatePipelineLayout(vulkan_globals.device, &pipeline_layout_create_info, NULL, &vulkan_globals.world_bindless_pipeline_layout);
+		if (err != VK_SUCCESS)
+			Sys_Error("vkCreatePipelineLayout failed");
+	}
+
 	// Alias
 	VkDescriptorSetLayout alias_descriptor_set_layouts[4] = { 
 		vulkan_globals.sampler_set_layout,
@@ -894,6 +1002,44 @@ void R_CreatePipelineLayouts()
 	err = vkCreatePipelineLayout(vulkan_globals.device, &pipeline_layout_create_info, NULL, &vulkan_globals.sky_layer_pipeline_layout);
 	if (err != VK_SUCCESS)
 		Sys_Error("vkCreatePipelineLayout failed");
+
+	if (vulkan_globals.gpu_culling)
+	{
+		// Compute only, so it gets a range of its own: frustum planes, view origin and surface count
+		VkPushConstantRange world_cull_push_constant_range;
+		memset(&world_cull_push_constant_range, 0, sizeof(world_cull_push_constant_range));
+		world_cull_push_constant_range.offset = 0;
+		world_cull_push_constant_range.size = 20 * sizeof(float);
+		world_cull_push_constant_range.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+		pipeline_layout_create_info.setLayoutCount = 1;
+		pipeline_layout_create_info.pSetLayouts = &vulkan_globals.world_cull_set_layout;
+		pipeline_layout_create_info.pushConstantRangeCount = 1;
+		pipeline_layout_create_info.pPushConstantRanges = &world_cull_push_constant_range;
+
+		err = vkCreatePipelineLayout(vulkan_globals.device, &pipeline_layout_create_info, NULL, &vulkan_globals.world_cull_pipeline_layout);
+		if (err != VK_SUCCESS)
+			Sys_Error("vkCreatePipelineLayout failed");
+	}
+
+	if (vulkan_globals.gpu_particles)
+	{
+		// View origin and axes, times, gravity and particle count
+		VkPushConstantRange particle_push_constant_range;
+		memset(&particle_push_constant_range, 0, sizeof(particle_push_constant_range));
+		particle_push_constant_range.offset = 0;
+		particle_push_constant_range.size = 20 * sizeof(float);
+		particle_push_constant_range.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+		pipeline_layout_create_info.setLayoutCount = 1;
+		pipeline_layout_create_info.pSetLayouts = &vulkan_globals.particle_compute_set_layout;
+		pipeline_layout_create_info.pushConstantRangeCount = 1;
+		pipeline_layout_create_info.pPushConstantRanges = &particle_push_constant_range;
+
+		err = vkCreatePipelineLayout(vulkan_globals.device, &pipeline_layout_create_info, NULL, &vulkan_globals.particle_compute_pipeline_layout);
+		if (err != VK_SUCCESS)
+			Sys_Error("vkCreatePipelineLayout failed");
+	}
 }
 
 /*
@@ -971,6 +1117,126 @@ void R_InitSamplers()
 	vkUpdateDescriptorSets(vulkan_globals.device, 2, sampler_writes, 0, NULL);
 }
 
+/*
+===============
+R_InitPipelineCache
+
+Seeds the pipeline cache from the file R_SavePipelineCache wrote, unless it
+came from another device or driver. Drivers check the data themselves as
+well, but not all of them do so reliably.
+===============
+*/
+#define PIPELINE_CACHE_FILE		"vkquake.pipelinecache"
+#define PIPELINE_CACHE_VERSION	1
+
+typedef struct
+{
+	char		magic[4];		// "VKPC"
+	uint32_t	version;		// PIPELINE_CACHE_VERSION
+	uint32_t	vendor_id;
+	uint32_t	device_id;
+	uint32_t	driver_version;
+	byte		uuid[VK_UUID_SIZE];	// pipelineCacheUUID
+	uint32_t	data_size;
+} pipelinecacheheader_t;
+
+static void R_PipelineCacheHeader (pipelinecacheheader_t *header, uint32_t data_size)
+{
+	memset(header, 0, sizeof(*header));
+	memcpy(header->magic, "VKPC", 4);
+	header->version = PIPELINE_CACHE_VERSION;
+	header->vendor_id = vulkan_globals.device_properties.vendorID;
+	header->device_id = vulkan_globals.device_properties.deviceID;
+	header->driver_version = vulkan_globals.device_properties.driverVersion;
+	memcpy(header->uuid, vulkan_globals.device_properties.pipelineCacheUUID, VK_UUID_SIZE);
+	header->data_size = data_size;
+}
+
+void R_InitPipelineCache (void)
+{
+	VkResult err;
+	FILE *f;
+	pipelinecacheheader_t header, expected;
+	void *data = NULL;
+
+	f = fopen(va("%s/%s", host_parms->userdir, PIPELINE_CACHE_FILE), "rb");
+	if (f)
+	{
+		if (fread(&header, sizeof(header), 1, f) == 1)
+		{
+			R_PipelineCacheHeader(&expected, header.data_size);
+			if (memcmp(&header, &expected, sizeof(header)) != 0)
+				Con_Printf("Pipeline cache is from another device or driver, ignored\n");
+			else if ((data = malloc(header.data_size)) != NULL && fread(data, header.data_size, 1, f) != 1)
+			{
+				free(data);
+				data = NULL;
+			}
+		}
+		fclose(f);
+	}
+
+	VkPipelineCacheCreateInfo pipeline_cache_create_info;
+	memset(&pipeline_cache_create_info, 0, sizeof(pipeline_cache_create_info));
+	pipeline_cache_create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+	pipeline_cache_create_info.initialDataSize = data ? header.data_size : 0;
+	pipeline_cache_create_info.pInitialData = data;
+
+	err = vkCreatePipelineCache(vulkan_globals.device, &pipeline_cache_create_info, NULL, &vulkan_globals.pipeline_cache);
+	if (err != VK_SUCCESS && data)
+	{
+		// rejected by the driver, start empty
+		pipeline_cache_create_info.initialDataSize = 0;
+		pipeline_cache_create_info.pInitialData = NULL;
+		err = vkCreatePipelineCache(vulkan_globals.device, &pipeline_cache_create_info, NULL, &vulkan_globals.pipeline_cache);
+	}
+	if (err != VK_SUCCESS)
+		Sys_Error("vkCreatePipelineCache failed");
+
+	if (data)
+		Con_Printf("Loaded %u bytes of pipeline cache\n", header.data_size);
+	free(data);
+}
+
+/*
+===============
+R_SavePipelineCache
+
+Called at shutdown, writes the pipeline cache for the next start.
+===============
+*/
+void R_SavePipelineCache (void)
+{
+	FILE *f;
+	size_t data_size;
+	void *data;
+	pipelinecacheheader_t header;
+
+	if (vulkan_globals.pipeline_cache == VK_NULL_HANDLE)
+		return;
+
+	if (vkGetPipelineCacheData(vulkan_globals.device, vulkan_globals.pipeline_cache, &data_size, NULL) != VK_SUCCESS || data_size == 0)
+		return;
+
+	data = malloc(data_size);
+	if (!data)
+		return;
+
+	if (vkGetPipelineCacheData(vulkan_globals.device, vulkan_globals.pipeline_cache, &data_size, data) == VK_SUCCESS)
+	{
+		f = fopen(va("%s/%s", host_parms->userdir, PIPELINE_CACHE_FILE), "wb");
+		if (f)
+		{
+			R_PipelineCacheHeader(&header, (uint32_t)data_size);
+			if (fwrite(&header, sizeof(header), 1, f) != 1 || fwrite(data, data_size, 1, f) != 1)
+				Con_Printf("Couldn't write %s\n", PIPELINE_CACHE_FILE);
+			fclose(f);
+		}
+	}
+
+	free(data);
+}
+
 /*
 ===============
 R_CreateShaderModule
@@ -1012,6 +1278,7 @@ void R_CreatePipelines()
 	VkShaderModule world_frag_module = R_CreateShaderModule(world_frag_spv, world_frag_spv_size);
 	VkShaderModule world_fullbright_frag_module = R_CreateShaderModule(world_fullbright_frag_spv, world_fullbright_frag_spv_size);
 	VkShaderModule alias_vert_module = R_CreateShaderModule(alias_vert_spv, alias_vert_spv_size);
+	VkShaderModule alias_instanced_vert_module = R_CreateShaderModule(alias_instanced_vert_spv, alias_instanced_vert_spv_size);
 	VkShaderModule alias_frag_module = R_CreateShaderModule(alias_frag_spv, alias_frag_spv_size);
 	VkShaderModule sky_layer_vert_module = R_CreateShaderModule(sky_layer_vert_spv, sky_layer_vert_spv_size);
 	VkShaderModule sky_layer_frag_module = R_CreateShaderModule(sky_layer_frag_spv, sky_layer_frag_spv_size);
@@ -1135,7 +1402,7 @@ void R_CreatePipelines()
 	//================
 	input_assembly_state_create_info.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
 
-	err = vkCreateGraphicsPipelines(vulkan_globals.device, VK_NULL_HANDLE, 1, &pipeline_create_info, NULL, &vulkan_globals.basic_alphatest_pipeline);
+	err = vkCreateGraphicsPipelines(vulkan_globals.device, vulkan_globals.pipeline_cache, 1, &pipeline_create_info, NULL, &vulkan_globals.basic_alphatest_pipeline);
 	if (err != VK_SUCCESS)
 		Sys_Error("vkCreateGraphicsPipelines failed");
 
@@ -1149,13 +1416,13 @@ void R_CreatePipelines()
 	blend_attachment_state.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
 	blend_attachment_state.alphaBlendOp = VK_BLEND_OP_ADD;
 
-	err = vkCreateGraphicsPipelines(vulkan_globals.device, VK_NULL_HANDLE, 1, &pipeline_create_info, NULL, &vulkan_globals.basic_notex_blend_pipeline);
+	err = vkCreateGraphicsPipelines(vulkan_globals.device, vulkan_globals.pipeline_cache, 1, &pipeline_create_info, NULL, &vulkan_globals.basic_notex_blend_pipeline);
 	if (err != VK_SUCCESS)
 		Sys_Error("vkCreateGraphicsPipelines failed");
 
 	shader_stages[1].module = basic_frag_module;
 
-	err = vkCreateGraphicsPipelines(vulkan_globals.device, VK_NULL_HANDLE, 1, &pipeline_create_info, NULL, &vulkan_globals.basic_blend_pipeline);
+	err = vkCreateGraphicsPipelines(vulkan_globals.device, vulkan_globals.pipeline_cache, 1, &pipeline_create_info, NULL, &vulkan_globals.basic_blend_pipeline);
 	if (err != VK_SUCCESS)
 		Sys_Error("vkCreateGraphicsPipelines failed");
 
@@ -1171,7 +1438,7 @@ void R_CreatePipelines()
 
 	pipeline_create_info.renderPass = vulkan_globals.warp_render_pass;
 
-	err = vkCreateGraphicsPipelines(vulkan_globals.device, VK_NULL_HANDLE, 1, &pipeline_create_info, NULL, &vulkan_globals.warp_pipeline);
+	err = vkCreateGraphicsPipelines(vulkan_globals.device, vulkan_globals.pipeline_cache, 1, &pipeline_create_info, NULL, &vulkan_globals.warp_pipeline);
 	if (err != VK_SUCCESS)
 		Sys_Error("vkCreateGraphicsPipelines failed");
 
@@ -1187,7 +1454,7 @@ void R_CreatePipelines()
 
 	blend_attachment_state.blendEnable = VK_TRUE;
 
-	err = vkCreateGraphicsPipelines(vulkan_globals.device, VK_NULL_HANDLE, 1, &pipeline_create_info, NULL, &vulkan_globals.particle_pipeline);
+	err = vkCreateGraphicsPipelines(vulkan_globals.device, vulkan_globals.pipeline_cache, 1, &pipeline_create_info, NULL, &vulkan_globals.particle_pipeline);
 	if (err != VK_SUCCESS)
 		Sys_Error("vkCreateGraphicsPipelines failed");
 
@@ -1199,7 +1466,7 @@ void R_CreatePipelines()
 	depth_stencil_state_create_info.depthWriteEnable = VK_FALSE;
 	depth_stencil_state_create_info.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
 
-	err = vkCreateGraphicsPipelines(vulkan_globals.device, VK_NULL_HANDLE, 1, &pipeline_create_info, NULL, &vulkan_globals.water_pipeline);
+	err = vkCreateGraphicsPipelines(vulkan_globals.device, vulkan_globals.pipeline_cache, 1, &pipeline_create_info, NULL, &vulkan_globals.water_pipeline);
 	if (err != VK_SUCCESS)
 		Sys_Error("vkCreateGraphicsPipelines failed");
 	
@@ -1211,7 +1478,7 @@ void R_CreatePipelines()
 
 	dynamic_states[dynamic_state_create_info.dynamicStateCount++] = VK_DYNAMIC_STATE_DEPTH_BIAS;
 
-	err = vkCreateGraphicsPipelines(vulkan_globals.device, VK_NULL_HANDLE, 1, &pipeline_create_info, NULL, &vulkan_globals.sprite_pipeline);
+	err = vkCreateGraphicsPipelines(vulkan_globals.device, vulkan_globals.pipeline_cache, 1, &pipeline_create_info, NULL, &vulkan_globals.sprite_pipeline);
 	if (err != VK_SUCCESS)
 		Sys_Error("vkCreateGraphicsPipelines failed");
 
@@ -1228,7 +1495,7 @@ void R_CreatePipelines()
 	depth_stencil_state_create_info.depthWriteEnable = VK_FALSE;
 	depth_stencil_state_create_info.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
 
-	err = vkCreateGraphicsPipelines(vulkan_globals.device, VK_NULL_HANDLE, 1, &pipeline_create_info, NULL, &vulkan_globals.sky_color_pipeline);
+	err = vkCreateGraphicsPipelines(vulkan_globals.device, vulkan_globals.pipeline_cache, 1, &pipeline_create_info, NULL, &vulkan_globals.sky_color_pipeline);
 	if (err != VK_SUCCESS)
 		Sys_Error("vkCreateGraphicsPipelines failed");
 
@@ -1266,7 +1533,7 @@ void R_CreatePipelines()
 
 	pipeline_create_info.layout = vulkan_globals.sky_layer_pipeline_layout;
 
-	err = vkCreateGraphicsPipelines(vulkan_globals.device, VK_NULL_HANDLE, 1, &pipeline_create_info, NULL, &vulkan_globals.sky_layer_pipeline);
+	err = vkCreateGraphicsPipelines(vulkan_globals.device, vulkan_globals.pipeline_cache, 1, &pipeline_create_info, NULL, &vulkan_globals.sky_layer_pipeline);
 	if (err != VK_SUCCESS)
 		Sys_Error("vkCreateGraphicsPipelines failed");
 
@@ -1310,16 +1577,31 @@ void R_CreatePipelines()
 	
 	pipeline_create_info.layout = vulkan_globals.world_pipeline_layout;
 
-	err = vkCreateGraphicsPipelines(vulkan_globals.device, VK_NULL_HANDLE, 1, &pipeline_create_info, NULL, &vulkan_globals.world_pipeline);
+	err = vkCreateGraphicsPipelines(vulkan_globals.device, vulkan_globals.pipeline_cache, 1, &pipeline_create_info, NULL, &vulkan_globals.world_pipeline);
 	if (err != VK_SUCCESS)
 		Sys_Error("vkCreateGraphicsPipelines failed");
 
 	shader_stages[1].module = world_fullbright_frag_module;
 
-	err = vkCreateGraphicsPipelines(vulkan_globals.device, VK_NULL_HANDLE, 1, &pipeline_create_info, NULL, &vulkan_globals.world_fullbright_pipeline);
+	err = vkCreateGraphicsPipelines(vulkan_globals.device, vulkan_globals.pipeline_cache, 1, &pipeline_create_info, NULL, &vulkan_globals.world_fullbright_pipeline);
 	if (err != VK_SUCCESS)
 		Sys_Error("vkCreateGraphicsPipelines failed");
 
+	if (vulkan_globals.bindless)
+	{
+		// Needs runtimeDescriptorArray, so the module is only created when it is enabled
+		VkShaderModule world_bindless_frag_module = R_CreateShaderModule(world_bindless_frag_spv, world_bindless_frag_spv_size);
+
+		shader_stages[1].module = world_bindless_frag_module;
+		pipeline_create_info.layout = vulkan_globals.world_bindless_pipeline_layout;
+
+		err = vkCreateGraphicsPipelines(vulkan_globals.device, vulkan_globals.pipeline_cache, 1, &pipeline_create_info, NULL, &vulkan_globals.world_bindless_pipeline);
+		if (err != VK_SUCCESS)
+			Sys_Error("vkCreateGraphicsPipelines failed");
+
+		vkDestroyShaderModule(vulkan_globals.device, world_bindless_frag_module, NULL);
+	}
+
 	//================
 	// Alias pipeline
 	//================
@@ -1366,13 +1648,91 @@ void R_CreatePipelines()
 
 	pipeline_create_info.layout = vulkan_globals.alias_pipeline_layout;
 
-	err = vkCreateGraphicsPipelines(vulkan_globals.device, VK_NULL_HANDLE, 1, &pipeline_create_info, NULL, &vulkan_globals.alias_pipeline);
+	err = vkCreateGraphicsPipelines(vulkan_globals.device, vulkan_globals.pipeline_cache, 1, &pipeline_create_info, NULL, &vulkan_globals.alias_pipeline);
+	if (err != VK_SUCCESS)
+		Sys_Error("vkCreateGraphicsPipelines failed");
+
+	//================
+	// Instanced alias pipeline
+	//================
+	// same mesh streams plus one per-instance stream: model matrix, shade vector & blend, light color
+	VkVertexInputAttributeDescription alias_instanced_attribute_descriptions[11];
+	memcpy(alias_instanced_attribute_descriptions, alias_vertex_input_attribute_descriptions, sizeof(alias_vertex_input_attribute_descriptions));
+	for (int i = 5; i < 11; ++i)
+	{
+		alias_instanced_attribute_descriptions[i].binding = 3;
+		alias_instanced_attribute_descriptions[i].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+		alias_instanced_attribute_descriptions[i].location = i;
+		alias_instanced_attribute_descriptions[i].offset = (i - 5) * 16;
+	}
+
+	VkVertexInputBindingDescription alias_instanced_binding_descriptions[4];
+	memcpy(alias_instanced_binding_descriptions, alias_vertex_binding_descriptions, sizeof(alias_vertex_binding_descriptions));
+	alias_instanced_binding_descriptions[3].binding = 3;
+	alias_instanced_binding_descriptions[3].inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+	alias_instanced_binding_descriptions[3].stride = 6 * 16;
+
+	vertex_input_state_create_info.vertexAttributeDescriptionCount = 11;
+	vertex_input_state_create_info.pVertexAttributeDescriptions = alias_instanced_attribute_descriptions;
+	vertex_input_state_create_info.vertexBindingDescriptionCount = 4;
+	vertex_input_state_create_info.pVertexBindingDescriptions = alias_instanced_binding_descriptions;
+
+	shader_stages[0].module = alias_instanced_vert_module;
+
+	err = vkCreateGraphicsPipelines(vulkan_globals.device, vulkan_globals.pipeline_cache, 1, &pipeline_create_info, NULL, &vulkan_globals.alias_instanced_pipeline);
 	if (err != VK_SUCCESS)
 		Sys_Error("vkCreateGraphicsPipelines failed");
 
+	//================
+	// World culling pipeline
+	//================
+	if (vulkan_globals.gpu_culling)
+	{
+		VkShaderModule world_cull_comp_module = R_CreateShaderModule(world_cull_comp_spv, world_cull_comp_spv_size);
+
+		VkComputePipelineCreateInfo compute_pipeline_create_info;
+		memset(&compute_pipeline_create_info, 0, sizeof(compute_pipeline_create_info));
+		compute_pipeline_create_info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+		compute_pipeline_create_info.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		compute_pipeline_create_info.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+		compute_pipeline_create_info.stage.module = world_cull_comp_module;
+		compute_pipeline_create_info.stage.pName = "main";
+		compute_pipeline_create_info.layout = vulkan_globals.world_cull_pipeline_layout;
+
+		err = vkCreateComputePipelines(vulkan_globals.device, vulkan_globals.pipeline_cache, 1, &compute_pipeline_create_info, NULL, &vulkan_globals.world_cull_pipeline);
+		if (err != VK_SUCCESS)
+			Sys_Error("vkCreateComputePipelines failed");
+
+		vkDestroyShaderModule(vulkan_globals.device, world_cull_comp_module, NULL);
+	}
+
+	//================
+	// Particle simulation pipeline
+	//================
+	if (vulkan_globals.gpu_particles)
+	{
+		VkShaderModule particle_comp_module = R_CreateShaderModule(particle_comp_spv, particle_comp_spv_size);
+
+		VkComputePipelineCreateInfo compute_pipeline_create_info;
+		memset(&compute_pipeline_create_info, 0, sizeof(compute_pipeline_create_info));
+		compute_pipeline_create_info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+		compute_pipeline_create_info.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		compute_pipeline_create_info.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+		compute_pipeline_create_info.stage.module = particle_comp_module;
+		compute_pipeline_create_info.stage.pName = "main";
+		compute_pipeline_create_info.layout = vulkan_globals.particle_compute_pipeline_layout;
+
+		err = vkCreateComputePipelines(vulkan_globals.device, vulkan_globals.pipeline_cache, 1, &compute_pipeline_create_info, NULL, &vulkan_globals.particle_compute_pipeline);
+		if (err != VK_SUCCESS)
+			Sys_Error("vkCreateComputePipelines failed");
+
+		vkDestroyShaderModule(vulkan_globals.device, particle_comp_module, NULL);
+	}
+
 	vkDestroyShaderModule(vulkan_globals.device, sky_layer_frag_module, NULL);
 	vkDestroyShaderModule(vulkan_globals.device, sky_layer_vert_module, NULL);
 	vkDestroyShaderModule(vulkan_globals.device, alias_frag_module, NULL);
+	vkDestroyShaderModule(vulkan_globals.device, alias_instanced_vert_module, NULL);
 	vkDestroyShaderModule(vulkan_globals.device, alias_vert_module, NULL);
 	vkDestroyShaderModule(vulkan_globals.device, world_fullbright_frag_module, NULL);
 	vkDestroyShaderModule(vulkan_globals.device, world_frag_module, NULL);
@@ -1441,6 +1801,11 @@ void R_Init (void)
 	Cvar_RegisterVariable (&r_noshadow_list);
 	Cvar_SetCallback (&r_noshadow_list, R_Model_ExtraFlags_List_f);
 	//johnfitz
+	Cvar_RegisterVariable (&r_instancing);
+	Cvar_RegisterVariable (&r_worldcache);
+	Cvar_RegisterVariable (&r_bindless);
+	Cvar_RegisterVariable (&r_parallel);
+	Cvar_RegisterVariable (&r_gpuculling);
 
 	Cvar_RegisterVariable (&gl_zfix); // QuakeSpasm z-fighting fix
 	Cvar_RegisterVariable (&r_lavaalpha);
@@ -1608,6 +1973,8 @@ void R_NewMap (void)
 
 	GL_BuildLightmaps ();
 	GL_BuildBModelVertexBuffer ();
+	R_FreeWorldCache ();
+	R_FreeWorldCulling ();
 	//ericw -- no longer load alias models into a VBO here, it's done in Mod_LoadAliasModel
 
 	r_framecount = 0; //johnfitz -- paranoid?
@@ -87,6 +87,7 @@ cvar_t		scr_crosshairscale = {"scr_crosshairscale", "1", CVAR_ARCHIVE};
 cvar_t		scr_showfps = {"scr_showfps", "0", CVAR_NONE};
 cvar_t		scr_clock = {"scr_clock", "0", CVAR_NONE};
 //johnfitz
+cvar_t		scr_counters = {"scr_counters", "0", CVAR_NONE};
 
 cvar_t		scr_viewsize = {"viewsize","100", CVAR_ARCHIVE};
 cvar_t		scr_fov = {"fov","90",CVAR_NONE};	// 10 - 170
@@ -408,6 +409,7 @@ void SCR_Init (void)
 	Cvar_RegisterVariable (&scr_showfps);
 	Cvar_RegisterVariable (&scr_clock);
 	//johnfitz
+	Cvar_RegisterVariable (&scr_counters);
 	Cvar_SetCallback (&scr_fov, SCR_Callback_refdef);
 	Cvar_SetCallback (&scr_fov_adapt, SCR_Callback_refdef);
 	Cvar_SetCallback (&scr_viewsize, SCR_Callback_refdef);
@@ -551,6 +553,48 @@ void SCR_DrawDevStats (void)
 	Draw_String (x, (y++)*8-x, str);
 }
 
+/*
+==============
+SCR_DrawCounters
+
+One row per frame counter: the last frame's value and a graph of the
+last COUNTER_HISTORY frames, scaled to the peak over that span.  Sits on
+top of devstats when both are shown.
+==============
+*/
+void SCR_DrawCounters (void)
+{
+	char	str[40];
+	int		i, j, x, y, value, peak;
+	int		start;
+
+	if (!scr_counters.value)
+		return;
+
+	GL_SetCanvas (CANVAS_BOTTOMLEFT);
+
+	x = 0;
+	y = (devstats.value ? 25-9 : 25)*8 - NUM_COUNTERS*12;
+	start = prof_historyframe & (COUNTER_HISTORY - 1);
+
+	Draw_Fill (x, y, 17*8 + COUNTER_HISTORY, NUM_COUNTERS*12, 0, 0.5); //dark rectangle
+
+	for (i = 0; i < NUM_COUNTERS; i++, y += 12)
+	{
+		for (j = 0, peak = 0; j < COUNTER_HISTORY; j++)
+			peak = q_max(peak, prof_history[i][j]);
+		value = prof_history[i][(start - 1) & (COUNTER_HISTORY - 1)];
+
+		if (value >= 100000)
+			sprintf (str, "%-9s|%5ik", prof_countername[i], value / 1024);
+		else
+			sprintf (str, "%-9s|%6i", prof_countername[i], value);
+		Draw_String (x, y + 2, str);
+
+		Draw_Graph (x + 17*8, y + 1, 10, prof_history[i], COUNTER_HISTORY, start, peak, 251);
+	}
+}
+
 /*
 ==============
 SCR_DrawRam
@@ -1012,6 +1056,15 @@ void SCR_UpdateScreen (void)
 	if (!scr_initialized || !con_initialized)
 		return;				// not initialized yet
 
+	// -headless: do the client side work of a frame, but record nothing
+	if (isHeadless)
+	{
+		if (vid.recalc_refdef)
+			SCR_CalcRefdef ();
+		SCR_SetUpToDrawConsole ();
+		V_RenderView ();
+		return;
+	}
 
 	GL_BeginRendering (&glx, &gly, &glwidth, &glheight);
 
@@ -1066,6 +1119,7 @@ void SCR_UpdateScreen (void)
 		SCR_CheckDrawCenterString ();
 		Sbar_Draw ();
 		SCR_DrawDevStats (); //johnfitz
+		SCR_DrawCounters ();
 		SCR_DrawFPS (); //johnfitz
 		SCR_DrawClock (); //johnfitz
 		SCR_DrawConsole ();
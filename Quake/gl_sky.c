@@ -819,6 +819,7 @@ void Sky_DrawFaceQuad (glpoly_t *p, float alpha)
 	VkDescriptorSet descriptor_sets[2] = { solidskytexture->descriptor_set, alphaskytexture->descriptor_set };
 	vkCmdBindDescriptorSets(vulkan_globals.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkan_globals.basic_pipeline_layout, 0, 1, &vulkan_globals.sampler_descriptor_set, 0, NULL);
 	vkCmdBindDescriptorSets(vulkan_globals.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkan_globals.sky_layer_pipeline_layout, 1, 2, descriptor_sets, 0, NULL);
+	COUNT (CNT_DESCRIPTORSETS, 2);
 
 	VkBuffer vertex_buffer;
 	VkDeviceSize vertex_buffer_offset;
@@ -841,6 +842,8 @@ void Sky_DrawFaceQuad (glpoly_t *p, float alpha)
 
 	vkCmdBindVertexBuffers(vulkan_globals.command_buffer, 0, 1, &vertex_buffer, &vertex_buffer_offset);
 	vkCmdDraw(vulkan_globals.command_buffer, 4, 1, 0, 0);
+	COUNT (CNT_DRAWCALLS, 1);
+	COUNT (CNT_TRIANGLES, 2);
 
 	rs_skypolys++;
 	rs_skypasses++;
@@ -937,6 +940,7 @@ void Sky_DrawSkyLayers (void)
 	int i;
 
 	vkCmdBindPipeline(vulkan_globals.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkan_globals.sky_layer_pipeline);
+	COUNT (CNT_PIPELINEBINDS, 1);
 
 	for (i=0 ; i<6 ; i++)
 		if (skymins[0][i] < skymaxs[0][i] && skymins[1][i] < skymaxs[1][i])
@@ -968,6 +972,7 @@ void Sky_DrawSky (void)
 	}
 
 	vkCmdBindPipeline(vulkan_globals.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkan_globals.sky_color_pipeline);
+	COUNT (CNT_PIPELINEBINDS, 1);
 
 	//
 	// process world and bmodels: draw flat-shaded sky surfs, and update skybounds
@@ -460,6 +460,8 @@ void TexMgr_Init (void)
 	for (i = 0; i < MAX_GLTEXTURES - 1; i++)
 		free_gltextures[i].next = &free_gltextures[i+1];
 	free_gltextures[i].next = NULL;
+	for (i = 0; i < MAX_GLTEXTURES; i++)
+		free_gltextures[i].bindless_index = i;
 	numgltextures = 0;
 
 	// palette
@@ -531,7 +533,7 @@ int TexMgr_PadConditional (int s)
 TexMgr_MipMapW
 ================
 */
-static unsigned *TexMgr_MipMapW (unsigned *data, int width, int height)
+unsigned *TexMgr_MipMapW (unsigned *data, int width, int height)
 {
 	int	i, size;
 	byte	*out, *in;
@@ -555,7 +557,7 @@ static unsigned *TexMgr_MipMapW (unsigned *data, int width, int height)
 TexMgr_MipMapH
 ================
 */
-static unsigned *TexMgr_MipMapH (unsigned *data, int width, int height)
+unsigned *TexMgr_MipMapH (unsigned *data, int width, int height)
 {
 	int	i, j;
 	byte	*out, *in;
@@ -583,7 +585,7 @@ static unsigned *TexMgr_MipMapH (unsigned *data, int width, int height)
 TexMgr_ResampleTexture -- bilinear resample
 ================
 */
-static unsigned *TexMgr_ResampleTexture (unsigned *in, int inwidth, int inheight, qboolean alpha)
+unsigned *TexMgr_ResampleTexture (unsigned *in, int inwidth, int inheight, qboolean alpha)
 {
 	byte *nwpx, *nepx, *swpx, *sepx, *dest;
 	unsigned xfrac, yfrac, x, y, modx, mody, imodx, imody, injump, outjump;
@@ -993,6 +995,16 @@ static void TexMgr_LoadImage32 (gltexture_t *glt, unsigned *data)
 
 	vkUpdateDescriptorSets(vulkan_globals.device, 1, &texture_write, 0, NULL);
 
+	// Same view in the bindless array. The slot is owned by this gltexture_t, so
+	// it is only read by draws of this texture. GL_DeleteTexture points it at
+	// nulltexture again.
+	if (vulkan_globals.bindless)
+	{
+		texture_write.dstSet = vulkan_globals.bindless_descriptor_set;
+		texture_write.dstArrayElement = glt->bindless_index;
+		vkUpdateDescriptorSets(vulkan_globals.device, 1, &texture_write, 0, NULL);
+	}
+
 	TexMgr_SetFilterModes (glt);
 
 	// Don't upload data for warp image, will be updated by rendering
@@ -1259,9 +1271,14 @@ gltexture_t *TexMgr_LoadImage (qmodel_t *owner, const char *name, int width, int
 	glt->source_height = height;
 	glt->source_crc = crc;
 
+	// headless clients keep the bookkeeping but have nowhere to upload to
+	if (isHeadless)
+		return glt;
+
 	//upload it
 	mark = Hunk_LowMark();
 
+	PROF_BEGIN ("TexMgr upload");
 	switch (glt->source_format)
 	{
 	case SRC_INDEXED:
@@ -1274,6 +1291,7 @@ gltexture_t *TexMgr_LoadImage (qmodel_t *owner, const char *name, int width, int
 		TexMgr_LoadImage32 (glt, (unsigned *)data);
 		break;
 	}
+	PROF_END ();
 
 	Hunk_FreeToLowMark(mark);
 
@@ -1298,6 +1316,9 @@ void TexMgr_ReloadImage (gltexture_t *glt, int shirt, int pants)
 	byte	translation[256];
 	byte	*src, *dst, *data = NULL, *translated;
 	int	mark, size, i;
+
+	if (isHeadless)
+		return;
 //
 // get source data
 //
@@ -1395,6 +1416,7 @@ invalid:
 //
 // upload it
 //
+	PROF_BEGIN ("TexMgr upload");
 	switch (glt->source_format)
 	{
 	case SRC_INDEXED:
@@ -1407,6 +1429,7 @@ invalid:
 		TexMgr_LoadImage32 (glt, (unsigned *)data);
 		break;
 	}
+	PROF_END ();
 
 	Hunk_FreeToLowMark(mark);
 }
@@ -1532,8 +1555,32 @@ GL_DeleteTexture
 */
 static void GL_DeleteTexture (gltexture_t *texture)
 {
+	if (texture->image == VK_NULL_HANDLE)
+		return;
+
 	GL_WaitForDeviceIdle();
 
+	// Don't leave the bindless slot with a destroyed view
+	if (vulkan_globals.bindless && nulltexture && nulltexture != texture && nulltexture->image_view != VK_NULL_HANDLE)
+	{
+		VkDescriptorImageInfo image_info;
+		memset(&image_info, 0, sizeof(image_info));
+		image_info.imageView = nulltexture->image_view;
+		image_info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+		VkWriteDescriptorSet texture_write;
+		memset(&texture_write, 0, sizeof(texture_write));
+		texture_write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		texture_write.dstSet = vulkan_globals.bindless_descriptor_set;
+		texture_write.dstBinding = 0;
+		texture_write.dstArrayElement = texture->bindless_index;
+		texture_write.descriptorCount = 1;
+		texture_write.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+		texture_write.pImageInfo = &image_info;
+
+		vkUpdateDescriptorSets(vulkan_globals.device, 1, &texture_write, 0, NULL);
+	}
+
 	if (texture->frame_buffer != VK_NULL_HANDLE)
 		vkDestroyFramebuffer(vulkan_globals.device, texture->frame_buffer, NULL);
 	vkDestroyImageView(vulkan_globals.device, texture->image_view, NULL);
@@ -68,6 +68,7 @@ typedef struct gltexture_s {
 	VkDescriptorSet		descriptor_set;
 	VkDescriptorSet	*	sampler_set;
 	VkFramebuffer		frame_buffer;
+	int			bindless_index; //slot in vulkan_globals.bindless_descriptor_set
 	int			visframe; //matches r_framecount if texture was bound this frame
 } gltexture_t;
 
@@ -104,6 +105,11 @@ int TexMgr_Pad(int s);
 int TexMgr_SafeTextureSize (int s);
 int TexMgr_PadConditional (int s);
 
+// IMAGE PROCESSING (in place, except the resampler which returns hunk memory)
+unsigned *TexMgr_MipMapW (unsigned *data, int width, int height);
+unsigned *TexMgr_MipMapH (unsigned *data, int width, int height);
+unsigned *TexMgr_ResampleTexture (unsigned *in, int inwidth, int inheight, qboolean alpha);
+
 
 #endif	/* _GL_TEXMAN_H */
 
@@ -98,6 +98,40 @@ static VkCommandPool				command_pool;
 static VkCommandBuffer				command_buffers[NUM_COMMAND_BUFFERS];
 static VkFence						command_buffer_fences[NUM_COMMAND_BUFFERS];
 static qboolean						command_buffer_submitted[NUM_COMMAND_BUFFERS];
+
+// Parallel recording, see GL_BeginMainRenderPass
+#define MAX_PARALLEL_JOBS					8
+#define MAX_SECONDARY_COMMAND_BUFFERS		(MAX_PARALLEL_JOBS + 1)
+enum { RECORD_MAIN, RECORD_WORKER, NUM_RECORD_THREADS };
+
+typedef struct
+{
+	void			(*record) (VkCommandBuffer command_buffer, void *data);
+	void			*data;
+	int				segment;		// slot in secondary_segments
+	VkViewport		viewport;		// state at the point the pass was handed over
+	float			view_projection_matrix[16];
+} recordjob_t;
+
+static VkCommandPool				secondary_command_pools[NUM_COMMAND_BUFFERS][NUM_RECORD_THREADS];
+static VkCommandBuffer				secondary_command_buffers[NUM_COMMAND_BUFFERS][NUM_RECORD_THREADS][MAX_SECONDARY_COMMAND_BUFFERS];
+static int							num_secondary_command_buffers[NUM_RECORD_THREADS];
+static VkCommandBuffer				secondary_segments[NUM_RECORD_THREADS * MAX_SECONDARY_COMMAND_BUFFERS];
+static int							num_secondary_segments;
+static VkCommandBuffer				primary_command_buffer;
+static qboolean						parallel_recording;
+
+static struct
+{
+	SDL_Thread		*thread;
+	SDL_mutex		*lock;
+	SDL_cond		*queued;		// job for the worker
+	SDL_cond		*finished;		// job done, for the main thread
+	recordjob_t		jobs[MAX_PARALLEL_JOBS];
+	int				numqueued, numstarted, numfinished;
+} recorder;
+
+extern cvar_t r_parallel;
 static VkFramebuffer				framebuffers[NUM_SWAP_CHAIN_IMAGES];
 static VkImageView					swapchain_images_views[NUM_SWAP_CHAIN_IMAGES];
 static VkSemaphore					image_aquired_semaphores[NUM_SWAP_CHAIN_IMAGES];
@@ -120,6 +154,7 @@ static PFN_vkQueuePresentKHR fpQueuePresentKHR;
 static uint32_t current_swapchain_buffer;
 
 static qboolean device_idle;
+static qboolean found_physical_device_properties2;
 
 #define GET_INSTANCE_PROC_ADDR(inst, entrypoint) { \
 	fp##entrypoint = (PFN_vk##entrypoint)vkGetInstanceProcAddr(inst, "vk" #entrypoint); \
@@ -235,6 +270,8 @@ VID_HasMouseOrInputFocus
 */
 qboolean VID_HasMouseOrInputFocus (void)
 {
+	if (isHeadless)
+		return true;
 	return (SDL_GetWindowFlags(draw_context) & (SDL_WINDOW_MOUSE_FOCUS | SDL_WINDOW_INPUT_FOCUS)) != 0;
 }
 
@@ -245,6 +282,8 @@ VID_IsMinimized
 */
 qboolean VID_IsMinimized (void)
 {
+	if (isHeadless)
+		return false;
 	return !(SDL_GetWindowFlags(draw_context) & SDL_WINDOW_SHOWN);
 }
 
@@ -409,7 +448,8 @@ VID_FilterChanged_f
 */
 static void VID_FilterChanged_f(cvar_t *var)
 {
-	R_InitSamplers();
+	if (!isHeadless)
+		R_InitSamplers();
 }
 
 /*
@@ -422,7 +462,7 @@ static void VID_Restart (void)
 	int width, height, bpp;
 	qboolean fullscreen;
 
-	if (vid_locked || !vid_changed)
+	if (vid_locked || !vid_changed || isHeadless)
 		return;
 
 	width = (int)vid_width.value;
@@ -495,7 +535,7 @@ static void VID_Test (void)
 {
 	int old_width, old_height, old_bpp, old_fullscreen;
 
-	if (vid_locked || !vid_changed)
+	if (vid_locked || !vid_changed || isHeadless)
 		return;
 //
 // now try the switch
@@ -571,6 +611,11 @@ static void GL_InitInstance( void )
 			{
 				found_surface_extensions++;
 			}
+
+			if (strcmp(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME, instance_extensions[i].extensionName) == 0)
+			{
+				found_physical_device_properties2 = true;
+			}
 		}
 
 		free(instance_extensions);
@@ -588,14 +633,14 @@ static void GL_InitInstance( void )
 	application_info.engineVersion = 1;
 	application_info.apiVersion = VK_API_VERSION_1_0;
 
-	char * instance_extensions[] = { VK_KHR_SURFACE_EXTENSION_NAME, PLATFORM_SURF_EXT };
+	char * instance_extensions[] = { VK_KHR_SURFACE_EXTENSION_NAME, PLATFORM_SURF_EXT, VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME };
 	char * layer_names[] = { "VK_LAYER_LUNARG_standard_validation" };
 
 	VkInstanceCreateInfo instance_create_info;
 	memset(&instance_create_info, 0, sizeof(instance_create_info));
 	instance_create_info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
 	instance_create_info.pApplicationInfo = &application_info;
-	instance_create_info.enabledExtensionCount = 2;
+	instance_create_info.enabledExtensionCount = found_physical_device_properties2 ? 3 : 2;
 	instance_create_info.ppEnabledExtensionNames = instance_extensions;
 #ifdef _DEBUG
 	instance_create_info.enabledLayerCount = 1;
@@ -636,6 +681,68 @@ static void GL_InitInstance( void )
 	GET_INSTANCE_PROC_ADDR(vulkan_instance, GetSwapchainImagesKHR);
 }
 
+/*
+===============
+GL_CheckBindlessSupport
+
+Bindless textures keep every gltexture_t in one descriptor array that is
+written while command buffers using it are still in flight, so they need
+update-after-bind and partially bound descriptors on top of runtime sized
+arrays. The shaders pick the array element from a push constant, which is
+dynamic indexing of a sampled image array and a core feature of its own.
+On success the features to enable are left in indexing_features.
+===============
+*/
+static qboolean GL_CheckBindlessSupport(VkPhysicalDeviceDescriptorIndexingFeaturesEXT *indexing_features)
+{
+	PFN_vkGetPhysicalDeviceFeatures2KHR fpGetPhysicalDeviceFeatures2KHR;
+	PFN_vkGetPhysicalDeviceProperties2KHR fpGetPhysicalDeviceProperties2KHR;
+
+	fpGetPhysicalDeviceFeatures2KHR = (PFN_vkGetPhysicalDeviceFeatures2KHR)vkGetInstanceProcAddr(vulkan_instance, "vkGetPhysicalDeviceFeatures2KHR");
+	fpGetPhysicalDeviceProperties2KHR = (PFN_vkGetPhysicalDeviceProperties2KHR)vkGetInstanceProcAddr(vulkan_instance, "vkGetPhysicalDeviceProperties2KHR");
+	if (!fpGetPhysicalDeviceFeatures2KHR || !fpGetPhysicalDeviceProperties2KHR)
+		return false;
+
+	VkPhysicalDeviceDescriptorIndexingFeaturesEXT supported_features;
+	memset(&supported_features, 0, sizeof(supported_features));
+	supported_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+
+	VkPhysicalDeviceFeatures2KHR physical_device_features;
+	memset(&physical_device_features, 0, sizeof(physical_device_features));
+	physical_device_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR;
+	physical_device_features.pNext = &supported_features;
+	fpGetPhysicalDeviceFeatures2KHR(vulkan_physical_device, &physical_device_features);
+
+	VkPhysicalDeviceDescriptorIndexingPropertiesEXT indexing_properties;
+	memset(&indexing_properties, 0, sizeof(indexing_properties));
+	indexing_properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES_EXT;
+
+	VkPhysicalDeviceProperties2KHR physical_device_properties;
+	memset(&physical_device_properties, 0, sizeof(physical_device_properties));
+	physical_device_properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2_KHR;
+	physical_device_properties.pNext = &indexing_properties;
+	fpGetPhysicalDeviceProperties2KHR(vulkan_physical_device, &physical_device_properties);
+
+	if (!physical_device_features.features.shaderSampledImageArrayDynamicIndexing)
+		return false;
+
+	if (!supported_features.runtimeDescriptorArray ||
+		!supported_features.descriptorBindingPartiallyBound ||
+		!supported_features.descriptorBindingSampledImageUpdateAfterBind ||
+		!supported_features.descriptorBindingUpdateUnusedWhilePending)
+		return false;
+
+	if (indexing_properties.maxDescriptorSetUpdateAfterBindSampledImages < MAX_GLTEXTURES ||
+		indexing_properties.maxPerStageDescriptorUpdateAfterBindSampledImages < MAX_GLTEXTURES)
+		return false;
+
+	indexing_features->runtimeDescriptorArray = VK_TRUE;
+	indexing_features->descriptorBindingPartiallyBound = VK_TRUE;
+	indexing_features->descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+	indexing_features->descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+	return true;
+}
+
 /*
 ===============
 GL_InitDevice
@@ -656,6 +763,8 @@ static void GL_InitDevice( void )
 	free(physical_devices);
 
 	qboolean found_swapchain_extension = false;
+	qboolean found_descriptor_indexing_extension = false;
+	qboolean found_maintenance3_extension = false;
 
 	vkGetPhysicalDeviceMemoryProperties(vulkan_physical_device, &vulkan_globals.memory_properties);
 
@@ -670,10 +779,11 @@ static void GL_InitDevice( void )
 		for (uint32_t i = 0; i < device_extension_count; ++i)
 		{
 			if (strcmp(VK_KHR_SWAPCHAIN_EXTENSION_NAME, device_extensions[i].extensionName) == 0)
-			{
 				found_swapchain_extension = true;
-				break;
-			}
+			else if (strcmp(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME, device_extensions[i].extensionName) == 0)
+				found_descriptor_indexing_extension = true;
+			else if (strcmp(VK_KHR_MAINTENANCE3_EXTENSION_NAME, device_extensions[i].extensionName) == 0)
+				found_maintenance3_extension = true;
 		}
 
 		free(device_extensions);
@@ -717,6 +827,9 @@ static void GL_InitDevice( void )
 		{
 			found_graphics_queue = true;
 			vulkan_globals.gfx_queue_family_index = i;
+			// compute is only used by the optional GPU world culling and particles
+			vulkan_globals.gpu_culling = (queue_family_properties[i].queueFlags & VK_QUEUE_COMPUTE_BIT) && !COM_CheckParm("-nogpuculling");
+			vulkan_globals.gpu_particles = (queue_family_properties[i].queueFlags & VK_QUEUE_COMPUTE_BIT) && !COM_CheckParm("-nogpuparticles");
 			break;
 		}
 	}
@@ -734,16 +847,32 @@ static void GL_InitDevice( void )
 	queue_create_info.queueCount = 1;
 	queue_create_info.pQueuePriorities = queue_priorities;
 
-	char * device_extensions[] = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
+	VkPhysicalDeviceDescriptorIndexingFeaturesEXT descriptor_indexing_features;
+	memset(&descriptor_indexing_features, 0, sizeof(descriptor_indexing_features));
+	descriptor_indexing_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+
+	vulkan_globals.bindless = false;
+	if (found_physical_device_properties2 && found_descriptor_indexing_extension && found_maintenance3_extension && !COM_CheckParm("-nobindless"))
+		vulkan_globals.bindless = GL_CheckBindlessSupport(&descriptor_indexing_features);
+	if (vulkan_globals.bindless)
+		Con_Printf("Using bindless textures\n");
+
+	VkPhysicalDeviceFeatures device_features;
+	memset(&device_features, 0, sizeof(device_features));
+	device_features.shaderSampledImageArrayDynamicIndexing = vulkan_globals.bindless;
+
+	char * device_extensions[] = { VK_KHR_SWAPCHAIN_EXTENSION_NAME, VK_KHR_MAINTENANCE3_EXTENSION_NAME, VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME };
 	char * layer_names[] = { "VK_LAYER_LUNARG_standard_validation" };
 
 	VkDeviceCreateInfo device_create_info;
 	memset(&device_create_info, 0, sizeof(device_create_info));
 	device_create_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+	device_create_info.pNext = vulkan_globals.bindless ? &descriptor_indexing_features : NULL;
 	device_create_info.queueCreateInfoCount = 1;
 	device_create_info.pQueueCreateInfos = &queue_create_info;
-	device_create_info.enabledExtensionCount = 1;
+	device_create_info.enabledExtensionCount = vulkan_globals.bindless ? 3 : 1;
 	device_create_info.ppEnabledExtensionNames = device_extensions;
+	device_create_info.pEnabledFeatures = &device_features;
 #ifdef _DEBUG
 	device_create_info.enabledLayerCount = 1;
 	device_create_info.ppEnabledLayerNames = layer_names;
@@ -803,6 +932,26 @@ static void GL_InitCommandBuffers( void )
 		if (err != VK_SUCCESS)
 			Sys_Error("vkCreateFence failed");
 	}
+
+	// One pool per frame and recording thread, reset as a whole once the frame's fence has passed
+	command_pool_create_info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+	command_buffer_allocate_info.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+	command_buffer_allocate_info.commandBufferCount = MAX_SECONDARY_COMMAND_BUFFERS;
+
+	for (int i = 0; i < NUM_COMMAND_BUFFERS; ++i)
+	{
+		for (int j = 0; j < NUM_RECORD_THREADS; ++j)
+		{
+			err = vkCreateCommandPool(vulkan_globals.device, &command_pool_create_info, NULL, &secondary_command_pools[i][j]);
+			if (err != VK_SUCCESS)
+				Sys_Error("vkCreateCommandPool failed");
+
+			command_buffer_allocate_info.commandPool = secondary_command_pools[i][j];
+			err = vkAllocateCommandBuffers(vulkan_globals.device, &command_buffer_allocate_info, secondary_command_buffers[i][j]);
+			if (err != VK_SUCCESS)
+				Sys_Error("vkAllocateCommandBuffers failed");
+		}
+	}
 }
 
 /*
@@ -1085,7 +1234,6 @@ GL_BeginRendering
 */
 void GL_BeginRendering (int *x, int *y, int *width, int *height)
 {
-	R_SwapDynamicBuffers();
 	R_SubmitStagingBuffers();
 
 	device_idle = false;
@@ -1102,10 +1250,16 @@ void GL_BeginRendering (int *x, int *y, int *width, int *height)
 			Sys_Error("vkWaitForFences failed");
 	}
 
+	// the dynamic buffers of the frame that last used this command buffer are free now
+	R_SwapDynamicBuffers();
+
 	err = vkResetFences(vulkan_globals.device, 1, &command_buffer_fences[current_command_buffer]);
 	if (err != VK_SUCCESS)
 		Sys_Error("vkResetFences failed");
 
+	for (int i = 0; i < NUM_RECORD_THREADS; ++i)
+		vkResetCommandPool(vulkan_globals.device, secondary_command_pools[current_command_buffer][i], 0);
+
 	VkCommandBufferBeginInfo command_buffer_begin_info;
 	memset(&command_buffer_begin_info, 0, sizeof(command_buffer_begin_info));
 	command_buffer_begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
@@ -1141,6 +1295,7 @@ void GL_BeginRendering (int *x, int *y, int *width, int *height)
 	vulkan_globals.main_render_pass_begin_info.pClearValues = vulkan_globals.main_clear_values;
 
 	vkCmdBindDescriptorSets(vulkan_globals.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkan_globals.basic_pipeline_layout, 0, 1, &vulkan_globals.sampler_descriptor_set, 0, NULL);
+	COUNT (CNT_DESCRIPTORSETS, 1);
 
 	vkCmdSetScissor(vulkan_globals.command_buffer, 0, 1, &render_area);
 
@@ -1153,6 +1308,226 @@ void GL_BeginRendering (int *x, int *y, int *width, int *height)
 	viewport.maxDepth = 1.0f;
 
 	vkCmdSetViewport(vulkan_globals.command_buffer, 0, 1, &viewport);
+	vulkan_globals.viewport = viewport;
+}
+
+/*
+================================================================================
+
+	PARALLEL RECORDING
+
+With r_parallel set, the main render pass is recorded into secondary command
+buffers that the primary executes in order at GL_EndRendering. The main thread
+records one segment after the other, a pass handed to GL_RecordParallel gets
+a segment of its own that the worker thread records while the main thread
+carries on with the next one. Such passes must only read renderer state.
+
+================================================================================
+*/
+
+/*
+=================
+GL_BeginSecondaryCommandBuffer
+
+Secondary command buffers inherit no state, so everything the rest of the
+renderer expects to be set inside the main render pass is set again.
+=================
+*/
+static VkCommandBuffer GL_BeginSecondaryCommandBuffer (int thread, const VkViewport *viewport, const float *view_projection_matrix)
+{
+	VkResult err;
+
+	if (num_secondary_command_buffers[thread] == MAX_SECONDARY_COMMAND_BUFFERS)
+		Sys_Error("GL_BeginSecondaryCommandBuffer: too many command buffers");
+	VkCommandBuffer command_buffer = secondary_command_buffers[current_command_buffer][thread][num_secondary_command_buffers[thread]++];
+
+	VkCommandBufferInheritanceInfo inheritance_info;
+	memset(&inheritance_info, 0, sizeof(inheritance_info));
+	inheritance_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+	inheritance_info.renderPass = vulkan_globals.main_render_pass;
+	inheritance_info.subpass = 0;
+	inheritance_info.framebuffer = vulkan_globals.main_render_pass_begin_info.framebuffer;
+
+	VkCommandBufferBeginInfo command_buffer_begin_info;
+	memset(&command_buffer_begin_info, 0, sizeof(command_buffer_begin_info));
+	command_buffer_begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	command_buffer_begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+	command_buffer_begin_info.pInheritanceInfo = &inheritance_info;
+
+	err = vkBeginCommandBuffer(command_buffer, &command_buffer_begin_info);
+	if (err != VK_SUCCESS)
+		Sys_Error("vkBeginCommandBuffer failed");
+
+	vkCmdSetScissor(command_buffer, 0, 1, &vulkan_globals.main_render_pass_begin_info.renderArea);
+	vkCmdSetViewport(command_buffer, 0, 1, viewport);
+	vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkan_globals.basic_pipeline_layout, 0, 1, &vulkan_globals.sampler_descriptor_set, 0, NULL);
+	vkCmdPushConstants(command_buffer, vulkan_globals.basic_pipeline_layout, VK_SHADER_STAGE_VERTEX_BIT, 0, 16 * sizeof(float), view_projection_matrix);
+
+	return command_buffer;
+}
+
+/*
+=================
+GL_NextMainSegment
+=================
+*/
+static void GL_NextMainSegment (void)
+{
+	vulkan_globals.command_buffer = GL_BeginSecondaryCommandBuffer(RECORD_MAIN, &vulkan_globals.viewport, vulkan_globals.view_projection_matrix);
+	secondary_segments[num_secondary_segments++] = vulkan_globals.command_buffer;
+}
+
+/*
+=================
+GL_RecordThread
+=================
+*/
+static int SDLCALL GL_RecordThread (void *unused)
+{
+	recordjob_t	*job;
+	VkCommandBuffer	command_buffer;
+
+	SDL_LockMutex (recorder.lock);
+	for (;;)
+	{
+		if (recorder.numstarted == recorder.numqueued)
+		{
+			SDL_CondWait (recorder.queued, recorder.lock);
+			continue;
+		}
+
+		job = &recorder.jobs[recorder.numstarted++];
+		SDL_UnlockMutex (recorder.lock);
+
+		command_buffer = GL_BeginSecondaryCommandBuffer(RECORD_WORKER, &job->viewport, job->view_projection_matrix);
+		job->record(command_buffer, job->data);
+		if (vkEndCommandBuffer(command_buffer) != VK_SUCCESS)
+			Sys_Error("vkEndCommandBuffer failed");
+		secondary_segments[job->segment] = command_buffer;
+
+		SDL_LockMutex (recorder.lock);
+		recorder.numfinished++;
+		SDL_CondSignal (recorder.finished);
+	}
+
+	return 0;
+}
+
+/*
+=================
+GL_StartRecordThread
+=================
+*/
+static qboolean GL_StartRecordThread (void)
+{
+	if (recorder.thread)
+		return true;
+
+	if (!recorder.lock)
+	{
+		recorder.lock = SDL_CreateMutex ();
+		recorder.queued = SDL_CreateCond ();
+		recorder.finished = SDL_CreateCond ();
+		if (!recorder.lock || !recorder.queued || !recorder.finished)
+			Sys_Error ("GL_StartRecordThread: couldn't create sync objects");
+	}
+
+	recorder.thread = SDL_CreateThread (GL_RecordThread, "RecordThread", NULL);
+	if (!recorder.thread)
+	{
+		Con_Printf ("couldn't start command buffer recording thread: %s\n", SDL_GetError ());
+		Cvar_SetQuick (&r_parallel, "0");
+		return false;
+	}
+	return true;
+}
+
+/*
+=================
+GL_BeginMainRenderPass
+
+Begins the main render pass, with its contents in secondary command buffers
+if r_parallel is set. Everything up to GL_EndRendering then goes into them.
+=================
+*/
+void GL_BeginMainRenderPass (void)
+{
+	if (!r_parallel.value || !GL_StartRecordThread ())
+	{
+		vkCmdBeginRenderPass(vulkan_globals.command_buffer, &vulkan_globals.main_render_pass_begin_info, VK_SUBPASS_CONTENTS_INLINE);
+		return;
+	}
+
+	vkCmdBeginRenderPass(vulkan_globals.command_buffer, &vulkan_globals.main_render_pass_begin_info, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+	primary_command_buffer = vulkan_globals.command_buffer;
+	parallel_recording = true;
+	GL_NextMainSegment ();
+}
+
+/*
+=================
+GL_RecordParallel
+
+Records a pass on the worker thread, or right away when not recording in
+parallel. The state record starts with is that of a fresh main segment.
+=================
+*/
+void GL_RecordParallel (void (*record) (VkCommandBuffer command_buffer, void *data), void *data)
+{
+	recordjob_t *job;
+
+	if (!parallel_recording || recorder.numqueued == MAX_PARALLEL_JOBS)
+	{
+		record(vulkan_globals.command_buffer, data);
+		return;
+	}
+
+	if (vkEndCommandBuffer(vulkan_globals.command_buffer) != VK_SUCCESS)
+		Sys_Error("vkEndCommandBuffer failed");
+
+	job = &recorder.jobs[recorder.numqueued];
+	job->record = record;
+	job->data = data;
+	job->segment = num_secondary_segments++;
+	job->viewport = vulkan_globals.viewport;
+	memcpy(job->view_projection_matrix, vulkan_globals.view_projection_matrix, sizeof(job->view_projection_matrix));
+
+	SDL_LockMutex (recorder.lock);
+	recorder.numqueued++;
+	SDL_CondSignal (recorder.queued);
+	SDL_UnlockMutex (recorder.lock);
+
+	GL_NextMainSegment ();
+}
+
+/*
+=================
+GL_EndParallelRendering
+
+Waits for the worker and executes all segments in order.
+=================
+*/
+static void GL_EndParallelRendering (void)
+{
+	if (!parallel_recording)
+		return;
+
+	if (vkEndCommandBuffer(vulkan_globals.command_buffer) != VK_SUCCESS)
+		Sys_Error("vkEndCommandBuffer failed");
+
+	SDL_LockMutex (recorder.lock);
+	while (recorder.numfinished < recorder.numqueued)
+		SDL_CondWait (recorder.finished, recorder.lock);
+	recorder.numqueued = recorder.numstarted = recorder.numfinished = 0;
+	SDL_UnlockMutex (recorder.lock);
+
+	vulkan_globals.command_buffer = primary_command_buffer;
+	vkCmdExecuteCommands(vulkan_globals.command_buffer, num_secondary_segments, secondary_segments);
+
+	num_secondary_segments = 0;
+	for (int i = 0; i < NUM_RECORD_THREADS; ++i)
+		num_secondary_command_buffers[i] = 0;
+	parallel_recording = false;
 }
 
 /*
@@ -1164,6 +1539,7 @@ void GL_EndRendering (void)
 {
 	VkResult err;
 
+	GL_EndParallelRendering();
 	vkCmdEndRenderPass(vulkan_globals.command_buffer);
 
 	err = vkEndCommandBuffer(vulkan_globals.command_buffer);
@@ -1208,7 +1584,7 @@ GL_WaitForDeviceIdle
 */
 void GL_WaitForDeviceIdle()
 {
-	if (!device_idle)
+	if (!device_idle && !isHeadless)
 		vkDeviceWaitIdle(vulkan_globals.device);
 
 	device_idle = true;
@@ -1223,6 +1599,7 @@ void VID_Shutdown (void)
 {
 	if (vid_initialized)
 	{
+		R_SavePipelineCache();
 		SDL_QuitSubSystem(SDL_INIT_VIDEO);
 		draw_context = NULL;
 		PL_VID_Shutdown();
@@ -1316,6 +1693,37 @@ static void VID_FSAA_f (cvar_t *var)
 //
 //==========================================================================
 
+/*
+=================
+VID_InitHeadless
+
+-headless: no window and no Vulkan device.  The client runs as usual up to
+the point where it would record command buffers, see SCR_UpdateScreen.
+=================
+*/
+static void VID_InitHeadless (void)
+{
+	int		p;
+
+	vid.width = 640;
+	vid.height = 480;
+	p = COM_CheckParm("-width");
+	if (p && p < com_argc-1)
+		vid.width = q_max(320, Q_atoi(com_argv[p+1]));
+	p = COM_CheckParm("-height");
+	if (p && p < com_argc-1)
+		vid.height = q_max(200, Q_atoi(com_argv[p+1]));
+
+	vid.conwidth = vid.width & 0xFFFFFFF8;
+	vid.conheight = vid.conwidth * vid.height / vid.width;
+	vid.numpages = 2;
+	vid.colormap = host_colormap;
+	vid.fullbright = 256 - LittleLong (*((int *)vid.colormap + 2048));
+	vid.recalc_refdef = 1;
+
+	Con_Printf ("\nHeadless client, %dx%d, no Vulkan device\n", vid.width, vid.height);
+}
+
 /*
 =================
 VID_InitModelist
@@ -1385,6 +1793,12 @@ void	VID_Init (void)
 	Cmd_AddCommand ("vid_describecurrentmode", VID_DescribeCurrentMode_f);
 	Cmd_AddCommand ("vid_describemodes", VID_DescribeModes_f);
 
+	if (isHeadless)
+	{
+		VID_InitHeadless ();
+		return;
+	}
+
 	putenv (vid_center);	/* SDL_putenv is problematic in versions <= 1.2.9 */
 
 	if (SDL_InitSubSystem(SDL_INIT_VIDEO) < 0)
@@ -1491,6 +1905,7 @@ void	VID_Init (void)
 	R_InitDynamicBuffers();
 	R_InitSamplers();
 	R_CreatePipelineLayouts();
+	R_InitPipelineCache();
 	R_CreatePipelines();
 
 	//johnfitz -- removed code creating "glquake" subdirectory
@@ -218,8 +218,10 @@ void R_UpdateWarpTextures (void)
 		//render warp
 		GL_SetCanvas (CANVAS_WARPIMAGE);
 		vkCmdBindPipeline(vulkan_globals.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkan_globals.warp_pipeline);
+		COUNT (CNT_PIPELINEBINDS, 1);
 		vkCmdBindDescriptorSets(vulkan_globals.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkan_globals.basic_pipeline_layout, 0, 1, tx->gltexture->sampler_set, 0, NULL);
 		vkCmdBindDescriptorSets(vulkan_globals.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkan_globals.basic_pipeline_layout, 1, 1, &tx->gltexture->descriptor_set, 0, NULL);
+		COUNT (CNT_DESCRIPTORSETS, 2);
 
 		int num_verts = 0;
 		for (y=0.0; y<128.01; y+=warptess) // .01 for rounding errors
@@ -259,6 +261,8 @@ void R_UpdateWarpTextures (void)
 
 			vkCmdBindVertexBuffers(vulkan_globals.command_buffer, 0, 1, &buffer, &buffer_offset);
 			vkCmdDraw(vulkan_globals.command_buffer, num_verts, 1, 0, 0);
+			COUNT (CNT_DRAWCALLS, 1);
+			COUNT (CNT_TRIANGLES, num_verts - 2);
 		}
 
 		vkCmdEndRenderPass(vulkan_globals.command_buffer);
@@ -28,6 +28,8 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 void GL_WaitForDeviceIdle();
 void GL_BeginRendering (int *x, int *y, int *width, int *height);
 void GL_EndRendering (void);
+void GL_BeginMainRenderPass (void);
+void GL_RecordParallel (void (*record) (VkCommandBuffer command_buffer, void *data), void *data);
 void GL_Set2D (void);
 
 extern	int glx, gly, glwidth, glheight;
@@ -110,11 +112,15 @@ typedef struct
 	VkPhysicalDeviceProperties			device_properties;
 	VkPhysicalDeviceMemoryProperties	memory_properties;
 	uint32_t							gfx_queue_family_index;
+	qboolean							bindless;
+	qboolean							gpu_culling;
+	qboolean							gpu_particles;
 
 	// Render passes
 	VkRenderPass						main_render_pass;
 	VkClearValue						main_clear_values[2];
 	VkRenderPassBeginInfo				main_render_pass_begin_info;
+	VkViewport							viewport;		// last one set by GL_Viewport
 	VkRenderPass						warp_render_pass;
 
 	// Pipelines
@@ -125,6 +131,8 @@ typedef struct
 	VkPipeline							world_pipeline;
 	VkPipeline							world_fullbright_pipeline;
 	VkPipelineLayout					world_pipeline_layout;
+	VkPipeline							world_bindless_pipeline;
+	VkPipelineLayout					world_bindless_pipeline_layout;
 	VkPipeline							water_pipeline;
 	VkPipeline							warp_pipeline;
 	VkPipeline							particle_pipeline;
@@ -133,7 +141,14 @@ typedef struct
 	VkPipeline							sky_layer_pipeline;
 	VkPipelineLayout					sky_layer_pipeline_layout;
 	VkPipeline							alias_pipeline;
+	VkPipeline							alias_instanced_pipeline;
 	VkPipelineLayout					alias_pipeline_layout;
+	VkPipeline							world_cull_pipeline;
+	VkPipelineLayout					world_cull_pipeline_layout;
+	VkPipeline							particle_compute_pipeline;
+	VkPipelineLayout					particle_compute_pipeline_layout;
+
+	VkPipelineCache						pipeline_cache;
 
 	// Descriptors
 	VkDescriptorPool					descriptor_pool;
@@ -142,6 +157,11 @@ typedef struct
 	VkDescriptorSetLayout				sampler_set_layout;
 	VkDescriptorSetLayout				ubo_set_layout;
 	VkDescriptorSetLayout				single_texture_set_layout;
+	VkDescriptorPool					bindless_descriptor_pool;
+	VkDescriptorSet						bindless_descriptor_set;
+	VkDescriptorSetLayout				bindless_set_layout;
+	VkDescriptorSetLayout				world_cull_set_layout;
+	VkDescriptorSetLayout				particle_compute_set_layout;
 
 	// Samplers
 	VkSampler							point_sampler;
@@ -258,7 +278,7 @@ typedef struct
 
 //johnfitz -- moved here from r_brush.c
 extern int gl_lightmap_format, lightmap_bytes;
-#define MAX_LIGHTMAPS 256 //johnfitz -- was 64
+#define MAX_LIGHTMAPS 8 // 1024x1024 atlases, twice the texels of the old 256 128x128 blocks
 extern gltexture_t *lightmap_textures[MAX_LIGHTMAPS]; //johnfitz -- changed to an array
 
 extern qboolean r_drawflat_cheatsafe, r_fullbright_cheatsafe, r_lightmap_cheatsafe, r_drawworld_cheatsafe; //johnfitz
@@ -293,6 +313,7 @@ void R_InitParticles (void);
 void R_DrawParticles (void);
 void CL_RunParticles (void);
 void R_ClearParticles (void);
+void R_UpdateParticles (void);
 
 void R_TranslatePlayerSkin (int playernum);
 void R_TranslateNewPlayerSkin (int playernum); //johnfitz -- this handles cases when the actual texture changes
@@ -300,6 +321,8 @@ void R_UpdateWarpTextures (void);
 
 void R_DrawWorld (void);
 void R_DrawAliasModel (entity_t *e);
+void R_BeginAliasBatch (void);
+void R_FlushAliasBatch (void);
 void R_DrawBrushModel (entity_t *e);
 void R_DrawSpriteModel (entity_t *e);
 
@@ -309,6 +332,8 @@ void R_RenderDlights (void);
 void GL_BuildLightmaps (void);
 void GL_DeleteBModelVertexBuffer (void);
 void GL_BuildBModelVertexBuffer (void);
+void R_FreeWorldCache (void);
+void R_FreeWorldCulling (void);
 void GLMesh_LoadVertexBuffers (void);
 void GLMesh_DeleteVertexBuffers (void);
 void R_RebuildAllLightmaps (void);
@@ -353,6 +378,8 @@ void R_CreateDescriptorSetLayouts();
 void R_InitSamplers();
 void R_CreatePipelineLayouts();
 void R_CreatePipelines();
+void R_InitPipelineCache (void);
+void R_SavePipelineCache (void);
 
 void R_InitStagingBuffers();
 void R_SubmitStagingBuffers();
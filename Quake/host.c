@@ -65,6 +65,12 @@ cvar_t	max_edicts = {"max_edicts", "8192", CVAR_NONE}; //johnfitz //ericw -- cha
 
 cvar_t	sys_ticrate = {"sys_ticrate","0.05",CVAR_NONE}; // dedicated server
 cvar_t	serverprofile = {"serverprofile","0",CVAR_NONE};
+cvar_t	host_loadreport = {"host_loadreport","0",CVAR_NONE};	// seconds between server load reports
+
+cvar_t	host_pacing = {"host_pacing","0",CVAR_ARCHIVE};			// start frames on a fixed host_maxfps cadence
+cvar_t	host_pacing_spin = {"host_pacing_spin","2",CVAR_ARCHIVE};	// ms before a frame is due to stop sleeping and spin
+cvar_t	host_lateinput = {"host_lateinput","0",CVAR_ARCHIVE};		// sample mouse look again just before rendering
+cvar_t	host_latencyreport = {"host_latencyreport","0",CVAR_NONE};	// seconds between input latency reports
 
 cvar_t	fraglimit = {"fraglimit","0",CVAR_NOTIFY|CVAR_SERVERINFO};
 cvar_t	timelimit = {"timelimit","0",CVAR_NOTIFY|CVAR_SERVERINFO};
@@ -153,6 +159,14 @@ void Host_Error (const char *error, ...)
 
 	if (sv.active)
 		Host_ShutdownServer (false);
+	SV_AbortSpawn ();
+
+	if (SV_NumInstances ())
+	{
+		// only this instance's game is lost, _Host_Frame switches back
+		inerror = false;
+		longjmp (host_abortserver, 1);
+	}
 
 	if (cls.state == ca_dedicated)
 		Sys_Error ("Host_Error: %s\n",string);	// dedicated servers exit
@@ -209,6 +223,20 @@ void	Host_FindMaxClients (void)
 	svs.maxclientslimit = svs.maxclients;
 	if (svs.maxclientslimit < 4)
 		svs.maxclientslimit = 4;
+
+	// -maxplayers reserves slots that "maxplayers" can later grow into;
+	// idle slots are cheap since their message buffers are allocated
+	// only when a client actually connects
+	i = COM_CheckParm ("-maxplayers");
+	if (i)
+	{
+		if (i != (com_argc - 1))
+			svs.maxclientslimit = Q_atoi (com_argv[i+1]);
+		if (svs.maxclientslimit < svs.maxclients)
+			svs.maxclientslimit = svs.maxclients;
+		else if (svs.maxclientslimit > MAX_SCOREBOARD)
+			svs.maxclientslimit = MAX_SCOREBOARD;
+	}
 	svs.clients = (struct client_s *) Hunk_AllocName (svs.maxclientslimit*sizeof(client_t), "clients");
 
 	if (svs.maxclients > 1)
@@ -254,6 +282,11 @@ void Host_InitLocal (void)
 	Cvar_RegisterVariable (&sys_ticrate);
 	Cvar_RegisterVariable (&sys_throttle);
 	Cvar_RegisterVariable (&serverprofile);
+	Cvar_RegisterVariable (&host_loadreport);
+	Cvar_RegisterVariable (&host_pacing);
+	Cvar_RegisterVariable (&host_pacing_spin);
+	Cvar_RegisterVariable (&host_lateinput);
+	Cvar_RegisterVariable (&host_latencyreport);
 
 	Cvar_RegisterVariable (&fraglimit);
 	Cvar_RegisterVariable (&timelimit);
@@ -439,6 +472,13 @@ void SV_DropClient (qboolean crash)
 	NET_Close (host_client->netconnection);
 	host_client->netconnection = NULL;
 
+// hand the message buffer back; progs may still write to the slot, which
+// just pulls a fresh block from the pool
+	Pool_Free (host_client->message.data);
+	host_client->message.data = NULL;
+	host_client->message.maxsize = 0;
+	host_client->message.cursize = 0;
+
 // free the client (the body stays around)
 	host_client->active = false;
 	host_client->name[0] = 0;
@@ -480,6 +520,8 @@ void Host_ShutdownServer(qboolean crash)
 	if (!sv.active)
 		return;
 
+	SV_RecordShutdown ();
+
 	sv.active = false;
 
 // stop all client sounds immediately
@@ -516,6 +558,7 @@ void Host_ShutdownServer(qboolean crash)
 	buf.data = message;
 	buf.maxsize = 4;
 	buf.cursize = 0;
+	buf.growsize = 0;
 	MSG_WriteByte(&buf, svc_disconnect);
 	count = NET_SendToAll(&buf, 5.0);
 	if (count)
@@ -529,6 +572,8 @@ void Host_ShutdownServer(qboolean crash)
 // clear structures
 //
 //	memset (&sv, 0, sizeof(sv)); // ServerSpawn already do this by Host_ClearMemory
+	for (i = 0; i < svs.maxclientslimit; i++)
+		Pool_Free (svs.clients[i].message.data);
 	memset (svs.clients, 0, svs.maxclientslimit*sizeof(client_t));
 }
 
@@ -544,9 +589,16 @@ not reinitialize anything.
 void Host_ClearMemory (void)
 {
 	Con_DPrintf ("Clearing memory\n");
-	Mod_ClearAll ();
+	// other server instances share the models and progs on the hunk, so maps
+	// stay loaded until the last one stops (SV_SpawnServer refuses those that
+	// don't fit any more); the per map edicts and strings are malloc'd
+	if (!SV_NumInstances ())
+	{
+		Mod_ClearAll ();
 /* host_hunklevel MUST be set at this point */
-	Hunk_FreeToLowMark (host_hunklevel);
+		Hunk_FreeToLowMark (host_hunklevel);
+	}
+	free (sv.edicts);
 	cls.signon = 0;
 	memset (&sv, 0, sizeof(sv));
 	memset (&cl, 0, sizeof(cl));
@@ -559,6 +611,60 @@ void Host_ClearMemory (void)
 //
 //==============================================================================
 
+/*
+===================
+Host_Paced
+
+True when host_pacing sets the frame cadence
+===================
+*/
+static qboolean Host_Paced (void)
+{
+	return host_pacing.value && !cls.timedemo && !isDedicated;
+}
+
+/*
+===================
+Host_WaitFrame
+
+With host_pacing on, frames start on a fixed 1/host_maxfps cadence
+instead of whenever the main loop next polls past the limit.  The wait
+sleeps until host_pacing_spin ms before the frame is due and spins the
+rest, since the OS sleep granularity is about a millisecond at best.
+A frame that starts late pulls the next one in; falling more than a
+whole frame behind restarts the cadence from now.
+===================
+*/
+static double	host_nextframe;
+
+void Host_WaitFrame (void)
+{
+	double	period, spin, now;
+
+	if (!Host_Paced ())
+	{
+		host_nextframe = 0;
+		return;
+	}
+
+	period = 1.0 / CLAMP (10.0, host_maxfps.value, 1000.0);
+	spin = CLAMP (0.0, host_pacing_spin.value, 10.0) / 1000.0;
+
+	now = Sys_DoubleTime ();
+	if (!host_nextframe || now - host_nextframe > period || host_nextframe - now > period)
+		host_nextframe = now;
+
+	while (host_nextframe - now > spin + 0.001)
+	{
+		Sys_Sleep ((unsigned long)((host_nextframe - now - spin) * 1000.0));
+		now = Sys_DoubleTime ();
+	}
+	while (now < host_nextframe)
+		now = Sys_DoubleTime ();
+
+	host_nextframe += period;
+}
+
 /*
 ===================
 Host_FilterTime
@@ -574,7 +680,7 @@ qboolean Host_FilterTime (float time)
 
 	//johnfitz -- max fps cvar
 	maxfps = CLAMP (10.0, host_maxfps.value, 1000.0);
-	if (!cls.timedemo && realtime - oldrealtime < 1.0/maxfps)
+	if (!cls.timedemo && !isDedicated && !Host_Paced () && realtime - oldrealtime < 1.0/maxfps)	// Host_DedicatedLoop does its own pacing, Host_WaitFrame the paced one
 		return false; // framerate is too high
 	//johnfitz
 
@@ -616,6 +722,99 @@ void Host_GetConsoleCommands (void)
 	}
 }
 
+/*
+==================
+Host_LoadReport
+
+Every host_loadreport seconds, prints what the server frames cost and
+how much traffic went through the datagram driver.
+==================
+*/
+static void Host_LoadReport (double servertime)
+{
+	static double	reporttime, total, worst;
+	static int		frames;
+	static netstats_t	last;
+	netstats_t	stats;
+	double		span;
+
+	if (host_loadreport.value <= 0)
+	{
+		reporttime = 0;
+		return;
+	}
+
+	frames++;
+	total += servertime;
+	worst = q_max (worst, servertime);
+	if (realtime < reporttime)
+		return;
+
+	span = host_loadreport.value;
+	NET_GetStats (&stats);
+	if (reporttime && frames)
+	{
+		Con_Printf ("load: %i frames, server %.2f ms avg %.2f ms max, %i clients, out %.1f kB/s, in %.1f kB/s, %i resent\n",
+					frames, total * 1000 / frames, worst * 1000, net_activeconnections,
+					(stats.bytessent - last.bytessent) / (1024 * span),
+					(stats.bytesreceived - last.bytesreceived) / (1024 * span),
+					stats.packetsresent - last.packetsresent);
+	}
+
+	last = stats;
+	frames = 0;
+	total = worst = 0;
+	reporttime = realtime + span;
+}
+
+/*
+==================
+Host_LatencyReport
+
+Every host_latencyreport seconds, prints how long input sat between
+being sampled and the frame built from it being submitted, and how
+evenly frames started.
+==================
+*/
+static void Host_LatencyReport (double latency, double framestart)
+{
+	static double	reporttime, laststart, total, worst, interval, interval2;
+	static int		frames;
+	double			delta, mean;
+
+	if (host_latencyreport.value <= 0)
+	{
+		reporttime = laststart = 0;
+		return;
+	}
+
+	if (laststart)
+	{
+		delta = framestart - laststart;
+		interval += delta;
+		interval2 += delta * delta;
+	}
+	laststart = framestart;
+
+	frames++;
+	total += latency;
+	worst = q_max (worst, latency);
+	if (realtime < reporttime)
+		return;
+
+	if (reporttime && frames > 1)
+	{
+		mean = interval / (frames - 1);
+		Con_Printf ("latency: %i frames, input to submit %.2f ms avg %.2f ms max, frame interval %.2f ms +/- %.2f ms\n",
+					frames, total * 1000 / frames, worst * 1000, mean * 1000,
+					sqrt (q_max (0.0, interval2 / (frames - 1) - mean * mean)) * 1000);
+	}
+
+	frames = 0;
+	total = worst = interval = interval2 = 0;
+	reporttime = realtime + host_latencyreport.value;
+}
+
 /*
 ==================
 Host_ServerFrame
@@ -626,6 +825,10 @@ void Host_ServerFrame (void)
 	int		i, active; //johnfitz
 	edict_t	*ent; //johnfitz
 
+// when replaying a recording this sets host_frametime
+	if (!SV_RecordFrame ())
+		return;
+
 // run the world state
 	pr_global_struct->frametime = host_frametime;
 
@@ -661,6 +864,8 @@ void Host_ServerFrame (void)
 
 // send all messages to the clients
 	SV_SendClientMessages ();
+
+	SV_RecordFrameEnd ();
 }
 
 /*
@@ -676,9 +881,13 @@ void _Host_Frame (float time)
 	static double		time2 = 0;
 	static double		time3 = 0;
 	int			pass1, pass2, pass3;
+	double		framestart, serverstart, serverend, inputtime;
 
 	if (setjmp (host_abortserver) )
+	{
+		SV_SwitchInstance (0);
 		return;			// something bad happened, or the server disconnected
+	}
 
 // keep the random time dependent
 	rand ();
@@ -687,10 +896,13 @@ void _Host_Frame (float time)
 	if (!Host_FilterTime (time))
 		return;			// don't run too fast, or packets will flood out
 
+	framestart = Sys_DoubleTime ();
+
 // get new key events
 	Key_UpdateForDest ();
 	IN_UpdateInputMode ();
 	Sys_SendKeyEvents ();
+	inputtime = Sys_DoubleTime ();
 
 // allow mice or other external controllers to add commands
 	IN_Commands ();
@@ -713,9 +925,19 @@ void _Host_Frame (float time)
 // check for commands typed to the host
 	Host_GetConsoleCommands ();
 
+	serverstart = Sys_DoubleTime ();
+
 	if (sv.active)
 		Host_ServerFrame ();
 
+	SV_RunInstances ();
+
+	serverend = Sys_DoubleTime ();
+	if (sv.active)
+		Host_LoadReport (serverend - serverstart);
+
+	CL_RunBots ();
+
 //-------------------
 //
 // client operations
@@ -732,14 +954,24 @@ void _Host_Frame (float time)
 		CL_ReadFromServer ();
 
 // update video
-	if (host_speeds.value)
+	if (host_speeds.value || cls.timedemo)
 		time1 = Sys_DoubleTime ();
 
+// pick up mouse look that arrived while the frame was simulated
+	if (host_lateinput.value && cls.signon == SIGNONS && key_dest == key_game)
+	{
+		Sys_SendKeyEvents ();
+		IN_LateLook ();
+		inputtime = Sys_DoubleTime ();
+	}
+
 	SCR_UpdateScreen ();
 
+	Host_LatencyReport (Sys_DoubleTime () - inputtime, framestart);
+
 	CL_RunParticles (); //johnfitz -- seperated from rendering
 
-	if (host_speeds.value)
+	if (host_speeds.value || cls.timedemo)
 		time2 = Sys_DoubleTime ();
 
 // update audio
@@ -754,6 +986,10 @@ void _Host_Frame (float time)
 
 	CDAudio_Update();
 
+	if (cls.timedemo)
+		CL_TimeDemoFrame ((serverstart - framestart) + (time1 - serverend), serverend - serverstart,
+						  time2 - time1, Sys_DoubleTime () - time2);
+
 	if (host_speeds.value)
 	{
 		pass1 = (time1 - time3)*1000;
@@ -765,7 +1001,7 @@ void _Host_Frame (float time)
 	}
 
 	host_framecount++;
-
+	Prof_CountFrame ();
 }
 
 void Host_Frame (float time)
@@ -775,9 +1011,14 @@ void Host_Frame (float time)
 	static int		timecount;
 	int		i, c, m;
 
+	PROF_FRAME_BEGIN ();
+	PROF_BEGIN ("Host_Frame");
+
 	if (!serverprofile.value)
 	{
 		_Host_Frame (time);
+		PROF_END ();
+		PROF_FRAME_END ();
 		return;
 	}
 
@@ -785,6 +1026,9 @@ void Host_Frame (float time)
 	_Host_Frame (time);
 	time2 = Sys_DoubleTime ();
 
+	PROF_END ();
+	PROF_FRAME_END ();
+
 	timetotal += time2 - time1;
 	timecount++;
 
@@ -804,6 +1048,79 @@ void Host_Frame (float time)
 	Con_Printf ("serverprofile: %2i clients %2i msec\n",  c,  m);
 }
 
+/*
+==================
+Host_DedicatedLoop
+
+Dedicated servers run one frame every sys_ticrate seconds and block on
+the network sockets and stdin in between instead of spinning.  Ticks are
+scheduled on a fixed grid; a frame that takes longer than a tick counts as
+an overrun, and if the server falls more than a tick behind the missed
+ticks are dropped.  Overruns are reported every ten seconds.
+==================
+*/
+#define	TICK_REPORTTIME	10.0
+
+void Host_DedicatedLoop (void)
+{
+	double	tick, now, nexttick, lasttick, framestart, frametime;
+	double	reporttime, worst;
+	int		overruns, skipped;
+
+	lasttick = nexttick = Sys_DoubleTime ();
+	reporttime = lasttick + TICK_REPORTTIME;
+	overruns = skipped = 0;
+	worst = 0;
+
+	while (1)
+	{
+		tick = CLAMP (0.001, sys_ticrate.value, 0.1);
+		now = Sys_DoubleTime ();
+
+		if (now < nexttick && !SV_Replaying ())
+		{
+			// with no map running there is nothing to simulate, so idle
+			// frames only happen once a second unless something arrives
+			if (Sys_WaitForEvents (q_min (nexttick - now, tick)) && !sv.active && !CL_NumBots ())
+				nexttick = Sys_DoubleTime ();
+			continue;
+		}
+
+		framestart = now;
+		Host_Frame (now - lasttick);
+		lasttick = now;
+		if (!sv.active && !CL_NumBots ())
+		{
+			nexttick = framestart + (cmd_text.cursize ? tick : 1.0);	// run queued commands promptly
+			continue;
+		}
+		nexttick += tick;
+
+		now = Sys_DoubleTime ();
+		frametime = now - framestart;
+		if (frametime > tick)
+		{
+			overruns++;
+			worst = q_max (worst, frametime);
+		}
+		if (now > nexttick + tick)
+		{
+			skipped += (int) ((now - nexttick) / tick);
+			nexttick = now;
+		}
+
+		if (now >= reporttime)
+		{
+			if (overruns)
+				Con_Printf ("%i tick overruns in %.0f seconds (worst %.1f ms, tick %.1f ms), %i ticks skipped\n",
+							overruns, TICK_REPORTTIME, worst * 1000, tick * 1000, skipped);
+			overruns = skipped = 0;
+			worst = 0;
+			reporttime = now + TICK_REPORTTIME;
+		}
+	}
+}
+
 /*
 ====================
 Host_Init
@@ -829,6 +1146,7 @@ void Host_Init (void)
 	Cmd_Init ();
 	LOG_Init (host_parms);
 	Cvar_Init (); //johnfitz
+	Prof_Init ();
 	COM_Init ();
 	COM_InitFilesystem ();
 	Host_InitLocal ();
@@ -842,6 +1160,7 @@ void Host_Init (void)
 	Mod_Init ();
 	NET_Init ();
 	SV_Init ();
+	CL_InitBots ();
 
 	Con_Printf ("Exe: "__TIME__" "__DATE__"\n");
 	Con_Printf ("%4.1f megabyte heap\n", host_parms->memsize/ (1024*1024.0));
@@ -920,6 +1239,8 @@ void Host_Shutdown(void)
 
 	Host_WriteConfiguration ();
 
+	CL_FinishRecording ();
+
 	NET_Shutdown ();
 
 	if (cls.state != ca_dedicated)
@@ -30,8 +30,6 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 extern cvar_t	pausable;
 
-int	current_skill;
-
 void Mod_Print (void);
 
 /*
@@ -48,6 +46,7 @@ void Host_Quit_f (void)
 		return;
 	}
 	CL_Disconnect ();
+	SV_ShutdownInstances ();
 	Host_ShutdownServer(false);
 
 	Sys_Quit ();
@@ -1052,6 +1051,7 @@ void Host_Loadgame_f (void)
 	float	time, tfloat;
 	char	str[32768];
 	const char  *start;
+	char	*lightstyle;
 	int	i, r;
 	edict_t	*ent;
 	int	entnum;
@@ -1120,7 +1120,9 @@ void Host_Loadgame_f (void)
 	for (i = 0; i < MAX_LIGHTSTYLES; i++)
 	{
 		fscanf (f, "%s\n", str);
-		sv.lightstyles[i] = (const char *)Hunk_Strdup (str, "lightstyles");
+		PR_AllocString (strlen(str) + 1, &lightstyle);
+		strcpy (lightstyle, str);
+		sv.lightstyles[i] = lightstyle;
 	}
 
 // load the edicts out of the savegame file
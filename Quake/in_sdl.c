@@ -192,6 +192,39 @@ void IN_Move (usercmd_t *cmd)
 	}
 }
 
+/*
+===========
+IN_LateLook
+
+Applies pending mouse look to cl.viewangles right before the view is
+rendered, so the frame shows the freshest input.  Motion that IN_Move
+would turn into movement is left for the next usercmd.
+===========
+*/
+void IN_LateLook (void)
+{
+	int		dmx, dmy;
+
+	if (!(in_mlook.state & 1) || (in_strafe.state & 1) || lookstrafe.value)
+		return;
+
+	dmx = total_dx * sensitivity.value;
+	dmy = total_dy * sensitivity.value;
+	if (!dmx && !dmy)
+		return;
+
+	total_dx = 0;
+	total_dy = 0;
+
+	V_StopPitchDrift ();
+	cl.viewangles[YAW] -= m_yaw.value * dmx;
+	cl.viewangles[PITCH] += m_pitch.value * dmy;
+	if (cl.viewangles[PITCH] > cl_maxpitch.value)
+		cl.viewangles[PITCH] = cl_maxpitch.value;
+	if (cl.viewangles[PITCH] < cl_minpitch.value)
+		cl.viewangles[PITCH] = cl_minpitch.value;
+}
+
 void IN_ClearStates (void)
 {
 }
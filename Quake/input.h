@@ -44,6 +44,9 @@ void IN_UpdateInputMode (void);
 void IN_Move (usercmd_t *cmd);
 // add additional movement on top of the keyboard move cmd
 
+void IN_LateLook (void);
+// apply pending mouse look to the view angles just before rendering
+
 void IN_ClearStates (void);
 // restores all button and position states to defaults
 
@@ -83,6 +83,7 @@ int main(int argc, char *argv[])
 	COM_InitArgv(parms.argc, parms.argv);
 
 	isDedicated = (COM_CheckParm("-dedicated") != 0);
+	isHeadless = !isDedicated && (COM_CheckParm("-headless") != 0 || COM_CheckParm("-analyze") != 0);
 
 	Sys_InitSDL ();
 
@@ -113,26 +114,16 @@ int main(int argc, char *argv[])
 	Sys_Printf("Host_Init\n");
 	Host_Init();
 
-	oldtime = Sys_DoubleTime();
-	if (isDedicated)
+	if (COM_CheckParm("-analyze"))
 	{
-		while (1)
-		{
-			newtime = Sys_DoubleTime ();
-			time = newtime - oldtime;
-
-			while (time < sys_ticrate.value )
-			{
-				SDL_Delay(1);
-				newtime = Sys_DoubleTime ();
-				time = newtime - oldtime;
-			}
-
-			Host_Frame (time);
-			oldtime = newtime;
-		}
+		CL_AnalyzeCommandLine ();
+		Sys_Quit ();
 	}
-	else
+
+	if (isDedicated)
+		Host_DedicatedLoop ();
+
+	oldtime = Sys_DoubleTime();
 	while (1)
 	{
 		/* If we have no input focus at all, sleep a bit */
@@ -150,12 +141,15 @@ int main(int argc, char *argv[])
 		{
 			scr_skipupdate = 0;
 		}
+		/* sleep until the next frame is due when host_pacing is on */
+		Host_WaitFrame ();
+
 		newtime = Sys_DoubleTime ();
 		time = newtime - oldtime;
 
 		Host_Frame (time);
 
-		if (time < sys_throttle.value)
+		if (time < sys_throttle.value && !host_pacing.value)
 			SDL_Delay(1);
 
 		oldtime = newtime;
@@ -37,13 +37,12 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #define NET_MAXMESSAGE		64000	/* ericw -- was 32000 */
 
 extern int		DEFAULTnet_hostport;
-extern int		net_hostport;
+// net_hostport and net_activeconnections belong to a server instance, see server.h
 
 extern cvar_t		hostname;
 
 extern	double		net_time;
 extern	sizebuf_t	net_message;
-extern	int		net_activeconnections;
 
 
 void	NET_Init (void);
@@ -55,6 +54,9 @@ struct qsocket_s	*NET_CheckNewConnections (void);
 struct qsocket_s	*NET_Connect (const char *host);
 // called by client to connect to a host.  Returns -1 if not able to
 
+struct qsocket_s	*NET_ConnectDirect (const char *host);
+// like NET_Connect, but skips the server list and the loopback driver
+
 double NET_QSocketGetTime (const struct qsocket_s *sock);
 const char *NET_QSocketGetAddressString (const struct qsocket_s *sock);
 
@@ -90,6 +92,27 @@ void	NET_Close (struct qsocket_s *sock);
 
 void	NET_Poll (void);
 
+struct netlisten_s	*NET_OpenListen (int port, int maxclients);
+void	NET_SwapListen (struct netlisten_s *listen);
+void	NET_CloseListen (struct netlisten_s *listen);
+// accept sockets of additional server instances, see sv_inst.c.
+// NET_SwapListen trades the live accept sockets with the given set.
+
+void	NET_AddQSockets (int count);
+// grows the qsocket pool, the extra sockets are never released
+
+typedef struct
+{
+	int		packetssent;
+	int		packetsresent;
+	int		packetsreceived;
+	int		bytessent;
+	int		bytesreceived;
+} netstats_t;
+
+void	NET_GetStats (netstats_t *stats);
+// running totals of the datagram driver
+
 
 // Server list related globals:
 extern	qboolean	slistInProgress;
@@ -27,6 +27,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "net_dgrm.h"
 #include "net_loop.h"
+#include "sv_replay.h"
 
 net_driver_t net_drivers[] =
 {
@@ -60,6 +61,22 @@ net_driver_t net_drivers[] =
 		Datagram_CanSendUnreliableMessage,
 		Datagram_Close,
 		Datagram_Shutdown
+	},
+
+	{	"Replay",
+		false,
+		Replay_Init,
+		Replay_Listen,
+		Replay_SearchForHosts,
+		Replay_Connect,
+		Replay_CheckNewConnections,
+		Replay_GetMessage,
+		Replay_SendMessage,
+		Replay_SendUnreliableMessage,
+		Replay_CanSendMessage,
+		Replay_CanSendUnreliableMessage,
+		Replay_Close,
+		Replay_Shutdown
 	}
 };
 
@@ -75,6 +92,7 @@ net_landriver_t	net_landrivers[] =
 		UDP_Init,
 		UDP_Shutdown,
 		UDP_Listen,
+		UDP_SetAcceptSocket,
 		UDP_OpenSocket,
 		UDP_CloseSocket,
 		UDP_Connect,
@@ -144,16 +144,18 @@ typedef struct qsocket_s
 	unsigned int	sendSequence;
 	unsigned int	unreliableSendSequence;
 	int		sendMessageLength;
-	byte		sendMessage [NET_MAXMESSAGE];
+	byte		*sendMessage;		/* pool block, grown on demand up to NET_MAXMESSAGE */
 
 	unsigned int	receiveSequence;
 	unsigned int	unreliableReceiveSequence;
 	int		receiveMessageLength;
-	byte		receiveMessage [NET_MAXMESSAGE];
+	byte		*receiveMessage;	/* pool block, grown on demand up to NET_MAXMESSAGE */
 
 	struct qsockaddr	addr;
 	char		address[NET_NAMELEN];
 
+	struct netimpair_s	*impair;	/* simulated lag and loss, see net_impair.c */
+
 } qsocket_t;
 
 extern qsocket_t	*net_activeSockets;
@@ -168,6 +170,7 @@ typedef struct
 	sys_socket_t	(*Init) (void);
 	void		(*Shutdown) (void);
 	void		(*Listen) (qboolean state);
+	sys_socket_t	(*SetAcceptSocket) (sys_socket_t socketid);	/* returns the previous one */
 	sys_socket_t	(*Open_Socket) (int port);
 	int		(*Close_Socket) (sys_socket_t socketid);
 	int		(*Connect) (sys_socket_t socketid, struct qsockaddr *addr);
@@ -42,6 +42,8 @@ static int packetsReceived = 0;
 static int receivedDuplicateCount = 0;
 static int shortPacketCount = 0;
 static int droppedDatagrams;
+static int bytesSent;
+static int bytesReceived;
 
 static struct
 {
@@ -147,6 +149,7 @@ int Datagram_SendMessage (qsocket_t *sock, sizebuf_t *data)
 		Sys_Error("SendMessage: called with canSend == false\n");
 #endif
 
+	sock->sendMessage = (byte *) Pool_Realloc (sock->sendMessage, 0, data->cursize);
 	Q_memcpy(sock->sendMessage, data->data, data->cursize);
 	sock->sendMessageLength = data->cursize;
 
@@ -168,11 +171,12 @@ int Datagram_SendMessage (qsocket_t *sock, sizebuf_t *data)
 
 	sock->canSend = false;
 
-	if (sfunc.Write (sock->socket, (byte *)&packetBuffer, packetLen, &sock->addr) == -1)
+	if (Impair_Write (sock, (byte *)&packetBuffer, packetLen, &sock->addr) == -1)
 		return -1;
 
 	sock->lastSendTime = net_time;
 	packetsSent++;
+	bytesSent += packetLen;
 	return 1;
 }
 
@@ -201,11 +205,12 @@ static int SendMessageNext (qsocket_t *sock)
 
 	sock->sendNext = false;
 
-	if (sfunc.Write (sock->socket, (byte *)&packetBuffer, packetLen, &sock->addr) == -1)
+	if (Impair_Write (sock, (byte *)&packetBuffer, packetLen, &sock->addr) == -1)
 		return -1;
 
 	sock->lastSendTime = net_time;
 	packetsSent++;
+	bytesSent += packetLen;
 	return 1;
 }
 
@@ -234,11 +239,12 @@ static int ReSendMessage (qsocket_t *sock)
 
 	sock->sendNext = false;
 
-	if (sfunc.Write (sock->socket, (byte *)&packetBuffer, packetLen, &sock->addr) == -1)
+	if (Impair_Write (sock, (byte *)&packetBuffer, packetLen, &sock->addr) == -1)
 		return -1;
 
 	sock->lastSendTime = net_time;
 	packetsReSent++;
+	bytesSent += packetLen;
 	return 1;
 }
 
@@ -276,10 +282,11 @@ int Datagram_SendUnreliableMessage (qsocket_t *sock, sizebuf_t *data)
 	packetBuffer.sequence = BigLong(sock->unreliableSendSequence++);
 	Q_memcpy (packetBuffer.data, data->data, data->cursize);
 
-	if (sfunc.Write (sock->socket, (byte *)&packetBuffer, packetLen, &sock->addr) == -1)
+	if (Impair_Write (sock, (byte *)&packetBuffer, packetLen, &sock->addr) == -1)
 		return -1;
 
 	packetsSent++;
+	bytesSent += packetLen;
 	return 1;
 }
 
@@ -297,14 +304,13 @@ int	Datagram_GetMessage (qsocket_t *sock)
 		if ((net_time - sock->lastSendTime) > 1.0)
 			ReSendMessage (sock);
 
+	Impair_Flush (sock);
+
 	while (1)
 	{
-		length = (unsigned int) sfunc.Read(sock->socket, (byte *)&packetBuffer,
+		length = (unsigned int) Impair_Read(sock, (byte *)&packetBuffer,
 							NET_DATAGRAMSIZE, &readaddr);
 
-	//	if ((rand() & 255) > 220)
-	//		continue;
-
 		if (length == 0)
 			break;
 
@@ -337,6 +343,7 @@ int	Datagram_GetMessage (qsocket_t *sock)
 
 		sequence = BigLong(packetBuffer.sequence);
 		packetsReceived++;
+		bytesReceived += length;
 
 		if (flags & NETFLAG_UNRELIABLE)
 		{
@@ -389,6 +396,9 @@ int	Datagram_GetMessage (qsocket_t *sock)
 			}
 			else
 			{
+				// whole message acknowledged, the buffer can go back to the pool
+				Pool_Free (sock->sendMessage);
+				sock->sendMessage = NULL;
 				sock->sendMessageLength = 0;
 				sock->canSend = true;
 			}
@@ -399,7 +409,7 @@ int	Datagram_GetMessage (qsocket_t *sock)
 		{
 			packetBuffer.length = BigLong(NET_HEADERSIZE | NETFLAG_ACK);
 			packetBuffer.sequence = BigLong(sequence);
-			sfunc.Write (sock->socket, (byte *)&packetBuffer, NET_HEADERSIZE, &readaddr);
+			Impair_Write (sock, (byte *)&packetBuffer, NET_HEADERSIZE, &readaddr);
 
 			if (sequence != sock->receiveSequence)
 			{
@@ -410,17 +420,27 @@ int	Datagram_GetMessage (qsocket_t *sock)
 
 			length -= NET_HEADERSIZE;
 
+			if (sock->receiveMessageLength + length > NET_MAXMESSAGE)
+			{
+				Con_Printf("Oversized reliable message\n");
+				return -1;
+			}
+
 			if (flags & NETFLAG_EOM)
 			{
 				SZ_Clear(&net_message);
-				SZ_Write(&net_message, sock->receiveMessage, sock->receiveMessageLength);
+				if (sock->receiveMessageLength)
+					SZ_Write(&net_message, sock->receiveMessage, sock->receiveMessageLength);
 				SZ_Write(&net_message, packetBuffer.data, length);
+				Pool_Free (sock->receiveMessage);
+				sock->receiveMessage = NULL;
 				sock->receiveMessageLength = 0;
 
 				ret = 1;
 				break;
 			}
 
+			sock->receiveMessage = (byte *) Pool_Realloc (sock->receiveMessage, sock->receiveMessageLength, sock->receiveMessageLength + length);
 			Q_memcpy(sock->receiveMessage + sock->receiveMessageLength, packetBuffer.data, length);
 			sock->receiveMessageLength += length;
 			continue;
@@ -434,6 +454,23 @@ int	Datagram_GetMessage (qsocket_t *sock)
 }
 
 
+/*
+====================
+NET_GetStats
+
+Totals of the datagram driver, for load reports.
+====================
+*/
+void NET_GetStats (netstats_t *stats)
+{
+	stats->packetssent = packetsSent;
+	stats->packetsresent = packetsReSent;
+	stats->packetsreceived = packetsReceived;
+	stats->bytessent = bytesSent;
+	stats->bytesreceived = bytesReceived;
+}
+
+
 static void PrintStats(qsocket_t *s)
 {
 	Con_Printf("canSend = %4u   \n", s->canSend);
@@ -458,6 +495,10 @@ static void NET_Stats_f (void)
 		Con_Printf("receivedDuplicateCount     = %i\n", receivedDuplicateCount);
 		Con_Printf("shortPacketCount           = %i\n", shortPacketCount);
 		Con_Printf("droppedDatagrams           = %i\n", droppedDatagrams);
+		Con_Printf("bytesSent                  = %i\n", bytesSent);
+		Con_Printf("bytesReceived              = %i\n", bytesReceived);
+		Impair_Report ();
+		Pool_Report ();
 	}
 	else if (Q_strcmp(Cmd_Argv(1), "*") == 0)
 	{
@@ -791,6 +832,7 @@ int Datagram_Init (void)
 	myDriverLevel = net_driverlevel;
 
 	Cmd_AddCommand ("net_stats", NET_Stats_f);
+	Impair_Init (myDriverLevel);
 
 	if (safemode || COM_CheckParm("-nolan"))
 		return -1;
@@ -839,6 +881,7 @@ void Datagram_Shutdown (void)
 
 void Datagram_Close (qsocket_t *sock)
 {
+	Impair_Release (sock);
 	sfunc.Close_Socket(sock->socket);
 }
 
@@ -855,6 +898,66 @@ void Datagram_Listen (qboolean state)
 }
 
 
+/*
+accept sockets for additional server instances.  the landrivers only know
+about one accept socket each, so the instances trade theirs in and out with
+Datagram_SwapListen; while an instance is active its netlisten_t holds the
+sockets of the one it replaced.
+*/
+struct netlisten_s
+{
+	sys_socket_t	acceptsock[MAX_NET_DRIVERS];
+};
+
+struct netlisten_s *Datagram_OpenListen (int port)
+{
+	struct netlisten_s	*listen;
+	int		i;
+
+	listen = (struct netlisten_s *) Z_Malloc (sizeof(*listen));
+	for (i = 0; i < MAX_NET_DRIVERS; i++)
+		listen->acceptsock[i] = INVALID_SOCKET;
+
+	for (i = 0; i < net_numlandrivers; i++)
+	{
+		if (!net_landrivers[i].initialized)
+			continue;
+		listen->acceptsock[i] = net_landrivers[i].Open_Socket (port);
+		if (listen->acceptsock[i] == INVALID_SOCKET)
+		{
+			Con_Printf ("%s: unable to open accept socket on port %i\n", net_landrivers[i].name, port);
+			Datagram_CloseListen (listen);
+			return NULL;
+		}
+	}
+
+	return listen;
+}
+
+void Datagram_SwapListen (struct netlisten_s *listen)
+{
+	int		i;
+
+	for (i = 0; i < net_numlandrivers; i++)
+	{
+		if (net_landrivers[i].initialized)
+			listen->acceptsock[i] = net_landrivers[i].SetAcceptSocket (listen->acceptsock[i]);
+	}
+}
+
+void Datagram_CloseListen (struct netlisten_s *listen)
+{
+	int		i;
+
+	for (i = 0; i < net_numlandrivers; i++)
+	{
+		if (listen->acceptsock[i] != INVALID_SOCKET)
+			net_landrivers[i].Close_Socket (listen->acceptsock[i]);
+	}
+	Z_Free (listen);
+}
+
+
 static qsocket_t *_Datagram_CheckNewConnections (void)
 {
 	struct qsockaddr clientaddr;
@@ -35,5 +35,17 @@ qboolean	Datagram_CanSendUnreliableMessage (qsocket_t *sock);
 void		Datagram_Close (qsocket_t *sock);
 void		Datagram_Shutdown (void);
 
+struct netlisten_s	*Datagram_OpenListen (int port);
+void		Datagram_SwapListen (struct netlisten_s *listen);
+void		Datagram_CloseListen (struct netlisten_s *listen);
+
+/* net_impair.c */
+void		Impair_Init (int driverlevel);
+int			Impair_Write (qsocket_t *sock, byte *data, int length, struct qsockaddr *addr);
+int			Impair_Read (qsocket_t *sock, byte *data, int length, struct qsockaddr *addr);
+void		Impair_Flush (qsocket_t *sock);
+void		Impair_Release (qsocket_t *sock);
+void		Impair_Report (void);
+
 #endif	/* __NET_DATAGRAM_H */
 
@@ -0,0 +1,422 @@
+/*
+Copyright (C) 1996-2001 Id Software, Inc.
+Copyright (C) 2010-2014 QuakeSpasm developers
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+// net_impair.c -- simulated bad network conditions for datagram connections
+
+#include "q_stdinc.h"
+#include "arch_def.h"
+#include "net_sys.h"
+#include "quakedef.h"
+#include "net_defs.h"
+#include "net_dgrm.h"
+
+/*
+==============================================================================
+
+Every packet a datagram qsocket writes or reads passes through Impair_Write
+and Impair_Read.  While impairment is off they go straight to the lan
+driver.  Otherwise packets are held in a per socket, per direction queue
+until their release time:
+
+  loss     percent of packets dropped outright
+  lag      one way delay in milliseconds
+  jitter   random +/- milliseconds added to the delay
+  reorder  percent of packets held back so later ones overtake them
+  rate     link speed in kilobytes per second, packets queue behind
+           each other while the link is busy (0 = unlimited)
+
+Without reorder the queue stays in send order even with jitter.  The
+net_fake* cvars give the settings for all connections; net_impair
+overrides them for single connections.  Random decisions come from a
+private generator seeded with net_fakeseed, so a run can be repeated.
+
+Queues are only serviced when the socket is, i.e. once per frame for
+every connection, so delays are rounded up to whole frames.
+
+==============================================================================
+*/
+
+#define sfunc	net_landrivers[sock->landriver]
+
+#define	IMPAIR_MAXQUEUED	512		// packets per direction before new ones are dropped
+#define	IMPAIR_MINREORDER	20.0	// milliseconds a reordered packet is held back at least
+
+static cvar_t	net_fakelag = {"net_fakelag", "0", CVAR_NONE};
+static cvar_t	net_fakejitter = {"net_fakejitter", "0", CVAR_NONE};
+static cvar_t	net_fakeloss = {"net_fakeloss", "0", CVAR_NONE};
+static cvar_t	net_fakereorder = {"net_fakereorder", "0", CVAR_NONE};
+static cvar_t	net_fakerate = {"net_fakerate", "0", CVAR_NONE};
+static cvar_t	net_fakeseed = {"net_fakeseed", "1", CVAR_NONE};
+
+typedef struct
+{
+	float		lag;
+	float		jitter;
+	float		loss;
+	float		reorder;
+	float		rate;
+} impairparms_t;
+
+typedef struct delayedpacket_s
+{
+	struct delayedpacket_s	*next;
+	double		release;
+	struct qsockaddr	addr;
+	int			length;
+	byte		data[4];	// variable sized
+} delayedpacket_t;
+
+typedef struct
+{
+	delayedpacket_t	*head;
+	int			count;
+	double		linkfree;		// when the link is done with the last packet
+	double		lastrelease;	// release time of the last in order packet
+} packetqueue_t;
+
+struct netimpair_s
+{
+	qboolean	custom;		// parms override the net_fake* cvars
+	impairparms_t	parms;
+	packetqueue_t	out;
+	packetqueue_t	in;
+};
+
+static unsigned int	impair_seed = 1;
+static int		impair_driverlevel;
+static byte		impair_buffer[NET_DATAGRAMSIZE];
+
+/* statistic counters */
+static int impairDelayed;
+static int impairDropped;
+static int impairReordered;
+
+static void Impair_Seed_f (cvar_t *var)
+{
+	impair_seed = (unsigned int) var->value;
+	if (!impair_seed)
+		impair_seed = 1;
+}
+
+/*
+====================
+Impair_Random
+
+xorshift32, returns 0 <= x < 1
+====================
+*/
+static float Impair_Random (void)
+{
+	impair_seed ^= impair_seed << 13;
+	impair_seed ^= impair_seed >> 17;
+	impair_seed ^= impair_seed << 5;
+	return (impair_seed >> 8) * (1.0f / 16777216.0f);
+}
+
+static void Impair_CvarParms (impairparms_t *p)
+{
+	p->lag = net_fakelag.value;
+	p->jitter = net_fakejitter.value;
+	p->loss = net_fakeloss.value;
+	p->reorder = net_fakereorder.value;
+	p->rate = net_fakerate.value;
+}
+
+/*
+====================
+Impair_GetParms
+
+Returns false if the packets of sock are not impaired at the moment.
+====================
+*/
+
+static qboolean Impair_GetParms (qsocket_t *sock, impairparms_t *p)
+{
+	if (sock->impair && sock->impair->custom)
+		*p = sock->impair->parms;
+	else
+		Impair_CvarParms (p);
+
+	return p->lag > 0 || p->jitter > 0 || p->loss > 0 || p->reorder > 0 || p->rate > 0;
+}
+
+static struct netimpair_s *Impair_State (qsocket_t *sock)
+{
+	if (!sock->impair)
+	{
+		sock->impair = (struct netimpair_s *) calloc (1, sizeof(struct netimpair_s));
+		if (!sock->impair)
+			Sys_Error ("Impair_State: out of memory");
+	}
+	return sock->impair;
+}
+
+/*
+====================
+Impair_Queue
+
+Decides the fate of one packet and files it by release time.
+====================
+*/
+static void Impair_Queue (packetqueue_t *q, const impairparms_t *p, const byte *data, int length, struct qsockaddr *addr)
+{
+	delayedpacket_t	*pkt, **link;
+	double		release;
+
+	if (p->loss > 0 && Impair_Random() * 100 < p->loss)
+	{
+		impairDropped++;
+		return;
+	}
+	if (q->count >= IMPAIR_MAXQUEUED)
+	{
+		impairDropped++;
+		return;
+	}
+
+	// serialize on the link first, then travel
+	release = q_max(net_time, q->linkfree);
+	if (p->rate > 0)
+		release += length / (p->rate * 1024.0);
+	q->linkfree = release;
+
+	release += p->lag * 0.001;
+	if (p->jitter > 0)
+		release += p->jitter * (Impair_Random() * 2 - 1) * 0.001;
+	if (release < net_time)
+		release = net_time;
+
+	if (p->reorder > 0 && Impair_Random() * 100 < p->reorder)
+	{
+		release += q_max(p->lag + p->jitter, IMPAIR_MINREORDER) * 0.001;
+		impairReordered++;
+	}
+	else
+	{
+		if (release < q->lastrelease)
+			release = q->lastrelease;
+		q->lastrelease = release;
+	}
+
+	pkt = (delayedpacket_t *) Pool_Alloc (sizeof(delayedpacket_t) + length);
+	pkt->release = release;
+	pkt->addr = *addr;
+	pkt->length = length;
+	memcpy (pkt->data, data, length);
+
+	for (link = &q->head; *link && (*link)->release <= release; link = &(*link)->next)
+		;
+	pkt->next = *link;
+	*link = pkt;
+	q->count++;
+	impairDelayed++;
+}
+
+static delayedpacket_t *Impair_Due (packetqueue_t *q)
+{
+	delayedpacket_t	*pkt;
+
+	pkt = q->head;
+	if (!pkt || pkt->release > net_time)
+		return NULL;
+	q->head = pkt->next;
+	q->count--;
+	return pkt;
+}
+
+static void Impair_ClearQueue (packetqueue_t *q)
+{
+	delayedpacket_t	*pkt;
+
+	while (q->head)
+	{
+		pkt = q->head;
+		q->head = pkt->next;
+		Pool_Free (pkt);
+	}
+	q->count = 0;
+}
+
+/*
+====================
+Impair_Flush
+
+Puts the outgoing packets that are due on the wire.
+====================
+*/
+void Impair_Flush (qsocket_t *sock)
+{
+	delayedpacket_t	*pkt;
+
+	if (!sock->impair)
+		return;
+
+	while ((pkt = Impair_Due (&sock->impair->out)) != NULL)
+	{
+		sfunc.Write (sock->socket, pkt->data, pkt->length, &pkt->addr);
+		Pool_Free (pkt);
+	}
+}
+
+int Impair_Write (qsocket_t *sock, byte *data, int length, struct qsockaddr *addr)
+{
+	impairparms_t	p;
+
+	if (!Impair_GetParms (sock, &p) && !(sock->impair && sock->impair->out.head))
+		return sfunc.Write (sock->socket, data, length, addr);
+
+	Impair_Queue (&Impair_State(sock)->out, &p, data, length, addr);
+	Impair_Flush (sock);
+	return length;
+}
+
+int Impair_Read (qsocket_t *sock, byte *data, int length, struct qsockaddr *addr)
+{
+	impairparms_t	p;
+	delayedpacket_t	*pkt;
+	int		ret;
+
+	if (!Impair_GetParms (sock, &p) && !(sock->impair && sock->impair->in.head))
+		return sfunc.Read (sock->socket, data, length, addr);
+
+	// take in everything that has arrived, then hand out what is due
+	while ((ret = sfunc.Read (sock->socket, impair_buffer, sizeof(impair_buffer), addr)) > 0)
+		Impair_Queue (&Impair_State(sock)->in, &p, impair_buffer, ret, addr);
+	if (ret == -1)
+		return -1;
+
+	if (!sock->impair || (pkt = Impair_Due (&sock->impair->in)) == NULL)
+		return 0;
+
+	ret = q_min(pkt->length, length);
+	memcpy (data, pkt->data, ret);
+	*addr = pkt->addr;
+	Pool_Free (pkt);
+	return ret;
+}
+
+/*
+====================
+Impair_Release
+
+Drops whatever is still queued when the socket closes.
+====================
+*/
+void Impair_Release (qsocket_t *sock)
+{
+	if (!sock->impair)
+		return;
+
+	Impair_ClearQueue (&sock->impair->out);
+	Impair_ClearQueue (&sock->impair->in);
+	free (sock->impair);
+	sock->impair = NULL;
+}
+
+void Impair_Report (void)
+{
+	Con_Printf("impairDelayed              = %i\n", impairDelayed);
+	Con_Printf("impairDropped              = %i\n", impairDropped);
+	Con_Printf("impairReordered            = %i\n", impairReordered);
+}
+
+static void Impair_PrintParms (const char *name, const impairparms_t *p)
+{
+	Con_Printf ("%-21s %5.0f %6.0f %4.1f%% %4.1f%% %6.1f\n", name, p->lag, p->jitter, p->loss, p->reorder, p->rate);
+}
+
+/*
+====================
+Impair_f
+
+net_impair [<address|all> [off | <lag> [jitter] [loss] [reorder] [rate]]]
+====================
+*/
+static void Impair_f (void)
+{
+	qsocket_t	*sock;
+	impairparms_t	p;
+	qboolean	all, found;
+
+	if (Cmd_Argc() < 3)
+	{
+		Con_Printf ("net_impair <address|all> off\n");
+		Con_Printf ("net_impair <address|all> <lag ms> [jitter ms] [loss %%] [reorder %%] [rate kB/s]\n\n");
+		Con_Printf ("address                 lag jitter  loss reorder rate\n");
+		Impair_CvarParms (&p);
+		Impair_PrintParms ("(net_fake* cvars)", &p);
+		for (sock = net_activeSockets; sock; sock = sock->next)
+		{
+			if (sock->impair && sock->impair->custom)
+				Impair_PrintParms (sock->address, &sock->impair->parms);
+		}
+		return;
+	}
+
+	memset (&p, 0, sizeof(p));
+	p.lag = Q_atof (Cmd_Argv(2));
+	if (Cmd_Argc() > 3)
+		p.jitter = Q_atof (Cmd_Argv(3));
+	if (Cmd_Argc() > 4)
+		p.loss = Q_atof (Cmd_Argv(4));
+	if (Cmd_Argc() > 5)
+		p.reorder = Q_atof (Cmd_Argv(5));
+	if (Cmd_Argc() > 6)
+		p.rate = Q_atof (Cmd_Argv(6));
+
+	all = !q_strcasecmp (Cmd_Argv(1), "all");
+	found = false;
+	for (sock = net_activeSockets; sock; sock = sock->next)
+	{
+		if (sock->driver != impair_driverlevel)
+			continue;
+		if (!all && q_strcasecmp (Cmd_Argv(1), sock->address))
+			continue;
+		found = true;
+
+		if (!q_strcasecmp (Cmd_Argv(2), "off"))
+		{
+			// queued packets still drain through the cvar settings
+			if (sock->impair)
+				sock->impair->custom = false;
+			continue;
+		}
+		Impair_State(sock)->custom = true;
+		sock->impair->parms = p;
+	}
+
+	if (!found)
+		Con_Printf ("net_impair: no connection to %s\n", Cmd_Argv(1));
+}
+
+void Impair_Init (int driverlevel)
+{
+	impair_driverlevel = driverlevel;
+
+	Cvar_RegisterVariable (&net_fakelag);
+	Cvar_RegisterVariable (&net_fakejitter);
+	Cvar_RegisterVariable (&net_fakeloss);
+	Cvar_RegisterVariable (&net_fakereorder);
+	Cvar_RegisterVariable (&net_fakerate);
+	Cvar_RegisterVariable (&net_fakeseed);
+	Cvar_SetCallback (&net_fakeseed, Impair_Seed_f);
+
+	Cmd_AddCommand ("net_impair", Impair_f);
+}
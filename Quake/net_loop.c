@@ -155,6 +155,15 @@ int Loop_GetMessage (qsocket_t *sock)
 }
 
 
+/* grows the peer's receive buffer so it can take another queued message */
+static byte *Loop_ReserveMessage (qsocket_t *peer, int length)
+{
+	peer->receiveMessage = (byte *) Pool_Realloc (peer->receiveMessage, peer->receiveMessageLength,
+							IntAlign(peer->receiveMessageLength + length + 4));
+	return peer->receiveMessage + peer->receiveMessageLength;
+}
+
+
 int Loop_SendMessage (qsocket_t *sock, sizebuf_t *data)
 {
 	byte *buffer;
@@ -168,7 +177,7 @@ int Loop_SendMessage (qsocket_t *sock, sizebuf_t *data)
 	if ((*bufferLength + data->cursize + 4) > NET_MAXMESSAGE)
 		Sys_Error("Loop_SendMessage: overflow");
 
-	buffer = ((qsocket_t *)sock->driverdata)->receiveMessage + *bufferLength;
+	buffer = Loop_ReserveMessage ((qsocket_t *)sock->driverdata, data->cursize);
 
 	// message type
 	*buffer++ = 1;
@@ -202,7 +211,7 @@ int Loop_SendUnreliableMessage (qsocket_t *sock, sizebuf_t *data)
 	if ((*bufferLength + data->cursize + sizeof(byte) + sizeof(short)) > NET_MAXMESSAGE)
 		return 0;
 
-	buffer = ((qsocket_t *)sock->driverdata)->receiveMessage + *bufferLength;
+	buffer = Loop_ReserveMessage ((qsocket_t *)sock->driverdata, data->cursize);
 
 	// message type
 	*buffer++ = 2;
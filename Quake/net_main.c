@@ -24,6 +24,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "net_sys.h"
 #include "quakedef.h"
 #include "net_defs.h"
+#include "net_dgrm.h"
 
 qsocket_t	*net_activeSockets = NULL;
 qsocket_t	*net_freeSockets = NULL;
@@ -32,7 +33,6 @@ int		net_numsockets = 0;
 qboolean	ipxAvailable = false;
 qboolean	tcpipAvailable = false;
 
-int		net_hostport;
 int		DEFAULTnet_hostport = 26000;
 
 char		my_ipx_address[NET_NAMELEN];
@@ -52,7 +52,6 @@ static PollProcedure	slistSendProcedure = {NULL, 0.0, Slist_Send};
 static PollProcedure	slistPollProcedure = {NULL, 0.0, Slist_Poll};
 
 sizebuf_t	net_message;
-int		net_activeconnections		= 0;
 
 int		messagesSent			= 0;
 int		messagesReceived		= 0;
@@ -147,6 +146,14 @@ void NET_FreeQSocket(qsocket_t *sock)
 			Sys_Error ("NET_FreeQSocket: not active");
 	}
 
+	// hand the message buffers back to the pool
+	Pool_Free (sock->sendMessage);
+	Pool_Free (sock->receiveMessage);
+	sock->sendMessage = NULL;
+	sock->receiveMessage = NULL;
+	sock->sendMessageLength = 0;
+	sock->receiveMessageLength = 0;
+
 	// add it to free list
 	sock->next = net_freeSockets;
 	net_freeSockets = sock;
@@ -492,6 +499,35 @@ JustDoIt:
 }
 
 
+/*
+===================
+NET_ConnectDirect
+
+Used by the bot clients, which connect many times in a row to a known
+address and can't afford a server list scan each time.
+===================
+*/
+qsocket_t *NET_ConnectDirect (const char *host)
+{
+	qsocket_t		*ret;
+
+	SetNetTime();
+
+	for (net_driverlevel = 0; net_driverlevel < net_numdrivers; net_driverlevel++)
+	{
+		if (net_drivers[net_driverlevel].initialized == false)
+			continue;
+		if (IS_LOOP_DRIVER(net_driverlevel))
+			continue;
+		ret = dfunc.Connect (host);
+		if (ret)
+			return ret;
+	}
+
+	return NULL;
+}
+
+
 /*
 ===================
 NET_CheckNewConnections
@@ -834,6 +870,54 @@ void NET_Init (void)
 	}
 }
 
+/*
+====================
+NET_OpenListen
+
+Opens accept sockets on another port for an additional server instance
+and makes room for its clients in the qsocket pool.  The extra qsockets
+are never released, the pool just keeps its high water mark.
+====================
+*/
+struct netlisten_s *NET_OpenListen (int port, int maxclients)
+{
+	struct netlisten_s	*listen;
+
+	listen = Datagram_OpenListen (port);
+	if (!listen)
+		return NULL;
+
+	NET_AddQSockets (maxclients);
+	return listen;
+}
+
+void NET_AddQSockets (int count)
+{
+	qsocket_t	*s;
+	int			i;
+
+	for (i = 0; i < count; i++)
+	{
+		s = (qsocket_t *) calloc (1, sizeof(qsocket_t));
+		if (!s)
+			Sys_Error ("NET_AddQSockets: out of memory");
+		s->next = net_freeSockets;
+		net_freeSockets = s;
+		s->disconnected = true;
+	}
+	net_numsockets += count;
+}
+
+void NET_SwapListen (struct netlisten_s *listen)
+{
+	Datagram_SwapListen (listen);
+}
+
+void NET_CloseListen (struct netlisten_s *listen)
+{
+	Datagram_CloseListen (listen);
+}
+
 /*
 ====================
 NET_Shutdown
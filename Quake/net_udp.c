@@ -128,6 +128,17 @@ void UDP_Listen (qboolean state)
 
 //=============================================================================
 
+sys_socket_t UDP_SetAcceptSocket (sys_socket_t socketid)
+{
+	sys_socket_t	old;
+
+	old = net_acceptsocket;
+	net_acceptsocket = socketid;
+	return old;
+}
+
+//=============================================================================
+
 sys_socket_t UDP_OpenSocket (int port)
 {
 	sys_socket_t newsocket;
@@ -150,7 +161,10 @@ sys_socket_t UDP_OpenSocket (int port)
 	address.sin_addr.s_addr = INADDR_ANY;
 	address.sin_port = htons((unsigned short)port);
 	if (bind (newsocket, (struct sockaddr *)&address, sizeof(address)) == 0)
+	{
+		Sys_WatchSocket (newsocket, true);
 		return newsocket;
+	}
 
 ErrorReturn:
 	err = SOCKETERRNO;
@@ -165,6 +179,7 @@ int UDP_CloseSocket (sys_socket_t socketid)
 {
 	if (socketid == net_broadcastsocket)
 		net_broadcastsocket = 0;
+	Sys_WatchSocket (socketid, false);
 	return closesocket (socketid);
 }
 
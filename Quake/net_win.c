@@ -27,6 +27,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "net_dgrm.h"
 #include "net_loop.h"
+#include "sv_replay.h"
 
 net_driver_t net_drivers[] =
 {
@@ -60,6 +61,22 @@ net_driver_t net_drivers[] =
 		Datagram_CanSendUnreliableMessage,
 		Datagram_Close,
 		Datagram_Shutdown
+	},
+
+	{	"Replay",
+		false,
+		Replay_Init,
+		Replay_Listen,
+		Replay_SearchForHosts,
+		Replay_Connect,
+		Replay_CheckNewConnections,
+		Replay_GetMessage,
+		Replay_SendMessage,
+		Replay_SendUnreliableMessage,
+		Replay_CanSendMessage,
+		Replay_CanSendUnreliableMessage,
+		Replay_Close,
+		Replay_Shutdown
 	}
 };
 
@@ -77,6 +94,7 @@ net_landriver_t	net_landrivers[] =
 		WINS_Init,
 		WINS_Shutdown,
 		WINS_Listen,
+		WINS_SetAcceptSocket,
 		WINS_OpenSocket,
 		WINS_CloseSocket,
 		WINS_Connect,
@@ -100,6 +118,7 @@ net_landriver_t	net_landrivers[] =
 		WIPX_Init,
 		WIPX_Shutdown,
 		WIPX_Listen,
+		WIPX_SetAcceptSocket,
 		WIPX_OpenSocket,
 		WIPX_CloseSocket,
 		WIPX_Connect,
@@ -210,6 +210,17 @@ void WINS_Listen (qboolean state)
 
 //=============================================================================
 
+sys_socket_t WINS_SetAcceptSocket (sys_socket_t socketid)
+{
+	sys_socket_t	old;
+
+	old = net_acceptsocket;
+	net_acceptsocket = socketid;
+	return old;
+}
+
+//=============================================================================
+
 sys_socket_t WINS_OpenSocket (int port)
 {
 	sys_socket_t newsocket;
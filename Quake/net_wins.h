@@ -25,6 +25,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 sys_socket_t  WINS_Init (void);
 void WINS_Shutdown (void);
 void WINS_Listen (qboolean state);
+sys_socket_t WINS_SetAcceptSocket (sys_socket_t socketid);
 sys_socket_t  WINS_OpenSocket (int port);
 int  WINS_CloseSocket (sys_socket_t socketid);
 int  WINS_Connect (sys_socket_t socketid, struct qsockaddr *addr);
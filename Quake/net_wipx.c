@@ -141,6 +141,17 @@ void WIPX_Listen (qboolean state)
 
 //=============================================================================
 
+sys_socket_t WIPX_SetAcceptSocket (sys_socket_t socketid)
+{
+	sys_socket_t	old;
+
+	old = net_acceptsocket;
+	net_acceptsocket = socketid;
+	return old;
+}
+
+//=============================================================================
+
 sys_socket_t WIPX_OpenSocket (int port)
 {
 	int	err;
@@ -729,7 +729,8 @@ static void PF_checkpos (void)
 
 //============================================================================
 
-static byte	checkpvs[MAX_MAP_LEAFS/8];
+// kept between frames like sv.lastcheck, so it belongs to a server instance
+#define	checkpvs	(sv_context->checkclientpvs)
 
 static int PF_newcheckclient (int check)
 {
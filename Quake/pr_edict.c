@@ -28,21 +28,23 @@ dfunction_t		*pr_functions;
 
 static	char		*pr_strings;
 static	int		pr_stringssize;
-static	const char	**pr_knownstrings;
-static	int		pr_maxknownstrings;
-static	int		pr_numknownstrings;
+// the engine strings belong to a server instance, see svcontext_t
+#define	pr_knownstrings		(sv_context->knownstrings)
+#define	pr_maxknownstrings	(sv_context->maxknownstrings)
+#define	pr_numknownstrings	(sv_context->numknownstrings)
+#define	pr_allocstrings		(sv_context->allocstrings)	// blocks of PR_AllocString, each starts with a link to the next
 static	ddef_t		*pr_fielddefs;
 static	ddef_t		*pr_globaldefs;
 
 qboolean	pr_alpha_supported; //johnfitz
 
 dstatement_t	*pr_statements;
-globalvars_t	*pr_global_struct;
-float		*pr_globals;		// same as pr_global_struct
 int		pr_edict_size;		// in bytes
 
 unsigned short	pr_crc;
 
+static	dprograms_t	*pr_image;	// progs.dat as loaded, shared by all server instances
+
 int		type_size[8] = {
 	1,					// ev_void
 	1,	// sizeof(string_t) / 4		// ev_string
@@ -1028,14 +1030,64 @@ void ED_LoadFromFile (const char *data)
 }
 
 
+/*
+===============
+PR_FreeStrings
+
+The strings of PR_AllocString are not on the hunk, other server instances
+may keep it from being cleared between maps
+===============
+*/
+static void PR_FreeStrings (void)
+{
+	void	*next;
+
+	while (pr_allocstrings)
+	{
+		next = *(void **)pr_allocstrings;
+		free (pr_allocstrings);
+		pr_allocstrings = next;
+	}
+}
+
 /*
 ===============
 PR_LoadProgs
 ===============
 */
+static void PR_InitGlobals (void)
+{
+	// initialize the strings
+	PR_FreeStrings ();
+	pr_numknownstrings = 0;
+	pr_maxknownstrings = 0;
+	if (pr_knownstrings)
+		Z_Free ((void *)pr_knownstrings);
+	pr_knownstrings = NULL;
+	PR_SetEngineString("");
+
+	// every server instance works on its own copy of the globals, the
+	// image keeps the initial values
+	free (pr_globals);
+	pr_globals = (float *) malloc (progs->numglobals * 4);
+	if (!pr_globals)
+		Sys_Error ("PR_LoadProgs: couldn't allocate %i globals", progs->numglobals);
+	memcpy (pr_globals, (byte *)progs + progs->ofs_globals, progs->numglobals * 4);
+	pr_global_struct = (globalvars_t *)pr_globals;
+}
+
 void PR_LoadProgs (void)
 {
 	int			i;
+	int			*globals;
+
+	// while additional server instances run the hunk is never cleared,
+	// so everyone keeps using the image that is already loaded
+	if (pr_image && SV_NumInstances ())
+	{
+		PR_InitGlobals ();
+		return;
+	}
 
 	// flush the non-C variable lookup cache
 	for (i = 0; i < GEFV_CACHESIZE; i++)
@@ -1065,22 +1117,12 @@ void PR_LoadProgs (void)
 	if (progs->ofs_strings + progs->numstrings >= com_filesize)
 		Host_Error ("progs.dat strings go past end of file\n");
 
-	// initialize the strings
-	pr_numknownstrings = 0;
-	pr_maxknownstrings = 0;
 	pr_stringssize = progs->numstrings;
-	if (pr_knownstrings)
-		Z_Free ((void *)pr_knownstrings);
-	pr_knownstrings = NULL;
-	PR_SetEngineString("");
 
 	pr_globaldefs = (ddef_t *)((byte *)progs + progs->ofs_globaldefs);
 	pr_fielddefs = (ddef_t *)((byte *)progs + progs->ofs_fielddefs);
 	pr_statements = (dstatement_t *)((byte *)progs + progs->ofs_statements);
 
-	pr_global_struct = (globalvars_t *)((byte *)progs + progs->ofs_globals);
-	pr_globals = (float *)pr_global_struct;
-
 	// byte swap the lumps
 	for (i = 0; i < progs->numstatements; i++)
 	{
@@ -1123,8 +1165,9 @@ void PR_LoadProgs (void)
 		//johnfitz
 	}
 
+	globals = (int *)((byte *)progs + progs->ofs_globals);
 	for (i = 0; i < progs->numglobals; i++)
-		((int *)pr_globals)[i] = LittleLong (((int *)pr_globals)[i]);
+		globals[i] = LittleLong (globals[i]);
 
 	pr_edict_size = progs->entityfields * 4 + sizeof(edict_t) - sizeof(entvars_t);
 	// round off to next highest whole word address (esp for Alpha)
@@ -1132,6 +1175,30 @@ void PR_LoadProgs (void)
 	// properly aligned
 	pr_edict_size += sizeof(void *) - 1;
 	pr_edict_size &= ~(sizeof(void *) - 1);
+
+	pr_image = progs;
+	PR_InitGlobals ();
+}
+
+/*
+===============
+PR_ReleaseProgs
+
+Frees the strings and globals of the active server instance
+===============
+*/
+void PR_ReleaseProgs (void)
+{
+	PR_FreeStrings ();
+	if (pr_knownstrings)
+		Z_Free ((void *)pr_knownstrings);
+	pr_knownstrings = NULL;
+	pr_numknownstrings = 0;
+	pr_maxknownstrings = 0;
+
+	free (pr_globals);
+	pr_globals = NULL;
+	pr_global_struct = NULL;
 }
 
 
@@ -1251,6 +1318,7 @@ int PR_SetEngineString (const char *s)
 int PR_AllocString (int size, char **ptr)
 {
 	int		i;
+	void	**block;
 
 	if (!size)
 		return 0;
@@ -1265,7 +1333,12 @@ int PR_AllocString (int size, char **ptr)
 			PR_AllocStringSlots();
 		pr_numknownstrings++;
 //	}
-	pr_knownstrings[i] = (char *)Hunk_AllocName(size, "string");
+	block = (void **) calloc (1, sizeof(void *) + size);
+	if (!block)
+		Sys_Error ("PR_AllocString: out of memory");
+	*block = pr_allocstrings;
+	pr_allocstrings = block;
+	pr_knownstrings[i] = (char *)(block + 1);
 	if (ptr)
 		*ptr = (char *) pr_knownstrings[i];
 	return -1 - i;
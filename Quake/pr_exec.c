@@ -369,6 +369,8 @@ void PR_ExecuteProgram (func_t fnum)
 		Host_Error ("PR_ExecuteProgram: NULL function");
 	}
 
+	PROF_BEGIN ("PR_ExecuteProgram");
+
 	f = &pr_functions[fnum];
 
 	pr_trace = false;
@@ -631,6 +633,8 @@ void PR_ExecuteProgram (func_t fnum)
 		st = &pr_statements[PR_LeaveFunction()];
 		if (pr_depth == exitdepth)
 		{ // Done
+			COUNT (CNT_QCINSTRUCTIONS, profile);
+			PROF_END ();
 			return;
 		}
 		break;
@@ -0,0 +1,348 @@
+/*
+Copyright (C) 1996-2001 Id Software, Inc.
+Copyright (C) 2002-2009 John Fitzgibbons and others
+Copyright (C) 2010-2014 QuakeSpasm developers
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+// prof.c -- zone profiler with Chrome trace export
+
+#include "quakedef.h"
+
+#ifdef USE_PROFILER
+
+/*
+==============================================================================
+
+Each thread that enters a zone during a capture gets its own ring of
+finished zones, so recording takes no locks.  A capture covers a number
+of whole host frames; when it ends the rings are written out as Chrome
+trace-event JSON (load it in chrome://tracing or ui.perfetto.dev).
+
+A zone still open when Host_Error unwinds the frame is dropped at the
+start of the next one.
+
+==============================================================================
+*/
+
+#define	PROF_RINGSIZE	(1 << 16)	// zones kept per thread, the oldest are overwritten
+#define	PROF_MAXDEPTH	32
+#define	PROF_MAXTHREADS	32
+
+typedef struct
+{
+	const char	*name;
+	Uint64		start, end;
+} profzone_t;
+
+typedef struct
+{
+	int			id;
+	SDL_threadID	threadid;
+	int			generation;		// capture the ring belongs to
+	int			depth;
+	struct
+	{
+		const char	*name;
+		Uint64		start;
+	} stack[PROF_MAXDEPTH];
+	unsigned int	numzones;
+	profzone_t	zones[PROF_RINGSIZE];
+} profthread_t;
+
+qboolean	prof_active;
+
+static SDL_TLSID	prof_tls;
+static SDL_mutex	*prof_lock;
+static SDL_threadID	prof_mainthread;
+static profthread_t	*prof_threads[PROF_MAXTHREADS];
+static int			prof_numthreads;
+
+static int		prof_generation;
+static qboolean	prof_pending;
+static int		prof_frames, prof_framesleft;
+static Uint64	prof_starttime;
+static char		prof_filename[MAX_OSPATH];
+
+static profthread_t *Prof_Thread (void)
+{
+	profthread_t	*t;
+
+	t = (profthread_t *) SDL_TLSGet (prof_tls);
+	if (!t)
+	{
+		SDL_LockMutex (prof_lock);
+		if (prof_numthreads < PROF_MAXTHREADS)
+			t = (profthread_t *) calloc (1, sizeof(profthread_t));
+		if (t)
+		{
+			t->id = prof_numthreads;
+			t->threadid = SDL_ThreadID ();
+			t->generation = -1;
+			prof_threads[prof_numthreads++] = t;
+		}
+		SDL_UnlockMutex (prof_lock);
+		if (!t)
+			return NULL;	// out of slots, this thread goes unrecorded
+		SDL_TLSSet (prof_tls, t, NULL);
+	}
+
+	if (t->generation != prof_generation)
+	{
+		t->generation = prof_generation;
+		t->depth = 0;
+		t->numzones = 0;
+	}
+	return t;
+}
+
+void Prof_Begin (const char *name)
+{
+	profthread_t	*t;
+
+	t = Prof_Thread ();
+	if (!t)
+		return;
+	if (t->depth < PROF_MAXDEPTH)
+	{
+		t->stack[t->depth].name = name;
+		t->stack[t->depth].start = SDL_GetPerformanceCounter ();
+	}
+	t->depth++;
+}
+
+void Prof_End (void)
+{
+	profthread_t	*t;
+	profzone_t		*z;
+
+	t = Prof_Thread ();
+	if (!t || !t->depth)
+		return;	// the zone began before the capture did
+	if (--t->depth >= PROF_MAXDEPTH)
+		return;
+
+	z = &t->zones[t->numzones & (PROF_RINGSIZE - 1)];
+	z->name = t->stack[t->depth].name;
+	z->start = t->stack[t->depth].start;
+	z->end = SDL_GetPerformanceCounter ();
+	SDL_MemoryBarrierRelease ();
+	t->numzones++;
+}
+
+static void Prof_WriteTrace (void)
+{
+	profthread_t	*t;
+	profzone_t		*z;
+	FILE		*f;
+	double		scale;
+	unsigned int	i, first, count;
+	int			n, numthreads, total;
+
+	f = fopen (prof_filename, "w");
+	if (!f)
+	{
+		Con_Printf ("ERROR: couldn't open %s\n", prof_filename);
+		return;
+	}
+
+	SDL_LockMutex (prof_lock);
+	numthreads = prof_numthreads;
+	SDL_UnlockMutex (prof_lock);
+
+	scale = 1000000.0 / SDL_GetPerformanceFrequency ();
+	total = 0;
+
+	fprintf (f, "{\"traceEvents\":[\n");
+	fprintf (f, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"vkQuake\"}}");
+	for (n = 0; n < numthreads; n++)
+	{
+		t = prof_threads[n];
+		if (t->generation != prof_generation)
+			continue;
+
+		if (t->threadid == prof_mainthread)
+			fprintf (f, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%i,\"args\":{\"name\":\"main\"}}", t->id);
+		else
+			fprintf (f, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%i,\"args\":{\"name\":\"thread %i\"}}", t->id, t->id);
+
+	// once the ring has wrapped, leave some slack for a thread still writing
+		count = t->numzones;
+		SDL_MemoryBarrierAcquire ();
+		first = (count > PROF_RINGSIZE) ? count - PROF_RINGSIZE + 16 : 0;
+		for (i = first; i < count; i++)
+		{
+			z = &t->zones[i & (PROF_RINGSIZE - 1)];
+			if (z->start < prof_starttime)
+				continue;
+			fprintf (f, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%i}",
+					z->name, (z->start - prof_starttime) * scale, (z->end - z->start) * scale, t->id);
+			total++;
+		}
+	}
+	fprintf (f, "\n],\"displayTimeUnit\":\"ms\"}\n");
+	fclose (f);
+
+	Con_Printf ("Wrote %i zones from %i frames to %s\n", total, prof_frames, prof_filename);
+}
+
+/*
+==================
+Prof_BeginFrame / Prof_EndFrame
+
+Called by Host_Frame around each frame, captures start and end here
+==================
+*/
+void Prof_BeginFrame (void)
+{
+	profthread_t	*t;
+
+	if (prof_pending)
+	{
+		prof_pending = false;
+		prof_generation++;
+		prof_framesleft = prof_frames;
+		prof_starttime = SDL_GetPerformanceCounter ();
+		prof_active = true;
+	}
+
+	if (prof_active && (t = Prof_Thread ()) != NULL)
+		t->depth = 0;
+}
+
+void Prof_EndFrame (void)
+{
+	if (!prof_active || --prof_framesleft > 0)
+		return;
+
+	prof_active = false;
+	Prof_WriteTrace ();
+}
+
+/*
+==================
+Prof_Capture_f
+
+prof_capture [frames] [file]
+==================
+*/
+static void Prof_Capture_f (void)
+{
+	const char	*name;
+
+	if (prof_active || prof_pending)
+	{
+		Con_Printf ("A capture is already running\n");
+		return;
+	}
+
+	prof_frames = (Cmd_Argc() > 1) ? Q_atoi (Cmd_Argv(1)) : 100;
+	if (prof_frames < 1)
+	{
+		Con_Printf ("prof_capture [frames] [file] : write a Chrome trace of the next frames\n");
+		return;
+	}
+	prof_frames = q_min (prof_frames, 10000);
+
+	name = (Cmd_Argc() > 2) ? Cmd_Argv(2) : "trace";
+	q_snprintf (prof_filename, sizeof(prof_filename), "%s/%s", com_gamedir, name);
+	COM_AddExtension (prof_filename, ".json", sizeof(prof_filename));
+
+	prof_pending = true;
+	Con_Printf ("Capturing %i frames\n", prof_frames);
+}
+
+void Prof_Init (void)
+{
+	prof_tls = SDL_TLSCreate ();
+	prof_lock = SDL_CreateMutex ();
+	if (!prof_tls || !prof_lock)
+		Sys_Error ("Prof_Init: %s", SDL_GetError ());
+	prof_mainthread = SDL_ThreadID ();
+
+	Cmd_AddCommand ("prof_capture", Prof_Capture_f);
+}
+
+#else	/* !USE_PROFILER */
+
+static void Prof_Capture_f (void)
+{
+	Con_Printf ("prof_capture: built without USE_PROFILER\n");
+}
+
+void Prof_Init (void)
+{
+	Cmd_AddCommand ("prof_capture", Prof_Capture_f);
+}
+
+#endif	/* USE_PROFILER */
+
+/*
+==============================================================================
+
+FRAME COUNTERS
+
+Only the main thread counts, the totals are plain ints.  Network traffic
+is taken from the NET_GetStats totals rather than counted at the sockets.
+
+==============================================================================
+*/
+
+int			prof_counters[NUM_COUNTERS];
+int			prof_history[NUM_COUNTERS][COUNTER_HISTORY];
+int			prof_historyframe;
+
+const char	*prof_countername[NUM_COUNTERS] =
+{
+	"draws",
+	"tris",
+	"pipelines",
+	"descsets",
+	"staging",
+	"lightmaps",
+	"traces",
+	"qc ops",
+	"net in",
+	"net out",
+};
+
+/*
+==================
+Prof_CountFrame
+
+Called at the end of every host frame that ran.
+==================
+*/
+void Prof_CountFrame (void)
+{
+	static netstats_t	laststats;
+	netstats_t	stats;
+	int		i, slot;
+
+	NET_GetStats (&stats);
+	prof_counters[CNT_NETBYTESIN] = stats.bytesreceived - laststats.bytesreceived;
+	prof_counters[CNT_NETBYTESOUT] = stats.bytessent - laststats.bytessent;
+	laststats = stats;
+
+	slot = prof_historyframe & (COUNTER_HISTORY - 1);
+	for (i = 0; i < NUM_COUNTERS; i++)
+	{
+		prof_history[i][slot] = prof_counters[i];
+		prof_counters[i] = 0;
+	}
+	prof_historyframe++;
+}
@@ -0,0 +1,87 @@
+/*
+Copyright (C) 1996-2001 Id Software, Inc.
+Copyright (C) 2002-2009 John Fitzgibbons and others
+Copyright (C) 2010-2014 QuakeSpasm developers
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#ifndef _QUAKE_PROF_H
+#define _QUAKE_PROF_H
+
+// prof.h -- zone profiler and frame counters
+
+// Zones are marked with PROF_BEGIN ("name") / PROF_END () pairs, the name
+// must be a string literal.  Outside of a prof_capture they cost one test
+// of prof_active, and building without USE_PROFILER removes them.
+
+void Prof_Init (void);
+
+#ifdef USE_PROFILER
+
+extern qboolean	prof_active;
+
+void Prof_Begin (const char *name);
+void Prof_End (void);
+void Prof_BeginFrame (void);
+void Prof_EndFrame (void);
+
+#define PROF_BEGIN(name)	do { if (prof_active) Prof_Begin (name); } while (0)
+#define PROF_END()			do { if (prof_active) Prof_End (); } while (0)
+#define PROF_FRAME_BEGIN()	Prof_BeginFrame ()
+#define PROF_FRAME_END()	Prof_EndFrame ()
+
+#else
+
+#define PROF_BEGIN(name)	((void)0)
+#define PROF_END()			((void)0)
+#define PROF_FRAME_BEGIN()	((void)0)
+#define PROF_FRAME_END()	((void)0)
+
+#endif
+
+// Frame counters are always built in.  COUNT adds to the current frame,
+// Prof_CountFrame moves the totals into prof_history at the end of every
+// host frame, and scr_counters graphs the history.
+
+typedef enum
+{
+	CNT_DRAWCALLS,
+	CNT_TRIANGLES,
+	CNT_PIPELINEBINDS,
+	CNT_DESCRIPTORSETS,	// vkCmdBindDescriptorSets calls
+	CNT_STAGINGBYTES,
+	CNT_LIGHTMAPS,		// surface lightmaps rebuilt
+	CNT_TRACES,
+	CNT_QCINSTRUCTIONS,
+	CNT_NETBYTESIN,
+	CNT_NETBYTESOUT,
+	NUM_COUNTERS
+} counter_t;
+
+#define	COUNTER_HISTORY	128		// frames kept, a power of two
+
+extern int			prof_counters[NUM_COUNTERS];
+extern int			prof_history[NUM_COUNTERS][COUNTER_HISTORY];
+extern int			prof_historyframe;		// frames moved into the history so far
+extern const char	*prof_countername[NUM_COUNTERS];
+
+#define COUNT(c, n)	(prof_counters[c] += (n))
+
+void Prof_CountFrame (void);
+
+#endif	/* _QUAKE_PROF_H */
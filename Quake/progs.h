@@ -62,8 +62,7 @@ typedef struct edict_s
 extern	dprograms_t	*progs;
 extern	dfunction_t	*pr_functions;
 extern	dstatement_t	*pr_statements;
-extern	globalvars_t	*pr_global_struct;
-extern	float		*pr_globals;	/* same as pr_global_struct */
+/* pr_global_struct and pr_globals belong to a server instance, see server.h */
 
 extern	int		pr_edict_size;	/* in bytes */
 
@@ -72,6 +71,7 @@ void PR_Init (void);
 
 void PR_ExecuteProgram (func_t fnum);
 void PR_LoadProgs (void);
+void PR_ReleaseProgs (void);
 
 const char *PR_GetString (int num);
 int PR_SetEngineString (const char *s);
@@ -180,7 +180,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 //===========================================
 
-#define	MAX_SCOREBOARD		16
+#define	MAX_SCOREBOARD		255	// player slots are sent as a byte in svc_update*, so this is the hard cap
 #define	MAX_SCOREBOARDNAME	32
 
 #define	SOUND_CHANNELS		8
@@ -205,6 +205,7 @@ typedef struct
 #include "bspfile.h"
 #include "sys.h"
 #include "zone.h"
+#include "prof.h"
 #include "mathlib.h"
 #include "cvar.h"
 
@@ -273,6 +274,7 @@ extern	quakeparms_t *host_parms;
 
 extern	cvar_t		sys_ticrate;
 extern	cvar_t		sys_throttle;
+extern	cvar_t		host_pacing;
 extern	cvar_t		sys_nostdout;
 extern	cvar_t		developer;
 extern	cvar_t		max_edicts; //johnfitz
@@ -293,6 +295,8 @@ void Host_Callback_Notify (cvar_t *var);	/* callback function for CVAR_NOTIFY */
 void Host_Error (const char *error, ...) __attribute__((__format__(__printf__,1,2), __noreturn__));
 void Host_EndGame (const char *message, ...) __attribute__((__format__(__printf__,1,2), __noreturn__));
 void Host_Frame (float time);
+void Host_WaitFrame (void);
+void Host_DedicatedLoop (void) __attribute__((__noreturn__));
 void Host_Quit_f (void);
 void Host_ClientCommands (const char *fmt, ...) __attribute__((__format__(__printf__,1,2)));
 void Host_ShutdownServer (qboolean crash);
@@ -304,11 +308,8 @@ void DemoList_Init (void);
 
 void DemoList_Rebuild (void);
 
-extern int		current_skill;	// skill level for currently loaded level (in case
-					//  the user changes the cvar while the level is
-					//  running, this reflects the level actually in use)
-
 extern qboolean		isDedicated;
+extern qboolean		isHeadless;	// client without a window or a Vulkan device, for benchmarks
 
 extern int		minimum_memory;
 
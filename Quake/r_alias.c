@@ -26,6 +26,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "quakedef.h"
 
 extern cvar_t r_drawflat, gl_fullbrights, r_lerpmodels, r_lerpmove; //johnfitz
+extern cvar_t r_instancing;
 
 //up to 16 color translated skins
 gltexture_t *playertextures[MAX_SCOREBOARD]; //johnfitz -- changed to an array of pointers
@@ -73,6 +74,26 @@ typedef struct {
 	unsigned int use_fullbright;
 } aliasubo_t;
 
+// per-instance vertex stream of the instanced alias pipeline
+typedef struct {
+	float model_matrix[16];
+	float shade_vector_blend[4];
+	float light_color[4];
+} aliasinstance_t;
+
+// entities sharing model, skins and pose pair are drawn with one call
+typedef struct {
+	qmodel_t		*model;
+	aliashdr_t		*paliashdr;
+	gltexture_t		*tx, *fb;
+	short			pose1, pose2;
+	aliasinstance_t	instance;
+} aliasbatchitem_t;
+
+static aliasbatchitem_t	alias_batch[MAX_VISEDICTS];
+static int				alias_batch_count;
+static qboolean			alias_batching;
+
 /*
 =============
 GLARB_GetXYZOffset
@@ -81,11 +102,11 @@ Returns the offset of the first vertex's meshxyz_t.xyz in the vbo for the given
 model and pose.
 =============
 */
-static VkDeviceSize GLARB_GetXYZOffset (aliashdr_t *hdr, int pose)
+static VkDeviceSize GLARB_GetXYZOffset (qmodel_t *model, aliashdr_t *hdr, int pose)
 {
 	meshxyz_t dummy;
 	int xyzoffs = ((char*)&dummy.xyz - (char*)&dummy);
-	return currententity->model->vboxyzofs + (hdr->numverts_vbo * pose * sizeof (meshxyz_t)) + xyzoffs;
+	return model->vboxyzofs + (hdr->numverts_vbo * pose * sizeof (meshxyz_t)) + xyzoffs;
 }
 
 /*
@@ -115,6 +136,7 @@ void GL_DrawAliasFrame (aliashdr_t *paliashdr, lerpdata_t lerpdata, gltexture_t
 	}
 
 	vkCmdBindPipeline(vulkan_globals.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkan_globals.alias_pipeline);
+	COUNT (CNT_PIPELINEBINDS, 1);
 
 	VkBuffer uniform_buffer;
 	uint32_t uniform_offset;
@@ -130,13 +152,16 @@ void GL_DrawAliasFrame (aliashdr_t *paliashdr, lerpdata_t lerpdata, gltexture_t
 	VkDescriptorSet descriptor_sets[3] = { tx->descriptor_set, (fb != NULL) ? fb->descriptor_set : tx->descriptor_set, ubo_set };
 	vkCmdBindDescriptorSets(vulkan_globals.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkan_globals.alias_pipeline_layout, 0, 1, tx->sampler_set, 0, NULL);
 	vkCmdBindDescriptorSets(vulkan_globals.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkan_globals.alias_pipeline_layout, 1, 3, descriptor_sets, 1, &uniform_offset);
+	COUNT (CNT_DESCRIPTORSETS, 2);
 
 	VkBuffer vertex_buffers[3] = { currententity->model->vertex_buffer, currententity->model->vertex_buffer, currententity->model->vertex_buffer };
-	VkDeviceSize vertex_offsets[3] = { currententity->model->vbostofs, GLARB_GetXYZOffset (paliashdr, lerpdata.pose1), GLARB_GetXYZOffset (paliashdr, lerpdata.pose2) };
+	VkDeviceSize vertex_offsets[3] = { currententity->model->vbostofs, GLARB_GetXYZOffset (currententity->model, paliashdr, lerpdata.pose1), GLARB_GetXYZOffset (currententity->model, paliashdr, lerpdata.pose2) };
 	vkCmdBindVertexBuffers(vulkan_globals.command_buffer, 0, 3, vertex_buffers, vertex_offsets);
 	vkCmdBindIndexBuffer(vulkan_globals.command_buffer, currententity->model->index_buffer, 0, VK_INDEX_TYPE_UINT16);
 
 	vkCmdDrawIndexed(vulkan_globals.command_buffer, paliashdr->numindexes, 1, 0, 0, 0);
+	COUNT (CNT_DRAWCALLS, 1);
+	COUNT (CNT_TRIANGLES, paliashdr->numindexes / 3);
 
 	/*GL_UseProgramFunc (r_alias_program);
 
@@ -191,6 +216,126 @@ void GL_DrawAliasFrame (aliashdr_t *paliashdr, lerpdata_t lerpdata, gltexture_t
 	rs_aliaspasses += paliashdr->numtris;
 }
 
+/*
+=============
+R_BeginAliasBatch
+
+Until R_FlushAliasBatch, R_DrawAliasModel queues opaque models instead
+of drawing them one by one.
+=============
+*/
+void R_BeginAliasBatch (void)
+{
+	alias_batching = r_instancing.value != 0;
+	alias_batch_count = 0;
+}
+
+/*
+=============
+GL_BatchAliasFrame
+=============
+*/
+static void GL_BatchAliasFrame (aliashdr_t *paliashdr, lerpdata_t lerpdata, gltexture_t *tx, gltexture_t *fb, float model_matrix[16])
+{
+	aliasbatchitem_t *item = &alias_batch[alias_batch_count++];
+
+	item->model = currententity->model;
+	item->paliashdr = paliashdr;
+	item->tx = tx;
+	item->fb = fb;
+	// the poses are picked with vertex buffer offsets, so a pose pair is
+	// part of the batch key rather than per-instance data
+	item->pose1 = lerpdata.pose1;
+	item->pose2 = lerpdata.pose2;
+
+	memcpy(item->instance.model_matrix, model_matrix, 16 * sizeof(float));
+	VectorCopy (shadevector, item->instance.shade_vector_blend);
+	item->instance.shade_vector_blend[3] = (lerpdata.pose1 != lerpdata.pose2) ? lerpdata.blend : 0;
+	VectorCopy (lightcolor, item->instance.light_color);
+	item->instance.light_color[3] = entalpha;
+}
+
+static int R_AliasBatchCompare (const void *a, const void *b)
+{
+	const aliasbatchitem_t *ia = (const aliasbatchitem_t *)a;
+	const aliasbatchitem_t *ib = (const aliasbatchitem_t *)b;
+
+	if (ia->model != ib->model)
+		return (uintptr_t)ia->model < (uintptr_t)ib->model ? -1 : 1;
+	if (ia->tx != ib->tx)
+		return (uintptr_t)ia->tx < (uintptr_t)ib->tx ? -1 : 1;
+	if (ia->fb != ib->fb)
+		return (uintptr_t)ia->fb < (uintptr_t)ib->fb ? -1 : 1;
+	if (ia->pose1 != ib->pose1)
+		return ia->pose1 - ib->pose1;
+	return ia->pose2 - ib->pose2;
+}
+
+/*
+=============
+R_FlushAliasBatch
+
+Sorts the queued models and draws each run with the same model, skins
+and poses as a single instanced draw.
+=============
+*/
+void R_FlushAliasBatch (void)
+{
+	int		first, count, i;
+
+	alias_batching = false;
+	if (!alias_batch_count)
+		return;
+
+	qsort (alias_batch, alias_batch_count, sizeof(aliasbatchitem_t), R_AliasBatchCompare);
+
+	vkCmdBindPipeline(vulkan_globals.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkan_globals.alias_instanced_pipeline);
+	COUNT (CNT_PIPELINEBINDS, 1);
+
+	for (first = 0; first < alias_batch_count; first += count)
+	{
+		aliasbatchitem_t *item = &alias_batch[first];
+		aliashdr_t *paliashdr = item->paliashdr;
+		qmodel_t *model = item->model;
+
+		for (count = 1; first + count < alias_batch_count; ++count)
+			if (R_AliasBatchCompare (item, &alias_batch[first + count]))
+				break;
+
+		VkBuffer instance_buffer;
+		VkDeviceSize instance_offset;
+		aliasinstance_t * instances = (aliasinstance_t*)R_VertexAllocate(count * sizeof(aliasinstance_t), &instance_buffer, &instance_offset);
+		for (i = 0; i < count; ++i)
+			memcpy(&instances[i], &item[i].instance, sizeof(aliasinstance_t));
+
+		// the fragment shader still reads use_fullbright from the UBO
+		VkBuffer uniform_buffer;
+		uint32_t uniform_offset;
+		VkDescriptorSet ubo_set;
+		aliasubo_t * ubo = (aliasubo_t*)R_UniformAllocate(sizeof(aliasubo_t), &uniform_buffer, &uniform_offset, &ubo_set);
+		memset(ubo, 0, sizeof(aliasubo_t));
+		ubo->use_fullbright = (item->fb != NULL) ? 1 : 0;
+
+		VkDescriptorSet descriptor_sets[3] = { item->tx->descriptor_set, (item->fb != NULL) ? item->fb->descriptor_set : item->tx->descriptor_set, ubo_set };
+		vkCmdBindDescriptorSets(vulkan_globals.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkan_globals.alias_pipeline_layout, 0, 1, item->tx->sampler_set, 0, NULL);
+		vkCmdBindDescriptorSets(vulkan_globals.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkan_globals.alias_pipeline_layout, 1, 3, descriptor_sets, 1, &uniform_offset);
+		COUNT (CNT_DESCRIPTORSETS, 2);
+
+		VkBuffer vertex_buffers[4] = { model->vertex_buffer, model->vertex_buffer, model->vertex_buffer, instance_buffer };
+		VkDeviceSize vertex_offsets[4] = { model->vbostofs, GLARB_GetXYZOffset (model, paliashdr, item->pose1), GLARB_GetXYZOffset (model, paliashdr, item->pose2), instance_offset };
+		vkCmdBindVertexBuffers(vulkan_globals.command_buffer, 0, 4, vertex_buffers, vertex_offsets);
+		vkCmdBindIndexBuffer(vulkan_globals.command_buffer, model->index_buffer, 0, VK_INDEX_TYPE_UINT16);
+
+		vkCmdDrawIndexed(vulkan_globals.command_buffer, paliashdr->numindexes, count, 0, 0, 0);
+		COUNT (CNT_DRAWCALLS, 1);
+		COUNT (CNT_TRIANGLES, (paliashdr->numindexes / 3) * count);
+
+		rs_aliaspasses += paliashdr->numtris * count;
+	}
+
+	alias_batch_count = 0;
+}
+
 /*
 =================
 R_SetupAliasFrame -- johnfitz -- rewritten to support lerping
@@ -529,6 +674,10 @@ void R_DrawAliasModel (entity_t *e)
 		GL_DrawAliasFrame (paliashdr, lerpdata);
 		glEnable (GL_TEXTURE_2D);*/
 	}
+	else if (alias_batching && alias_batch_count < MAX_VISEDICTS)
+	{
+		GL_BatchAliasFrame (paliashdr, lerpdata, tx, fb, model_matrix);
+	}
 	else
 	{
 		GL_DrawAliasFrame (paliashdr, lerpdata, tx, fb, model_matrix);
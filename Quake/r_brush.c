@@ -31,15 +31,19 @@ extern cvar_t gl_zfix; // QuakeSpasm z-fighting fix
 int		gl_lightmap_format;
 int		lightmap_bytes;
 
-#define	BLOCK_WIDTH	128
-#define	BLOCK_HEIGHT	128
+// lightmaps are packed into a few large atlases so that world batches
+// rarely have to be split, or a new descriptor set bound, on a lightmap change
+#define	BLOCK_WIDTH	1024
+#define	BLOCK_HEIGHT	1024
+
+#define	MAX_SURFACE_LIGHTMAP	128	// Mod_CalcSurfaceExtents allows up to 2000/16+1 luxels
 
 gltexture_t	*lightmap_textures[MAX_LIGHTMAPS]; //johnfitz -- changed to an array
 
-unsigned	blocklights[BLOCK_WIDTH*BLOCK_HEIGHT*3]; //johnfitz -- was 18*18, added lit support (*3) and loosened surface extents maximum (BLOCK_WIDTH*BLOCK_HEIGHT)
+unsigned	blocklights[MAX_SURFACE_LIGHTMAP*MAX_SURFACE_LIGHTMAP*3]; //johnfitz -- was 18*18, added lit support (*3) and loosened surface extents maximum
 
 typedef struct glRect_s {
-	unsigned char l,t,w,h;
+	unsigned short l,t,w,h;
 } glRect_t;
 
 glpoly_t	*lightmap_polys[MAX_LIGHTMAPS];
@@ -122,6 +126,8 @@ void DrawGLPoly (glpoly_t *p, float color[3], float alpha)
 
 	vkCmdBindVertexBuffers(vulkan_globals.command_buffer, 0, 1, &buffer, &buffer_offset);
 	vkCmdDraw(vulkan_globals.command_buffer, numverts, 1, 0, 0);
+	COUNT (CNT_DRAWCALLS, 1);
+	COUNT (CNT_TRIANGLES, numverts - 2);
 }
 
 /*
@@ -360,6 +366,7 @@ dynamic:
 			base = lightmaps + fa->lightmaptexturenum*lightmap_bytes*BLOCK_WIDTH*BLOCK_HEIGHT;
 			base += fa->light_t * BLOCK_WIDTH * lightmap_bytes + fa->light_s * lightmap_bytes;
 			R_BuildLightMap (fa, base, BLOCK_WIDTH*lightmap_bytes);
+			COUNT (CNT_LIGHTMAPS, 1);
 		}
 	}
 }
@@ -525,7 +532,7 @@ void GL_BuildLightmaps (void)
 {
 	char	name[16];
 	byte	*data;
-	int		i, j;
+	int		i, j, k, texels;
 	qmodel_t	*m;
 
 	memset (allocated, 0, sizeof(allocated));
@@ -582,8 +589,11 @@ void GL_BuildLightmaps (void)
 	}
 
 	//johnfitz -- warn about exceeding old limits
-	if (i >= 64)
-		Con_DWarning ("%i lightmaps exceeds standard limit of 64.\n", i);
+	for (j=0, texels=0 ; j<i ; j++)
+		for (k=0 ; k<BLOCK_WIDTH ; k++)
+			texels += allocated[j][k];
+	if (texels > 64*128*128)
+		Con_DWarning ("%i 128x128 lightmaps exceeds standard limit of 64.\n", texels / (128*128));
 	//johnfitz
 }
 
@@ -652,6 +662,12 @@ void GL_BuildBModelVertexBuffer (void)
 		}
 	}
 
+	if (isHeadless)
+	{
+		free (varray);
+		return;
+	}
+
 	// Allocate & upload to GPU
 	VkResult err;
 
@@ -881,15 +897,17 @@ static void R_UploadLightmap(int lmap, gltexture_t * lightmap)
 	lightmap_modified[lmap] = false;
 
 	theRect = &lightmap_rectchange[lmap];
-	const int staging_size = BLOCK_WIDTH * theRect->h * 4;
+	const int staging_size = theRect->w * theRect->h * 4;
 
 	VkBuffer staging_buffer;
 	VkCommandBuffer command_buffer;
 	int staging_offset;
 	unsigned char * staging_memory = R_StagingAllocate(staging_size, &command_buffer, &staging_buffer, &staging_offset);
 
-	byte * data = lightmaps + (lmap * BLOCK_HEIGHT + theRect->t) * BLOCK_WIDTH * lightmap_bytes;
-	memcpy(staging_memory, data, staging_size);
+	// only the changed rectangle, atlas rows are too wide to send whole
+	byte * data = lightmaps + ((lmap * BLOCK_HEIGHT + theRect->t) * BLOCK_WIDTH + theRect->l) * lightmap_bytes;
+	for (int i = 0; i < theRect->h; ++i)
+		memcpy(staging_memory + i * theRect->w * 4, data + i * BLOCK_WIDTH * lightmap_bytes, theRect->w * 4);
 
 	VkBufferImageCopy region;
 	memset(&region, 0, sizeof(region));
@@ -897,9 +915,10 @@ static void R_UploadLightmap(int lmap, gltexture_t * lightmap)
 	region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
 	region.imageSubresource.layerCount = 1;
 	region.imageSubresource.mipLevel = 0;
-	region.imageExtent.width = BLOCK_WIDTH;
+	region.imageExtent.width = theRect->w;
 	region.imageExtent.height = theRect->h;
 	region.imageExtent.depth = 1;
+	region.imageOffset.x = theRect->l;
 	region.imageOffset.y = theRect->t;
 
 	VkImageMemoryBarrier image_memory_barrier;
@@ -24,16 +24,43 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "quakedef.h"
 
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define USE_SSE
+#include <xmmintrin.h>
+#endif
+
 #define MAX_PARTICLES			2048	// default max # of particles at one
 										//  time
 #define ABSOLUTE_MIN_PARTICLES	512		// no fewer than this no matter what's
 										//  on the command line
+#define MAX_GPU_PARTICLES		262144	// default size of the GPU particle buffer
+#define ABSOLUTE_MAX_GPU_PARTICLES	4194304	// no more than this no matter what's on the command line
+#define MAX_GPU_SPAWNS			32768	// particles spawned per frame with r_gpuparticles
+#define PARTICLE_GROUP_SIZE		64		// local_size_x of particle.comp
+#define NUM_PARTICLE_TYPES		(pt_blob2 + 1)
+#define NUM_PARTICLE_FIELDS		9		// org, vel, ramp, die, color
 
 int		ramp1[8] = {0x6f, 0x6d, 0x6b, 0x69, 0x67, 0x65, 0x63, 0x61};
 int		ramp2[8] = {0x6f, 0x6e, 0x6d, 0x6c, 0x6b, 0x6a, 0x68, 0x66};
 int		ramp3[8] = {0x6d, 0x6b, 6, 5, 4, 3};
 
-particle_t	*active_particles, *free_particles, *particles;
+// The CPU particles are kept as arrays per field, one set for each type,
+// so CL_RunParticles runs the same math over a whole group at a time
+typedef struct
+{
+	int		count;
+	float	*org[3];
+	float	*vel[3];
+	float	*ramp;
+	float	*die;
+	float	*color;
+} particlegroup_t;
+
+static particlegroup_t	particle_groups[NUM_PARTICLE_TYPES];
+static int				r_numactive;			// in all groups
+static particle_t		*spawned_particles;		// queued by R_AllocParticle
+static int				num_spawned_particles;
+static int				particle_framecount = -1;	// host frame of the last update
 
 vec3_t			r_pright, r_pup, r_ppn;
 
@@ -43,6 +70,46 @@ gltexture_t *particletexture, *particletexture1, *particletexture2, *particletex
 float texturescalefactor; //johnfitz -- compensate for apparent size of different particle textures
 
 cvar_t	r_particles = {"r_particles","1", CVAR_ARCHIVE}; //johnfitz
+cvar_t	r_gpuparticles = {"r_gpuparticles","0", CVAR_ARCHIVE};
+
+// particle_t as seen by particle.comp
+typedef struct
+{
+	float		org[3];
+	float		color;
+	float		vel[3];
+	float		ramp;
+	float		die;
+	uint32_t	type;
+	uint32_t	pad[2];
+} gpuparticle_t;
+
+typedef struct
+{
+	VkBuffer		buffer;
+	VkDeviceMemory	memory;
+} particlebuffer_t;
+
+static struct
+{
+	qboolean			created;
+	qboolean			ready;		// the palette upload has been submitted
+	qboolean			active;		// simulated this frame, R_DrawParticles draws it
+	int					capacity;
+	int					numslots;	// slots spawned into since the last clear
+	int					next;		// ring position of the next spawn
+	int					current;	// half of the spawn buffer used this frame
+	particlebuffer_t	particles;
+	particlebuffer_t	vertices;
+	particlebuffer_t	draw;
+	particlebuffer_t	palette;
+	particlebuffer_t	spawns;
+	gpuparticle_t		*spawndata;
+	VkDescriptorSet		descriptor_set;
+} gpu_particles;
+
+static particle_t	*gpu_spawns;	// queued by R_AllocParticle until R_UpdateParticles
+static int			num_gpu_spawns;
 
 /*
 ===============
@@ -163,15 +230,333 @@ void R_InitParticles (void)
 		r_numparticles = MAX_PARTICLES;
 	}
 
-	particles = (particle_t *)
+	spawned_particles = (particle_t *)
 			Hunk_AllocName (r_numparticles * sizeof(particle_t), "particles");
 
+	float *fields = (float *)
+			Hunk_AllocName (NUM_PARTICLE_TYPES * NUM_PARTICLE_FIELDS * r_numparticles * sizeof(float), "particles");
+	for (i = 0; i < NUM_PARTICLE_TYPES; i++)
+	{
+		particlegroup_t *group = &particle_groups[i];
+		group->org[0] = fields; fields += r_numparticles;
+		group->org[1] = fields; fields += r_numparticles;
+		group->org[2] = fields; fields += r_numparticles;
+		group->vel[0] = fields; fields += r_numparticles;
+		group->vel[1] = fields; fields += r_numparticles;
+		group->vel[2] = fields; fields += r_numparticles;
+		group->ramp = fields; fields += r_numparticles;
+		group->die = fields; fields += r_numparticles;
+		group->color = fields; fields += r_numparticles;
+	}
+
 	Cvar_RegisterVariable (&r_particles); //johnfitz
 	Cvar_SetCallback (&r_particles, R_SetParticleTexture_f);
+	Cvar_RegisterVariable (&r_gpuparticles);
 
 	R_InitParticleTextures (); //johnfitz
 }
 
+/*
+==============================================================================
+
+GPU PARTICLES
+
+With r_gpuparticles the spawners queue their particles instead of taking
+them off the free list. R_UpdateParticles copies the queue into a ring
+buffer on the GPU, where particle.comp runs the CL_RunParticles physics and
+writes the R_DrawParticles triangles of everything still alive, drawn with a
+single indirect draw. Nothing reads the particles back, so the ring can be
+far larger than the CPU list.
+
+==============================================================================
+*/
+
+/*
+===============
+R_CreateParticleBuffer
+===============
+*/
+static void R_CreateParticleBuffer (particlebuffer_t *dest, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties)
+{
+	VkResult err;
+
+	VkBufferCreateInfo buffer_create_info;
+	memset(&buffer_create_info, 0, sizeof(buffer_create_info));
+	buffer_create_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	buffer_create_info.size = size;
+	buffer_create_info.usage = usage;
+
+	err = vkCreateBuffer(vulkan_globals.device, &buffer_create_info, NULL, &dest->buffer);
+	if (err != VK_SUCCESS)
+		Sys_Error("vkCreateBuffer failed");
+
+	VkMemoryRequirements memory_requirements;
+	vkGetBufferMemoryRequirements(vulkan_globals.device, dest->buffer, &memory_requirements);
+
+	VkMemoryAllocateInfo memory_allocate_info;
+	memset(&memory_allocate_info, 0, sizeof(memory_allocate_info));
+	memory_allocate_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	memory_allocate_info.allocationSize = memory_requirements.size;
+	memory_allocate_info.memoryTypeIndex = GL_MemoryTypeFromProperties(memory_requirements.memoryTypeBits, properties);
+
+	err = vkAllocateMemory(vulkan_globals.device, &memory_allocate_info, NULL, &dest->memory);
+	if (err != VK_SUCCESS)
+		Sys_Error("vkAllocateMemory failed");
+
+	err = vkBindBufferMemory(vulkan_globals.device, dest->buffer, dest->memory, 0);
+	if (err != VK_SUCCESS)
+		Sys_Error("vkBindBufferMemory failed");
+}
+
+/*
+===============
+R_CreateGPUParticles
+
+Done the first time r_gpuparticles is used, the buffers live until shutdown
+===============
+*/
+static void R_CreateGPUParticles (void)
+{
+	int			i;
+	VkBuffer	staging_buffer;
+	VkCommandBuffer	command_buffer;
+	int			staging_offset;
+
+	i = COM_CheckParm ("-gpuparticles");
+	if (i)
+		gpu_particles.capacity = CLAMP (MAX_GPU_SPAWNS, Q_atoi(com_argv[i+1]), ABSOLUTE_MAX_GPU_PARTICLES);
+	else
+		gpu_particles.capacity = MAX_GPU_PARTICLES;
+
+	R_CreateParticleBuffer (&gpu_particles.particles, (VkDeviceSize)gpu_particles.capacity * sizeof(gpuparticle_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	R_CreateParticleBuffer (&gpu_particles.vertices, (VkDeviceSize)gpu_particles.capacity * 3 * sizeof(basicvertex_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	R_CreateParticleBuffer (&gpu_particles.draw, sizeof(VkDrawIndirectCommand), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	R_CreateParticleBuffer (&gpu_particles.palette, sizeof(d_8to24table), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	R_CreateParticleBuffer (&gpu_particles.spawns, 2 * MAX_GPU_SPAWNS * sizeof(gpuparticle_t), VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+	if (vkMapMemory(vulkan_globals.device, gpu_particles.spawns.memory, 0, 2 * MAX_GPU_SPAWNS * sizeof(gpuparticle_t), 0, (void **)&gpu_particles.spawndata) != VK_SUCCESS)
+		Sys_Error("vkMapMemory failed");
+
+	byte * staging_memory = R_StagingAllocate(sizeof(d_8to24table), &command_buffer, &staging_buffer, &staging_offset);
+	memcpy(staging_memory, d_8to24table, sizeof(d_8to24table));
+
+	VkBufferCopy region;
+	region.srcOffset = staging_offset;
+	region.dstOffset = 0;
+	region.size = sizeof(d_8to24table);
+	vkCmdCopyBuffer(command_buffer, staging_buffer, gpu_particles.palette.buffer, 1, &region);
+
+	VkDescriptorSetAllocateInfo descriptor_set_allocate_info;
+	memset(&descriptor_set_allocate_info, 0, sizeof(descriptor_set_allocate_info));
+	descriptor_set_allocate_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	descriptor_set_allocate_info.descriptorPool = vulkan_globals.descriptor_pool;
+	descriptor_set_allocate_info.descriptorSetCount = 1;
+	descriptor_set_allocate_info.pSetLayouts = &vulkan_globals.particle_compute_set_layout;
+
+	if (vkAllocateDescriptorSets(vulkan_globals.device, &descriptor_set_allocate_info, &gpu_particles.descriptor_set) != VK_SUCCESS)
+		Sys_Error("vkAllocateDescriptorSets failed");
+
+	particlebuffer_t *buffers[4] = {
+		&gpu_particles.particles,
+		&gpu_particles.vertices,
+		&gpu_particles.draw,
+		&gpu_particles.palette
+	};
+	VkDescriptorBufferInfo buffer_infos[4];
+	VkWriteDescriptorSet writes[4];
+
+	memset(buffer_infos, 0, sizeof(buffer_infos));
+	memset(writes, 0, sizeof(writes));
+	for (i = 0; i < 4; ++i)
+	{
+		buffer_infos[i].buffer = buffers[i]->buffer;
+		buffer_infos[i].offset = 0;
+		buffer_infos[i].range = VK_WHOLE_SIZE;
+
+		writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		writes[i].dstSet = gpu_particles.descriptor_set;
+		writes[i].dstBinding = i;
+		writes[i].dstArrayElement = 0;
+		writes[i].descriptorCount = 1;
+		writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		writes[i].pBufferInfo = &buffer_infos[i];
+	}
+
+	vkUpdateDescriptorSets(vulkan_globals.device, 4, writes, 0, NULL);
+
+	gpu_spawns = (particle_t *) malloc (MAX_GPU_SPAWNS * sizeof(particle_t));
+	if (!gpu_spawns)
+		Sys_Error ("R_CreateGPUParticles: out of memory");
+	gpu_particles.created = true;
+}
+
+/*
+===============
+R_UseGPUParticles
+===============
+*/
+static qboolean R_UseGPUParticles (void)
+{
+	if (!vulkan_globals.gpu_particles || !r_gpuparticles.value || isHeadless)
+		return false;
+
+	if (!gpu_particles.created)
+		R_CreateGPUParticles ();
+
+	return true;
+}
+
+/*
+===============
+R_AllocParticle
+
+Returns a particle for the spawners to fill in, NULL if there is no room
+===============
+*/
+static particle_t *R_AllocParticle (void)
+{
+	particle_t	*p;
+
+	if (R_UseGPUParticles ())
+	{
+		if (num_gpu_spawns == MAX_GPU_SPAWNS)
+			return NULL;
+		p = &gpu_spawns[num_gpu_spawns++];
+		memset (p, 0, sizeof(*p));
+		return p;
+	}
+
+	if (r_numactive + num_spawned_particles >= r_numparticles)
+		return NULL;
+	p = &spawned_particles[num_spawned_particles++];
+	memset (p, 0, sizeof(*p));
+	return p;
+}
+
+/*
+===============
+R_UpdateParticles
+
+Records the spawn copies and the simulation dispatch, before the main
+render pass is begun
+===============
+*/
+void R_UpdateParticles (void)
+{
+	int				i, first;
+	particle_t		*src;
+	gpuparticle_t	*dst;
+	VkCommandBuffer	command_buffer = vulkan_globals.command_buffer;
+	extern	cvar_t	sv_gravity;
+
+	gpu_particles.active = false;
+
+	if (!R_UseGPUParticles ())
+		return;
+
+	if (!gpu_particles.ready)
+	{
+		// the palette is copied with the next frame
+		gpu_particles.ready = true;
+		return;
+	}
+
+	// the half not used by the previous frame was last read two frames
+	// ago at the latest, which GL_BeginRendering has already waited for
+	gpu_particles.current ^= 1;
+	dst = gpu_particles.spawndata + gpu_particles.current * MAX_GPU_SPAWNS;
+	for (i = 0, src = gpu_spawns; i < num_gpu_spawns; i++, src++, dst++)
+	{
+		VectorCopy (src->org, dst->org);
+		dst->color = src->color;
+		VectorCopy (src->vel, dst->vel);
+		dst->ramp = src->ramp;
+		dst->die = src->die;
+		dst->type = src->type;
+	}
+
+	if (!gpu_particles.numslots && !num_gpu_spawns)
+		return;
+
+	// the previous frame may still be drawing, and the first one needs the palette
+	VkMemoryBarrier memory_barrier;
+	memset(&memory_barrier, 0, sizeof(memory_barrier));
+	memory_barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	memory_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+	memory_barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+	vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+		VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &memory_barrier, 0, NULL, 0, NULL);
+
+	if (num_gpu_spawns)
+	{
+		// the oldest particles are the first to be overwritten
+		VkBufferCopy regions[2];
+		int numregions = 1;
+
+		first = q_min (num_gpu_spawns, gpu_particles.capacity - gpu_particles.next);
+		regions[0].srcOffset = gpu_particles.current * MAX_GPU_SPAWNS * sizeof(gpuparticle_t);
+		regions[0].dstOffset = gpu_particles.next * sizeof(gpuparticle_t);
+		regions[0].size = first * sizeof(gpuparticle_t);
+		if (first < num_gpu_spawns)
+		{
+			regions[1].srcOffset = regions[0].srcOffset + regions[0].size;
+			regions[1].dstOffset = 0;
+			regions[1].size = (num_gpu_spawns - first) * sizeof(gpuparticle_t);
+			numregions = 2;
+		}
+		vkCmdCopyBuffer(command_buffer, gpu_particles.spawns.buffer, gpu_particles.particles.buffer, numregions, regions);
+
+		gpu_particles.next = (gpu_particles.next + num_gpu_spawns) % gpu_particles.capacity;
+		gpu_particles.numslots = q_min (gpu_particles.numslots + num_gpu_spawns, gpu_particles.capacity);
+		num_gpu_spawns = 0;
+	}
+
+	VkDrawIndirectCommand draw;
+	draw.vertexCount = 0;
+	draw.instanceCount = 1;
+	draw.firstVertex = 0;
+	draw.firstInstance = 0;
+	vkCmdUpdateBuffer(command_buffer, gpu_particles.draw.buffer, 0, sizeof(draw), &draw);
+
+	memory_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	memory_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+	vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &memory_barrier, 0, NULL, 0, NULL);
+
+	struct
+	{
+		float		origin[3];
+		float		scale_factor;
+		float		forward[3];
+		float		time;
+		float		up[3];
+		float		frametime;
+		float		right[3];
+		float		gravity;
+		uint32_t	numparticles;
+	} push_constants;
+
+	VectorCopy (r_origin, push_constants.origin);
+	push_constants.scale_factor = texturescalefactor;
+	VectorCopy (vpn, push_constants.forward);
+	push_constants.time = cl.time;
+	VectorScale (vup, 1.5, push_constants.up);
+	push_constants.frametime = cl.time - cl.oldtime;
+	VectorScale (vright, 1.5, push_constants.right);
+	push_constants.gravity = push_constants.frametime * sv_gravity.value * 0.05;
+	push_constants.numparticles = gpu_particles.numslots;
+
+	vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, vulkan_globals.particle_compute_pipeline);
+	vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, vulkan_globals.particle_compute_pipeline_layout, 0, 1, &gpu_particles.descriptor_set, 0, NULL);
+	vkCmdPushConstants(command_buffer, vulkan_globals.particle_compute_pipeline_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(push_constants), &push_constants);
+	vkCmdDispatch(command_buffer, (gpu_particles.numslots + PARTICLE_GROUP_SIZE - 1) / PARTICLE_GROUP_SIZE, 1, 1);
+	COUNT (CNT_PIPELINEBINDS, 1);
+
+	memory_barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	memory_barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+	vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, 0, 1, &memory_barrier, 0, NULL, 0, NULL);
+
+	gpu_particles.active = true;
+}
+
 /*
 ===============
 R_EntityParticles
@@ -225,12 +610,8 @@ void R_EntityParticles (entity_t *ent)
 		forward[1] = cp*sy;
 		forward[2] = -sp;
 
-		if (!free_particles)
+		if (!(p = R_AllocParticle ()))
 			return;
-		p = free_particles;
-		free_particles = p->next;
-		p->next = active_particles;
-		active_particles = p;
 
 		p->die = cl.time + 0.01;
 		p->color = 0x6f;
@@ -251,12 +632,14 @@ void R_ClearParticles (void)
 {
 	int		i;
 
-	free_particles = &particles[0];
-	active_particles = NULL;
+	for (i = 0; i < NUM_PARTICLE_TYPES; i++)
+		particle_groups[i].count = 0;
+	r_numactive = 0;
+	num_spawned_particles = 0;
 
-	for (i=0 ;i<r_numparticles ; i++)
-		particles[i].next = &particles[i+1];
-	particles[r_numparticles-1].next = NULL;
+	num_gpu_spawns = 0;
+	gpu_particles.numslots = 0;
+	gpu_particles.next = 0;
 }
 
 /*
@@ -294,15 +677,11 @@ void R_ReadPointFile_f (void)
 			break;
 		c++;
 
-		if (!free_particles)
+		if (!(p = R_AllocParticle ()))
 		{
 			Con_Printf ("Not enough free particles\n");
 			break;
 		}
-		p = free_particles;
-		free_particles = p->next;
-		p->next = active_particles;
-		active_particles = p;
 
 		p->die = 99999;
 		p->color = (-c)&15;
@@ -354,12 +733,8 @@ void R_ParticleExplosion (vec3_t org)
 
 	for (i=0 ; i<1024 ; i++)
 	{
-		if (!free_particles)
+		if (!(p = R_AllocParticle ()))
 			return;
-		p = free_particles;
-		free_particles = p->next;
-		p->next = active_particles;
-		active_particles = p;
 
 		p->die = cl.time + 5;
 		p->color = ramp1[0];
@@ -398,12 +773,8 @@ void R_ParticleExplosion2 (vec3_t org, int colorStart, int colorLength)
 
 	for (i=0; i<512; i++)
 	{
-		if (!free_particles)
+		if (!(p = R_AllocParticle ()))
 			return;
-		p = free_particles;
-		free_particles = p->next;
-		p->next = active_particles;
-		active_particles = p;
 
 		p->die = cl.time + 0.3;
 		p->color = colorStart + (colorMod % colorLength);
@@ -430,12 +801,8 @@ void R_BlobExplosion (vec3_t org)
 
 	for (i=0 ; i<1024 ; i++)
 	{
-		if (!free_particles)
+		if (!(p = R_AllocParticle ()))
 			return;
-		p = free_particles;
-		free_particles = p->next;
-		p->next = active_particles;
-		active_particles = p;
 
 		p->die = cl.time + 1 + (rand()&8)*0.05;
 
@@ -474,12 +841,8 @@ void R_RunParticleEffect (vec3_t org, vec3_t dir, int color, int count)
 
 	for (i=0 ; i<count ; i++)
 	{
-		if (!free_particles)
+		if (!(p = R_AllocParticle ()))
 			return;
-		p = free_particles;
-		free_particles = p->next;
-		p->next = active_particles;
-		active_particles = p;
 
 		if (count == 1024)
 		{	// rocket explosion
@@ -535,12 +898,8 @@ void R_LavaSplash (vec3_t org)
 		for (j=-16 ; j<16 ; j++)
 			for (k=0 ; k<1 ; k++)
 			{
-				if (!free_particles)
+				if (!(p = R_AllocParticle ()))
 					return;
-				p = free_particles;
-				free_particles = p->next;
-				p->next = active_particles;
-				active_particles = p;
 
 				p->die = cl.time + 2 + (rand()&31) * 0.02;
 				p->color = 224 + (rand()&7);
@@ -576,12 +935,8 @@ void R_TeleportSplash (vec3_t org)
 		for (j=-16 ; j<16 ; j+=4)
 			for (k=-24 ; k<32 ; k+=4)
 			{
-				if (!free_particles)
+				if (!(p = R_AllocParticle ()))
 					return;
-				p = free_particles;
-				free_particles = p->next;
-				p->next = active_particles;
-				active_particles = p;
 
 				p->die = cl.time + 0.2 + (rand()&7) * 0.02;
 				p->color = 7 + (rand()&7);
@@ -631,12 +986,8 @@ void R_RocketTrail (vec3_t start, vec3_t end, int type)
 	{
 		len -= dec;
 
-		if (!free_particles)
+		if (!(p = R_AllocParticle ()))
 			return;
-		p = free_particles;
-		free_particles = p->next;
-		p->next = active_particles;
-		active_particles = p;
 
 		VectorCopy (vec3_origin, p->vel);
 		p->die = cl.time + 2;
@@ -713,108 +1064,249 @@ void R_RocketTrail (vec3_t start, vec3_t end, int type)
 
 /*
 ===============
-CL_RunParticles -- johnfitz -- all the particle behavior, separated from R_DrawParticles
+R_SpawnQueuedParticles
+
+Moves the particles queued by R_AllocParticle into their groups
 ===============
 */
-void CL_RunParticles (void)
+static void R_SpawnQueuedParticles (void)
 {
-	particle_t		*p, *kill;
-	int				i;
-	float			time1, time2, time3, dvel, frametime, grav;
+	int				i, j;
+	particle_t		*p;
+	particlegroup_t	*group;
+
+	for (i = 0, p = spawned_particles; i < num_spawned_particles; i++, p++)
+	{
+		group = &particle_groups[p->type];
+		j = group->count++;
+		group->org[0][j] = p->org[0];
+		group->org[1][j] = p->org[1];
+		group->org[2][j] = p->org[2];
+		group->vel[0][j] = p->vel[0];
+		group->vel[1][j] = p->vel[1];
+		group->vel[2][j] = p->vel[2];
+		group->ramp[j] = p->ramp;
+		group->die[j] = p->die;
+		group->color[j] = p->color;
+	}
+
+	r_numactive += num_spawned_particles;
+	num_spawned_particles = 0;
+}
+
+/*
+===============
+R_MoveParticleGroup
+
+Every type moves as org += vel*frametime followed by
+vel.xy *= velscale, vel.z = vel.z*zscale + zaccel, and ramp += ramprate
+===============
+*/
+static void R_MoveParticleGroup (particlegroup_t *group, float frametime, float velscale, float zscale, float zaccel, float ramprate)
+{
+	int		i = 0;
+	float	*x = group->org[0], *y = group->org[1], *z = group->org[2];
+	float	*vx = group->vel[0], *vy = group->vel[1], *vz = group->vel[2];
+	float	*ramp = group->ramp;
+
+#ifdef USE_SSE
+	__m128	ft = _mm_set1_ps (frametime);
+	__m128	vs = _mm_set1_ps (velscale);
+	__m128	zs = _mm_set1_ps (zscale);
+	__m128	za = _mm_set1_ps (zaccel);
+	__m128	rr = _mm_set1_ps (ramprate);
+
+	for ( ; i + 4 <= group->count; i += 4)
+	{
+		__m128 velx = _mm_loadu_ps (vx + i);
+		__m128 vely = _mm_loadu_ps (vy + i);
+		__m128 velz = _mm_loadu_ps (vz + i);
+
+		_mm_storeu_ps (x + i, _mm_add_ps (_mm_loadu_ps (x + i), _mm_mul_ps (velx, ft)));
+		_mm_storeu_ps (y + i, _mm_add_ps (_mm_loadu_ps (y + i), _mm_mul_ps (vely, ft)));
+		_mm_storeu_ps (z + i, _mm_add_ps (_mm_loadu_ps (z + i), _mm_mul_ps (velz, ft)));
+		_mm_storeu_ps (vx + i, _mm_mul_ps (velx, vs));
+		_mm_storeu_ps (vy + i, _mm_mul_ps (vely, vs));
+		_mm_storeu_ps (vz + i, _mm_add_ps (_mm_mul_ps (velz, zs), za));
+		_mm_storeu_ps (ramp + i, _mm_add_ps (_mm_loadu_ps (ramp + i), rr));
+	}
+#endif
+
+	for ( ; i < group->count; i++)
+	{
+		x[i] += vx[i] * frametime;
+		y[i] += vy[i] * frametime;
+		z[i] += vz[i] * frametime;
+		vx[i] *= velscale;
+		vy[i] *= velscale;
+		vz[i] = vz[i] * zscale + zaccel;
+		ramp[i] += ramprate;
+	}
+}
+
+/*
+===============
+R_ParticleVertex
+===============
+*/
+static inline void R_ParticleVertex (basicvertex_t *v, float x, float y, float z, float s, float t, const byte *c)
+{
+	v->position[0] = x;
+	v->position[1] = y;
+	v->position[2] = z;
+	v->texcoord[0] = s;
+	v->texcoord[1] = t;
+	v->color[0] = c[0];
+	v->color[1] = c[1];
+	v->color[2] = c[2];
+	v->color[3] = 255;
+}
+
+/*
+===============
+R_RunParticleGroups
+
+Moves every particle by frametime, then removes the dead ones and, if
+vertices is given, writes the triangles of the rest in the same pass.
+Returns the number of particles written.
+===============
+*/
+static int R_RunParticleGroups (float frametime, basicvertex_t *vertices)
+{
+	int				i, type, live, drawn;
+	int				*ramptable;
+	float			ramplimit, ramprate, velscale, zscale, zaccel;
+	float			grav, dvel, scale, time;
+	vec3_t			up, right;
+	particlegroup_t	*group;
 	extern	cvar_t	sv_gravity;
 
-	frametime = cl.time - cl.oldtime;
-	time3 = frametime * 15;
-	time2 = frametime * 10;
-	time1 = frametime * 5;
 	grav = frametime * sv_gravity.value * 0.05;
 	dvel = 4*frametime;
+	time = cl.time;
+	drawn = 0;
 
-	for ( ;; )
-	{
-		kill = active_particles;
-		if (kill && kill->die < cl.time)
-		{
-			active_particles = kill->next;
-			kill->next = free_particles;
-			free_particles = kill;
-			continue;
-		}
-		break;
-	}
+	VectorScale (vup, 1.5, up);
+	VectorScale (vright, 1.5, right);
 
-	for (p=active_particles ; p ; p=p->next)
+	for (type = 0; type < NUM_PARTICLE_TYPES; type++)
 	{
-		for ( ;; )
-		{
-			kill = p->next;
-			if (kill && kill->die < cl.time)
-			{
-				p->next = kill->next;
-				kill->next = free_particles;
-				free_particles = kill;
-				continue;
-			}
-			break;
-		}
+		group = &particle_groups[type];
+		if (!group->count)
+			continue;
 
-		p->org[0] += p->vel[0]*frametime;
-		p->org[1] += p->vel[1]*frametime;
-		p->org[2] += p->vel[2]*frametime;
+		ramptable = NULL;
+		ramplimit = ramprate = 0;
+		velscale = zscale = 1;
+		zaccel = -grav;
 
-		switch (p->type)
+		switch (type)
 		{
 		case pt_static:
+			zaccel = 0;
 			break;
 		case pt_fire:
-			p->ramp += time1;
-			if (p->ramp >= 6)
-				p->die = -1;
-			else
-				p->color = ramp3[(int)p->ramp];
-			p->vel[2] += grav;
+			ramptable = ramp3;
+			ramplimit = 6;
+			ramprate = frametime * 5;
+			zaccel = grav;
 			break;
-
 		case pt_explode:
-			p->ramp += time2;
-			if (p->ramp >=8)
-				p->die = -1;
-			else
-				p->color = ramp1[(int)p->ramp];
-			for (i=0 ; i<3 ; i++)
-				p->vel[i] += p->vel[i]*dvel;
-			p->vel[2] -= grav;
+			ramptable = ramp1;
+			ramplimit = 8;
+			ramprate = frametime * 10;
+			velscale = zscale = 1 + dvel;
 			break;
-
 		case pt_explode2:
-			p->ramp += time3;
-			if (p->ramp >=8)
-				p->die = -1;
-			else
-				p->color = ramp2[(int)p->ramp];
-			for (i=0 ; i<3 ; i++)
-				p->vel[i] -= p->vel[i]*frametime;
-			p->vel[2] -= grav;
+			ramptable = ramp2;
+			ramplimit = 8;
+			ramprate = frametime * 15;
+			velscale = zscale = 1 - frametime;
 			break;
-
 		case pt_blob:
-			for (i=0 ; i<3 ; i++)
-				p->vel[i] += p->vel[i]*dvel;
-			p->vel[2] -= grav;
+			velscale = zscale = 1 + dvel;
 			break;
-
 		case pt_blob2:
-			for (i=0 ; i<2 ; i++)
-				p->vel[i] -= p->vel[i]*dvel;
-			p->vel[2] -= grav;
+			velscale = 1 - dvel;
 			break;
-
 		case pt_grav:
 		case pt_slowgrav:
-			p->vel[2] -= grav;
 			break;
 		}
+
+		R_MoveParticleGroup (group, frametime, velscale, zscale, zaccel, ramprate);
+
+		for (i = 0, live = 0; i < group->count; i++)
+		{
+			if (group->die[i] < time)
+				continue;
+			if (ramptable)
+			{
+				if (group->ramp[i] >= ramplimit)
+					continue;
+				group->color[i] = ramptable[(int)group->ramp[i]];
+			}
+
+			if (vertices)
+			{
+				float x = group->org[0][i], y = group->org[1][i], z = group->org[2][i];
+				const byte *c = (const byte *)&d_8to24table[(int)group->color[i]];
+
+				// hack a scale up to keep particles from disapearing
+				scale = (x - r_origin[0]) * vpn[0]
+						+ (y - r_origin[1]) * vpn[1]
+						+ (z - r_origin[2]) * vpn[2];
+				if (scale < 20)
+					scale = 1 + 0.08; //johnfitz -- added .08 to be consistent
+				else
+					scale = 1 + scale * 0.004;
+
+				scale *= texturescalefactor; //johnfitz -- compensate for apparent size of different particle textures
+
+				R_ParticleVertex (vertices++, x, y, z, 0.0f, 0.0f, c);
+				R_ParticleVertex (vertices++, x + scale*up[0], y + scale*up[1], z + scale*up[2], 1.0f, 0.0f, c);
+				R_ParticleVertex (vertices++, x + scale*right[0], y + scale*right[1], z + scale*right[2], 0.0f, 1.0f, c);
+				drawn++;
+			}
+
+			if (live != i)
+			{
+				group->org[0][live] = group->org[0][i];
+				group->org[1][live] = group->org[1][i];
+				group->org[2][live] = group->org[2][i];
+				group->vel[0][live] = group->vel[0][i];
+				group->vel[1][live] = group->vel[1][i];
+				group->vel[2][live] = group->vel[2][i];
+				group->ramp[live] = group->ramp[i];
+				group->die[live] = group->die[i];
+				group->color[live] = group->color[i];
+			}
+			live++;
+		}
+
+		r_numactive -= group->count - live;
+		group->count = live;
 	}
+
+	return drawn;
+}
+
+/*
+===============
+CL_RunParticles -- johnfitz -- all the particle behavior, separated from R_DrawParticles
+
+R_DrawParticles normally moves the particles while writing their vertices,
+this is only for frames where nothing drew them
+===============
+*/
+void CL_RunParticles (void)
+{
+	if (particle_framecount == host_framecount)
+		return;
+
+	R_SpawnQueuedParticles ();
+	R_RunParticleGroups (cl.time - cl.oldtime, NULL);
+	particle_framecount = host_framecount;
 }
 
 /*
@@ -824,89 +1316,53 @@ R_DrawParticles -- johnfitz -- moved all non-drawing code to CL_RunParticles
 */
 void R_DrawParticles (void)
 {
-	particle_t		*p;
-	float			scale;
-	vec3_t			up, right, p_up, p_right; //johnfitz -- p_ vectors
+	float			frametime;
 	extern	cvar_t	r_particles; //johnfitz
 
 	if (!r_particles.value)
 		return;
 
 	//ericw -- avoid empty glBegin(),glEnd() pair below; causes issues on AMD
-	if (!active_particles)
+	if (!r_numactive && !num_spawned_particles && !gpu_particles.active)
 		return;
 
-	VectorScale (vup, 1.5, up);
-	VectorScale (vright, 1.5, right);
-
 	vkCmdBindPipeline(vulkan_globals.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkan_globals.particle_pipeline);
+	COUNT (CNT_PIPELINEBINDS, 1);
 	vkCmdBindDescriptorSets(vulkan_globals.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkan_globals.basic_pipeline_layout, 0, 1, particletexture->sampler_set, 0, NULL);
 	vkCmdBindDescriptorSets(vulkan_globals.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkan_globals.basic_pipeline_layout, 1, 1, &particletexture->descriptor_set, 0, NULL);
+	COUNT (CNT_DESCRIPTORSETS, 2);
+
+	if (gpu_particles.active)
+	{
+		// vertex count was written by particle.comp
+		VkDeviceSize gpu_vertex_offset = 0;
+		vkCmdBindVertexBuffers(vulkan_globals.command_buffer, 0, 1, &gpu_particles.vertices.buffer, &gpu_vertex_offset);
+		vkCmdDrawIndirect(vulkan_globals.command_buffer, gpu_particles.draw.buffer, 0, 1, sizeof(VkDrawIndirectCommand));
+		COUNT (CNT_DRAWCALLS, 1);
+	}
+
+	// with r_gpuparticles, these were spawned before it was turned on
+	R_SpawnQueuedParticles ();
+	if (!r_numactive)
+		return;
 
-	int num_triangles = 0;
-	for (p=active_particles ; p ; p=p->next)
-		num_triangles += 1;
+	// the particles move once per frame, CL_RunParticles skips them after this
+	frametime = (particle_framecount == host_framecount) ? 0 : cl.time - cl.oldtime;
+	particle_framecount = host_framecount;
 
 	VkBuffer vertex_buffer;
 	VkDeviceSize vertex_buffer_offset;
-	basicvertex_t * vertices = (basicvertex_t*)R_VertexAllocate(num_triangles * 3 * sizeof(basicvertex_t), &vertex_buffer, &vertex_buffer_offset);	
-	
-	int current_vertex = 0;
-	for (p=active_particles ; p ; p=p->next)
-	{
-		// hack a scale up to keep particles from disapearing
-		scale = (p->org[0] - r_origin[0]) * vpn[0]
-				+ (p->org[1] - r_origin[1]) * vpn[1]
-				+ (p->org[2] - r_origin[2]) * vpn[2];
-		if (scale < 20)
-			scale = 1 + 0.08; //johnfitz -- added .08 to be consistent
-		else
-			scale = 1 + scale * 0.004;
-
-		scale *= texturescalefactor; //johnfitz -- compensate for apparent size of different particle textures
-
-		byte * c = (byte*)&d_8to24table[(int)p->color];
-
-		vertices[current_vertex].position[0] = p->org[0];
-		vertices[current_vertex].position[1] = p->org[1];
-		vertices[current_vertex].position[2] = p->org[2];
-		vertices[current_vertex].texcoord[0] = 0.0f;
-		vertices[current_vertex].texcoord[1] = 0.0f;
-		vertices[current_vertex].color[0] = c[0];
-		vertices[current_vertex].color[1] = c[1];
-		vertices[current_vertex].color[2] = c[2];
-		vertices[current_vertex].color[3] = 255;
-		current_vertex++;
-	
-		VectorMA (p->org, scale, up, p_up);
-		vertices[current_vertex].position[0] = p_up[0];
-		vertices[current_vertex].position[1] = p_up[1];
-		vertices[current_vertex].position[2] = p_up[2];
-		vertices[current_vertex].texcoord[0] = 1.0f;
-		vertices[current_vertex].texcoord[1] = 0.0f;
-		vertices[current_vertex].color[0] = c[0];
-		vertices[current_vertex].color[1] = c[1];
-		vertices[current_vertex].color[2] = c[2];
-		vertices[current_vertex].color[3] = 255;
-		current_vertex++;
-
-		VectorMA (p->org, scale, right, p_right);
-		vertices[current_vertex].position[0] = p_right[0];
-		vertices[current_vertex].position[1] = p_right[1];
-		vertices[current_vertex].position[2] = p_right[2];
-		vertices[current_vertex].texcoord[0] = 0.0f;
-		vertices[current_vertex].texcoord[1] = 1.0f;
-		vertices[current_vertex].color[0] = c[0];
-		vertices[current_vertex].color[1] = c[1];
-		vertices[current_vertex].color[2] = c[2];
-		vertices[current_vertex].color[3] = 255;
-		current_vertex++;
-
-		rs_particles++;
-	}
+	basicvertex_t * vertices = (basicvertex_t*)R_VertexAllocate(r_numactive * 3 * sizeof(basicvertex_t), &vertex_buffer, &vertex_buffer_offset);
+
+	int num_triangles = R_RunParticleGroups (frametime, vertices);
+	rs_particles += num_triangles;
+	if (!num_triangles)
+		return;
 
 	vkCmdBindVertexBuffers(vulkan_globals.command_buffer, 0, 1, &vertex_buffer, &vertex_buffer_offset);
 	vkCmdDraw(vulkan_globals.command_buffer, num_triangles * 3, 1, 0, 0);
+	COUNT (CNT_DRAWCALLS, 1);
+	COUNT (CNT_TRIANGLES, num_triangles);
 }
 
 /*
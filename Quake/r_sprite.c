@@ -181,6 +181,7 @@ void R_DrawSpriteModel (entity_t *e)
 
 	vkCmdBindVertexBuffers(vulkan_globals.command_buffer, 0, 1, &buffer, &buffer_offset);
 	vkCmdBindPipeline(vulkan_globals.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkan_globals.sprite_pipeline);
+	COUNT (CNT_PIPELINEBINDS, 1);
 
 	if (psprite->type == SPR_ORIENTED)
 		vkCmdSetDepthBias(vulkan_globals.command_buffer, OFFSET_DECAL, 0.0f, 0.0f);
@@ -189,5 +190,8 @@ void R_DrawSpriteModel (entity_t *e)
 
 	vkCmdBindDescriptorSets(vulkan_globals.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkan_globals.basic_pipeline_layout, 0, 1, frame->gltexture->sampler_set, 0, NULL);
 	vkCmdBindDescriptorSets(vulkan_globals.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkan_globals.basic_pipeline_layout, 1, 1, &frame->gltexture->descriptor_set, 0, NULL);
+	COUNT (CNT_DESCRIPTORSETS, 2);
 	vkCmdDraw(vulkan_globals.command_buffer, 4, 1, 0, 0);
+	COUNT (CNT_DRAWCALLS, 1);
+	COUNT (CNT_TRIANGLES, 2);
 }
@@ -26,6 +26,9 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "quakedef.h"
 
 extern cvar_t gl_fullbrights, r_drawflat, r_oldskyleaf, r_showtris; //johnfitz
+extern cvar_t r_worldcache;
+extern cvar_t r_bindless;
+extern cvar_t r_gpuculling;
 
 extern glpoly_t	*lightmap_polys[MAX_LIGHTMAPS];
 
@@ -35,6 +38,102 @@ int vis_changed; //if true, force pvs to be refreshed
 
 extern VkBuffer bmodel_vertex_buffer;
 
+// world surface indices are kept in a persistent buffer, grouped by
+// texture and lightmap, and only rebuilt when the visible set changes
+typedef struct
+{
+	texture_t	*texture;
+	int			lightmap;
+	int			numsurfaces;
+	uint32_t	firstindex;
+	uint32_t	numindices;
+} worldbatch_t;
+
+typedef struct
+{
+	qmodel_t		*model;
+	VkBuffer		buffers[2];		// alternated per rebuild so an in flight frame keeps its copy
+	VkDeviceMemory	memory[2];
+	uint32_t		*data[2];
+	int				current;
+	uint32_t		capacity;		// indices in each buffer
+	worldbatch_t	*batches;
+	int				numbatches;
+	int				numsurfaces;
+	int				build;
+	int				visframe;
+	qboolean		valid;
+} worldcache_t;
+
+static worldcache_t	world_cache;
+static int	worldcache_missing;	// visible surfaces the cache doesn't draw
+static int	worldcache_extra;	// culled surfaces it still draws
+
+#define WORLDCACHE_SLACK	8	// rebuild once 1/8th of the cached surfaces are culled
+
+// with r_gpuculling the surface data is uploaded once per map and a compute
+// shader does the frustum, backface and PVS tests, writing the indices of
+// the visible surfaces and one indirect draw per texture and lightmap
+typedef struct
+{
+	float		plane[4];		// normal and dist
+	float		mins[3];
+	uint32_t	planeback;
+	float		maxs[3];
+	uint32_t	batch;
+	uint32_t	firstindex;		// in the source indices
+	uint32_t	numindices;
+	uint32_t	firstleaf;		// in the leaf list, which holds PVS bit numbers
+	uint32_t	numleafs;
+} cullsurface_t;
+
+typedef struct
+{
+	VkBuffer		buffer;
+	VkDeviceMemory	memory;
+} cullbuffer_t;
+
+typedef struct
+{
+	qmodel_t		*model;
+	int				numsurfaces;
+	worldbatch_t	*batches;		// numindices is the most the batch can draw
+	int				numbatches;
+	byte			*skyleafs;		// leafs R_MarkSurfaces skips without r_oldskyleaf
+	int				pvsbytes;
+	cullbuffer_t	surfaces;
+	cullbuffer_t	leafs;
+	cullbuffer_t	source_indices;
+	cullbuffer_t	indices;		// every batch at the same offset as in the source indices
+	cullbuffer_t	cleared_draws;	// copied over draws before culling
+	cullbuffer_t	draws;
+	cullbuffer_t	pvs[2];			// host visible, alternated per frame
+	byte			*pvsdata[2];
+	int				current;
+	qboolean		active;			// culled on the GPU this frame
+} worldculling_t;
+
+static worldculling_t	world_culling;
+static VkDescriptorSet	world_culling_sets[2];
+static byte	*world_vis;	// PVS chosen by R_MarkSurfaces
+
+#define CULL_GROUP_SIZE		64		// local_size_x of world_cull.comp
+#define CULL_UPLOAD_CHUNK	(1024 * 1024)
+
+// what R_RecordWorldBatches draws, from the world cache or the culling buffers
+typedef struct
+{
+	worldbatch_t	*batches;
+	int				numbatches;
+	VkBuffer		index_buffer;
+	VkBuffer		indirect_buffer;	// VK_NULL_HANDLE unless culled on the GPU
+	qboolean		bindless;
+} worlddraw_t;
+
+static worlddraw_t	world_draw;
+
+static qboolean R_CullWorldOnGPU (void);
+
 //==============================================================================
 //
 // SETUP CHAINS
@@ -87,6 +186,8 @@ void R_MarkSurfaces (void)
 	int			i, j;
 	qboolean	nearwaterportal;
 
+	PROF_BEGIN ("R_MarkSurfaces");
+
 	// clear lightmap chains
 	memset (lightmap_polys, 0, sizeof(lightmap_polys));
 
@@ -104,6 +205,7 @@ void R_MarkSurfaces (void)
 		vis = SV_FatPVS (r_origin, cl.worldmodel);
 	else
 		vis = Mod_LeafPVS (r_viewleaf, cl.worldmodel);
+	world_vis = vis;
 
 	// if surface chains don't need regenerating, just add static entities and return
 	if (r_oldviewleaf == r_viewleaf && !vis_changed && !nearwaterportal)
@@ -113,6 +215,7 @@ void R_MarkSurfaces (void)
 			if (vis[i>>3] & (1<<(i&7)))
 				if (leaf->efrags)
 					R_StoreEfrags (&leaf->efrags);
+		PROF_END ();
 		return;
 	}
 
@@ -165,6 +268,8 @@ void R_MarkSurfaces (void)
 		}
 	}
 #endif
+
+	PROF_END ();
 }
 
 /*
@@ -208,10 +313,15 @@ void R_CullSurfaces (void)
 	msurface_t *s;
 	int i;
 	texture_t *t;
+	qboolean gpuculling;
 
+	world_culling.active = false;
 	if (!r_drawworld_cheatsafe)
 		return;
 
+	worldcache_missing = worldcache_extra = 0;
+	gpuculling = R_CullWorldOnGPU ();
+
 // ericw -- instead of testing (s->visframe == r_visframecount) on all world
 // surfaces, use the chained surfaces, which is exactly the same set of sufaces
 	for (i=0 ; i<cl.worldmodel->numtextures ; i++)
@@ -221,13 +331,26 @@ void R_CullSurfaces (void)
 		if (!t || !t->texturechains[chain_world])
 			continue;
 
+		// these are drawn from what the compute shader wrote, leave all of
+		// the PVS to R_BuildLightmapChains
+		if (gpuculling && !(t->texturechains[chain_world]->flags & (SURF_DRAWTILED | SURF_NOTEXTURE)))
+		{
+			for (s = t->texturechains[chain_world]; s; s = s->texturechain)
+				s->culled = false;
+			continue;
+		}
+
 		for (s = t->texturechains[chain_world]; s; s = s->texturechain)
 		{
 			if (R_CullBox(s->mins, s->maxs) || R_BackFaceCull (s))
+			{
 				s->culled = true;
+				worldcache_extra += (s->cachebuild == world_cache.build);
+			}
 			else
 			{
 				s->culled = false;
+				worldcache_missing += (s->cachebuild != world_cache.build);
 				rs_brushpolys++; //count wpolys here
 				if (s->texinfo->texture->warpimage)
 					s->texinfo->texture->update_warp = true;
@@ -459,6 +582,8 @@ static void R_FlushBatch ()
 
 		vkCmdBindIndexBuffer(vulkan_globals.command_buffer, buffer, buffer_offset, VK_INDEX_TYPE_UINT32);
 		vkCmdDrawIndexed(vulkan_globals.command_buffer, num_vbo_indices, 1, 0, 0, 0);
+		COUNT (CNT_DRAWCALLS, 1);
+		COUNT (CNT_TRIANGLES, num_vbo_indices / 3);
 
 		num_vbo_indices = 0;
 	}
@@ -485,6 +610,854 @@ static void R_BatchSurface (msurface_t *s)
 	num_vbo_indices += num_surf_indices;
 }
 
+//==============================================================================
+//
+// WORLD INDEX CACHE
+//
+//==============================================================================
+
+/*
+================
+R_FreeWorldCache
+
+Called on map changes; the cache is created again on first use.
+================
+*/
+void R_FreeWorldCache (void)
+{
+	int i;
+
+	if (world_cache.model)
+	{
+		GL_WaitForDeviceIdle();
+
+		for (i = 0; i < 2; ++i)
+		{
+			vkDestroyBuffer(vulkan_globals.device, world_cache.buffers[i], NULL);
+			vkFreeMemory(vulkan_globals.device, world_cache.memory[i], NULL);
+		}
+		free (world_cache.batches);
+	}
+
+	memset (&world_cache, 0, sizeof(world_cache));
+}
+
+/*
+================
+R_CreateWorldCache
+
+Sizes both index buffers for every surface of the model being visible at once.
+================
+*/
+static void R_CreateWorldCache (qmodel_t *model)
+{
+	VkResult err;
+	int i;
+	uint32_t numindices = 0;
+
+	for (i = 0; i < model->numsurfaces; ++i)
+		numindices += R_NumTriangleIndicesForSurf (&model->surfaces[i]);
+	numindices = q_max(numindices, 3);
+
+	world_cache.model = model;
+	world_cache.capacity = numindices;
+	world_cache.batches = (worldbatch_t *) malloc (model->numsurfaces * sizeof(worldbatch_t));
+	if (!world_cache.batches)
+		Sys_Error ("R_CreateWorldCache: out of memory");
+
+	VkBufferCreateInfo buffer_create_info;
+	memset(&buffer_create_info, 0, sizeof(buffer_create_info));
+	buffer_create_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	buffer_create_info.size = numindices * sizeof(uint32_t);
+	buffer_create_info.usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+
+	for (i = 0; i < 2; ++i)
+	{
+		err = vkCreateBuffer(vulkan_globals.device, &buffer_create_info, NULL, &world_cache.buffers[i]);
+		if (err != VK_SUCCESS)
+			Sys_Error("vkCreateBuffer failed");
+
+		VkMemoryRequirements memory_requirements;
+		vkGetBufferMemoryRequirements(vulkan_globals.device, world_cache.buffers[i], &memory_requirements);
+
+		// host visible: uploads through the staging buffers only land the following frame
+		VkMemoryAllocateInfo memory_allocate_info;
+		memset(&memory_allocate_info, 0, sizeof(memory_allocate_info));
+		memory_allocate_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		memory_allocate_info.allocationSize = memory_requirements.size;
+		memory_allocate_info.memoryTypeIndex = GL_MemoryTypeFromProperties(memory_requirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+
+		err = vkAllocateMemory(vulkan_globals.device, &memory_allocate_info, NULL, &world_cache.memory[i]);
+		if (err != VK_SUCCESS)
+			Sys_Error("vkAllocateMemory failed");
+
+		err = vkBindBufferMemory(vulkan_globals.device, world_cache.buffers[i], world_cache.memory[i], 0);
+		if (err != VK_SUCCESS)
+			Sys_Error("vkBindBufferMemory failed");
+
+		err = vkMapMemory(vulkan_globals.device, world_cache.memory[i], 0, buffer_create_info.size, 0, (void **)&world_cache.data[i]);
+		if (err != VK_SUCCESS)
+			Sys_Error("vkMapMemory failed");
+	}
+}
+
+/*
+================
+R_BuildWorldCache
+
+Writes the indices of all unculled world surfaces, in the same texture and
+lightmap order R_DrawTextureChains_Multitexture batches them, into the buffer
+the previous rebuild didn't use.  That one was last read two frames ago at
+the latest, which GL_BeginRendering has already waited for.
+================
+*/
+static void R_BuildWorldCache (qmodel_t *model)
+{
+	int			i;
+	msurface_t	*s;
+	texture_t	*t;
+	worldbatch_t	*batch;
+	uint32_t	*dest, numindices;
+
+	world_cache.current ^= 1;
+	world_cache.build++;
+	world_cache.numbatches = 0;
+	world_cache.numsurfaces = 0;
+	dest = world_cache.data[world_cache.current];
+	numindices = 0;
+
+	for (i=0 ; i<model->numtextures ; i++)
+	{
+		t = model->textures[i];
+
+		if (!t || !t->texturechains[chain_world] || t->texturechains[chain_world]->flags & (SURF_DRAWTILED | SURF_NOTEXTURE))
+			continue;
+
+		batch = NULL;
+		for (s = t->texturechains[chain_world]; s; s = s->texturechain)
+			if (!s->culled)
+			{
+				if (!batch || s->lightmaptexturenum != batch->lightmap)
+				{
+					batch = &world_cache.batches[world_cache.numbatches++];
+					batch->texture = t;
+					batch->lightmap = s->lightmaptexturenum;
+					batch->numsurfaces = 0;
+					batch->firstindex = numindices;
+					batch->numindices = 0;
+				}
+
+				R_TriangleIndicesForSurf (s, &dest[numindices]);
+				numindices += R_NumTriangleIndicesForSurf (s);
+				batch->numindices += R_NumTriangleIndicesForSurf (s);
+				batch->numsurfaces++;
+				s->cachebuild = world_cache.build;
+				world_cache.numsurfaces++;
+			}
+	}
+
+	world_cache.visframe = r_visframecount;
+	world_cache.valid = true;
+}
+
+/*
+================
+R_UseBindlessWorld
+================
+*/
+static qboolean R_UseBindlessWorld (void)
+{
+	return vulkan_globals.bindless && r_bindless.value;
+}
+
+/*
+================
+R_BeginBindlessWorld
+
+With descriptor indexing every texture lives in one descriptor array, so the
+world pipeline and the array are bound once and each batch only pushes the
+indices of its diffuse, lightmap and fullbright textures.
+================
+*/
+static void R_BeginBindlessWorld (VkCommandBuffer command_buffer)
+{
+	vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkan_globals.world_bindless_pipeline);
+	vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkan_globals.world_bindless_pipeline_layout, 1, 1, &vulkan_globals.bindless_descriptor_set, 0, NULL);
+}
+
+/*
+================
+R_BindlessWorldTexture
+
+Sets the diffuse and fullbright indices for the following draws. The sampler
+set is only rebound when the filtering of the texture differs.
+================
+*/
+static void R_BindlessWorldTexture (VkCommandBuffer command_buffer, gltexture_t *gl_texture, gltexture_t *fullbright, VkDescriptorSet **sampler_set, int32_t *texture_indices)
+{
+	if (*sampler_set != gl_texture->sampler_set)
+	{
+		*sampler_set = gl_texture->sampler_set;
+		vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkan_globals.world_bindless_pipeline_layout, 0, 1, *sampler_set, 0, NULL);
+	}
+
+	texture_indices[0] = gl_texture->bindless_index;
+	texture_indices[2] = fullbright ? fullbright->bindless_index : -1;
+}
+
+/*
+================
+R_BindlessWorldLightmap
+================
+*/
+static void R_BindlessWorldLightmap (VkCommandBuffer command_buffer, int lightmap, int32_t *texture_indices)
+{
+	texture_indices[1] = lightmap_textures[lightmap]->bindless_index;
+	vkCmdPushConstants(command_buffer, vulkan_globals.world_bindless_pipeline_layout, VK_SHADER_STAGE_FRAGMENT_BIT, 16 * sizeof(float), 3 * sizeof(int32_t), texture_indices);
+}
+
+/*
+================
+R_WorldCachePipeline
+================
+*/
+static VkPipeline R_WorldCachePipeline (texture_t *t, gltexture_t **fullbright)
+{
+	if (gl_fullbrights.value && (*fullbright = R_TextureAnimation(t, 0)->fullbright))
+		return vulkan_globals.world_fullbright_pipeline;
+
+	*fullbright = NULL;
+	return vulkan_globals.world_pipeline;
+}
+
+/*
+================
+R_RecordWorldBatches
+
+Records the draws of world_draw. With r_parallel this runs on the recording
+thread, so it only reads the batches and leaves the counting to the caller.
+================
+*/
+static void R_RecordWorldBatches (VkCommandBuffer command_buffer, void *unused)
+{
+	int			i;
+	worldbatch_t	*batch;
+	texture_t	*t = NULL;
+	gltexture_t	*fullbright;
+	VkPipeline	current_pipeline = VK_NULL_HANDLE;
+	VkDescriptorSet	*sampler_set = NULL;
+	int32_t		texture_indices[3];
+
+	VkDeviceSize offset = 0;
+	vkCmdBindVertexBuffers(command_buffer, 0, 1, &bmodel_vertex_buffer, &offset);
+	vkCmdBindIndexBuffer(command_buffer, world_draw.index_buffer, 0, VK_INDEX_TYPE_UINT32);
+	if (world_draw.bindless)
+		R_BeginBindlessWorld (command_buffer);
+
+	for (i = 0, batch = world_draw.batches; i < world_draw.numbatches; i++, batch++)
+	{
+		if (world_draw.bindless)
+		{
+			if (batch->texture != t)
+			{
+				t = batch->texture;
+				fullbright = gl_fullbrights.value ? R_TextureAnimation(t, 0)->fullbright : NULL;
+				R_BindlessWorldTexture (command_buffer, R_TextureAnimation(t, 0)->gltexture, fullbright, &sampler_set, texture_indices);
+			}
+			R_BindlessWorldLightmap (command_buffer, batch->lightmap, texture_indices);
+		}
+		else
+		{
+			if (batch->texture != t)
+			{
+				t = batch->texture;
+
+				VkPipeline pipeline = R_WorldCachePipeline (t, &fullbright);
+				if (fullbright)
+					vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkan_globals.world_pipeline_layout, 3, 1, &fullbright->descriptor_set, 0, NULL);
+				if (current_pipeline != pipeline)
+				{
+					vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+					current_pipeline = pipeline;
+				}
+
+				gltexture_t * gl_texture = R_TextureAnimation(t, 0)->gltexture;
+				vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkan_globals.world_pipeline_layout, 0, 1, gl_texture->sampler_set, 0, NULL);
+				vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkan_globals.world_pipeline_layout, 1, 1, &gl_texture->descriptor_set, 0, NULL);
+			}
+
+			gltexture_t * lightmap_texture = lightmap_textures[batch->lightmap];
+			vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkan_globals.world_pipeline_layout, 2, 1, &lightmap_texture->descriptor_set, 0, NULL);
+		}
+
+		if (world_draw.indirect_buffer)
+			vkCmdDrawIndexedIndirect(command_buffer, world_draw.indirect_buffer, i * sizeof(VkDrawIndexedIndirectCommand), 1, sizeof(VkDrawIndexedIndirectCommand));
+		else
+			vkCmdDrawIndexed(command_buffer, batch->numindices, 1, batch->firstindex, 0, 0);
+	}
+}
+
+/*
+================
+R_DrawWorldBatches
+
+Counts what R_RecordWorldBatches is going to record, then has it recorded,
+in parallel if possible.
+================
+*/
+static void R_DrawWorldBatches (void)
+{
+	int			i;
+	worldbatch_t	*batch;
+	texture_t	*t = NULL;
+	gltexture_t	*fullbright;
+	VkPipeline	current_pipeline = VK_NULL_HANDLE;
+	VkDescriptorSet	*sampler_set = NULL;
+
+	world_draw.bindless = R_UseBindlessWorld ();
+	if (world_draw.bindless)
+	{
+		COUNT (CNT_PIPELINEBINDS, 1);
+		COUNT (CNT_DESCRIPTORSETS, 1);
+	}
+
+	for (i = 0, batch = world_draw.batches; i < world_draw.numbatches; i++, batch++)
+	{
+		if (world_draw.bindless)
+		{
+			if (batch->texture != t)
+			{
+				t = batch->texture;
+
+				gltexture_t * gl_texture = R_TextureAnimation(t, 0)->gltexture;
+				if (sampler_set != gl_texture->sampler_set)
+				{
+					COUNT (CNT_DESCRIPTORSETS, 1);
+					sampler_set = gl_texture->sampler_set;
+				}
+			}
+		}
+		else
+		{
+			if (batch->texture != t)
+			{
+				t = batch->texture;
+
+				VkPipeline pipeline = R_WorldCachePipeline (t, &fullbright);
+				if (fullbright)
+					COUNT (CNT_DESCRIPTORSETS, 1);
+				if (current_pipeline != pipeline)
+				{
+					COUNT (CNT_PIPELINEBINDS, 1);
+					current_pipeline = pipeline;
+				}
+				COUNT (CNT_DESCRIPTORSETS, 2);
+			}
+
+			// the lightmap set is rebound for every batch
+			COUNT (CNT_DESCRIPTORSETS, 1);
+		}
+
+		// indirect draws are only counted, their triangles are up to the GPU
+		COUNT (CNT_DRAWCALLS, 1);
+		if (!world_draw.indirect_buffer)
+		{
+			COUNT (CNT_TRIANGLES, batch->numindices / 3);
+			rs_brushpasses += batch->numsurfaces;
+		}
+	}
+
+	GL_RecordParallel (R_RecordWorldBatches, NULL);
+}
+
+/*
+================
+R_DrawWorldCache
+
+Draws the world from the cached index buffer, rebuilding it first if the PVS
+changed, a visible surface is missing from it, or too many of the surfaces it
+draws are culled by now.
+================
+*/
+static void R_DrawWorldCache (qmodel_t *model)
+{
+	if (world_cache.model != model)
+	{
+		R_FreeWorldCache ();
+		R_CreateWorldCache (model);
+	}
+
+	if (!world_cache.valid || world_cache.visframe != r_visframecount || worldcache_missing ||
+		worldcache_extra * WORLDCACHE_SLACK > world_cache.numsurfaces)
+		R_BuildWorldCache (model);
+
+	world_draw.batches = world_cache.batches;
+	world_draw.numbatches = world_cache.numbatches;
+	world_draw.index_buffer = world_cache.buffers[world_cache.current];
+	world_draw.indirect_buffer = VK_NULL_HANDLE;
+	R_DrawWorldBatches ();
+}
+
+//==============================================================================
+//
+// GPU WORLD CULLING
+//
+//==============================================================================
+
+/*
+================
+R_CreateCullBuffer
+================
+*/
+static void R_CreateCullBuffer (cullbuffer_t *dest, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties)
+{
+	VkResult err;
+
+	VkBufferCreateInfo buffer_create_info;
+	memset(&buffer_create_info, 0, sizeof(buffer_create_info));
+	buffer_create_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	buffer_create_info.size = q_max(size, sizeof(uint32_t));
+	buffer_create_info.usage = usage;
+
+	err = vkCreateBuffer(vulkan_globals.device, &buffer_create_info, NULL, &dest->buffer);
+	if (err != VK_SUCCESS)
+		Sys_Error("vkCreateBuffer failed");
+
+	VkMemoryRequirements memory_requirements;
+	vkGetBufferMemoryRequirements(vulkan_globals.device, dest->buffer, &memory_requirements);
+
+	VkMemoryAllocateInfo memory_allocate_info;
+	memset(&memory_allocate_info, 0, sizeof(memory_allocate_info));
+	memory_allocate_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	memory_allocate_info.allocationSize = memory_requirements.size;
+	memory_allocate_info.memoryTypeIndex = GL_MemoryTypeFromProperties(memory_requirements.memoryTypeBits, properties);
+
+	err = vkAllocateMemory(vulkan_globals.device, &memory_allocate_info, NULL, &dest->memory);
+	if (err != VK_SUCCESS)
+		Sys_Error("vkAllocateMemory failed");
+
+	err = vkBindBufferMemory(vulkan_globals.device, dest->buffer, dest->memory, 0);
+	if (err != VK_SUCCESS)
+		Sys_Error("vkBindBufferMemory failed");
+}
+
+/*
+================
+R_UploadCullBuffer
+
+Goes through the staging buffers in chunks, large maps have more indices
+than fit into one.
+================
+*/
+static void R_UploadCullBuffer (cullbuffer_t *dest, const void *data, int size)
+{
+	int offset, chunk;
+
+	for (offset = 0; offset < size; offset += chunk)
+	{
+		VkBuffer staging_buffer;
+		VkCommandBuffer command_buffer;
+		int staging_offset;
+
+		chunk = q_min(size - offset, CULL_UPLOAD_CHUNK);
+		byte * staging_memory = R_StagingAllocate(chunk, &command_buffer, &staging_buffer, &staging_offset);
+		memcpy(staging_memory, (const byte *)data + offset, chunk);
+
+		VkBufferCopy region;
+		region.srcOffset = staging_offset;
+		region.dstOffset = offset;
+		region.size = chunk;
+		vkCmdCopyBuffer(command_buffer, staging_buffer, dest->buffer, 1, &region);
+	}
+}
+
+/*
+================
+R_DestroyCullBuffer
+================
+*/
+static void R_DestroyCullBuffer (cullbuffer_t *buffer)
+{
+	vkDestroyBuffer(vulkan_globals.device, buffer->buffer, NULL);
+	vkFreeMemory(vulkan_globals.device, buffer->memory, NULL);
+}
+
+/*
+================
+R_FreeWorldCulling
+
+Called on map changes; everything is created again on first use.
+================
+*/
+void R_FreeWorldCulling (void)
+{
+	int i;
+
+	if (world_culling.model)
+	{
+		GL_WaitForDeviceIdle();
+
+		R_DestroyCullBuffer (&world_culling.surfaces);
+		R_DestroyCullBuffer (&world_culling.leafs);
+		R_DestroyCullBuffer (&world_culling.source_indices);
+		R_DestroyCullBuffer (&world_culling.indices);
+		R_DestroyCullBuffer (&world_culling.cleared_draws);
+		R_DestroyCullBuffer (&world_culling.draws);
+		for (i = 0; i < 2; ++i)
+			R_DestroyCullBuffer (&world_culling.pvs[i]);
+		free (world_culling.batches);
+		free (world_culling.skyleafs);
+	}
+
+	memset (&world_culling, 0, sizeof(world_culling));
+}
+
+/*
+================
+R_CullSurfaceOrder
+
+Same texture and lightmap order as R_BuildWorldCache.
+================
+*/
+static int R_CullSurfaceOrder (const void *a, const void *b)
+{
+	const msurface_t *s1 = *(msurface_t * const *)a;
+	const msurface_t *s2 = *(msurface_t * const *)b;
+
+	if (s1->texinfo->texture != s2->texinfo->texture)
+		return ((uintptr_t)s1->texinfo->texture < (uintptr_t)s2->texinfo->texture) ? -1 : 1;
+	if (s1->lightmaptexturenum != s2->lightmaptexturenum)
+		return s1->lightmaptexturenum - s2->lightmaptexturenum;
+	return (int)(s1 - s2);
+}
+
+/*
+================
+R_UpdateWorldCullingSets
+================
+*/
+static void R_UpdateWorldCullingSets (void)
+{
+	int i, j;
+	VkDescriptorBufferInfo buffer_infos[6];
+	VkWriteDescriptorSet writes[6];
+
+	if (!world_culling_sets[0])
+	{
+		VkDescriptorSetLayout layouts[2] = { vulkan_globals.world_cull_set_layout, vulkan_globals.world_cull_set_layout };
+
+		VkDescriptorSetAllocateInfo descriptor_set_allocate_info;
+		memset(&descriptor_set_allocate_info, 0, sizeof(descriptor_set_allocate_info));
+		descriptor_set_allocate_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		descriptor_set_allocate_info.descriptorPool = vulkan_globals.descriptor_pool;
+		descriptor_set_allocate_info.descriptorSetCount = 2;
+		descriptor_set_allocate_info.pSetLayouts = layouts;
+
+		if (vkAllocateDescriptorSets(vulkan_globals.device, &descriptor_set_allocate_info, world_culling_sets) != VK_SUCCESS)
+			Sys_Error("vkAllocateDescriptorSets failed");
+	}
+
+	for (i = 0; i < 2; ++i)
+	{
+		cullbuffer_t *buffers[6] = {
+			&world_culling.surfaces,
+			&world_culling.leafs,
+			&world_culling.source_indices,
+			&world_culling.pvs[i],
+			&world_culling.indices,
+			&world_culling.draws
+		};
+
+		memset(buffer_infos, 0, sizeof(buffer_infos));
+		memset(writes, 0, sizeof(writes));
+		for (j = 0; j < 6; ++j)
+		{
+			buffer_infos[j].buffer = buffers[j]->buffer;
+			buffer_infos[j].offset = 0;
+			buffer_infos[j].range = VK_WHOLE_SIZE;
+
+			writes[j].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			writes[j].dstSet = world_culling_sets[i];
+			writes[j].dstBinding = j;
+			writes[j].dstArrayElement = 0;
+			writes[j].descriptorCount = 1;
+			writes[j].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			writes[j].pBufferInfo = &buffer_infos[j];
+		}
+
+		vkUpdateDescriptorSets(vulkan_globals.device, 6, writes, 0, NULL);
+	}
+}
+
+/*
+================
+R_CreateWorldCulling
+
+Sorts the world surfaces drawn by R_DrawTextureChains_Multitexture into
+batches and uploads their bounds, planes, indices and the leafs marking them.
+================
+*/
+static void R_CreateWorldCulling (qmodel_t *model)
+{
+	int			i, j, numsurfaces, numleafrefs;
+	int			*surfacemap;
+	msurface_t	*s, **surfaces, **mark;
+	mleaf_t		*leaf;
+	cullsurface_t	*cullsurfaces, *cs;
+	worldbatch_t	*batch;
+	uint32_t	*leafrefs, *source_indices, numindices;
+	VkDrawIndexedIndirectCommand	*draws;
+
+	world_culling.model = model;
+
+	surfaces = (msurface_t **) malloc (q_max(model->nummodelsurfaces, 1) * sizeof(msurface_t *));
+	surfacemap = (int *) malloc (q_max(model->numsurfaces, 1) * sizeof(int));
+	if (!surfaces || !surfacemap)
+		Sys_Error ("R_CreateWorldCulling: out of memory");
+
+	numsurfaces = 0;
+	numindices = 0;
+	for (i = 0, s = &model->surfaces[model->firstmodelsurface]; i < model->nummodelsurfaces; i++, s++)
+		if (!(s->flags & (SURF_DRAWTILED | SURF_NOTEXTURE)))
+		{
+			surfaces[numsurfaces++] = s;
+			numindices += R_NumTriangleIndicesForSurf (s);
+		}
+
+	if (!numsurfaces)
+	{
+		free (surfaces);
+		free (surfacemap);
+		return;
+	}
+
+	qsort (surfaces, numsurfaces, sizeof(msurface_t *), R_CullSurfaceOrder);
+
+	cullsurfaces = (cullsurface_t *) calloc (numsurfaces, sizeof(cullsurface_t));
+	source_indices = (uint32_t *) malloc (numindices * sizeof(uint32_t));
+	draws = (VkDrawIndexedIndirectCommand *) calloc (numsurfaces, sizeof(VkDrawIndexedIndirectCommand));
+	world_culling.batches = (worldbatch_t *) malloc (numsurfaces * sizeof(worldbatch_t));
+	world_culling.pvsbytes = ((model->numleafs + 31) >> 5) * 4;
+	world_culling.skyleafs = (byte *) calloc (world_culling.pvsbytes, 1);
+	if (!cullsurfaces || !source_indices || !draws || !world_culling.batches || !world_culling.skyleafs)
+		Sys_Error ("R_CreateWorldCulling: out of memory");
+
+	for (i = 0; i < model->numsurfaces; i++)
+		surfacemap[i] = -1;
+
+	// surfaces and batches
+	batch = NULL;
+	numindices = 0;
+	for (i = 0, cs = cullsurfaces; i < numsurfaces; i++, cs++)
+	{
+		s = surfaces[i];
+		surfacemap[s - model->surfaces] = i;
+
+		if (!batch || s->texinfo->texture != batch->texture || s->lightmaptexturenum != batch->lightmap)
+		{
+			batch = &world_culling.batches[world_culling.numbatches++];
+			batch->texture = s->texinfo->texture;
+			batch->lightmap = s->lightmaptexturenum;
+			batch->numsurfaces = 0;
+			batch->firstindex = numindices;
+			batch->numindices = 0;
+		}
+
+		VectorCopy (s->plane->normal, cs->plane);
+		cs->plane[3] = s->plane->dist;
+		cs->planeback = (s->flags & SURF_PLANEBACK) ? 1 : 0;
+		VectorCopy (s->mins, cs->mins);
+		VectorCopy (s->maxs, cs->maxs);
+		cs->batch = world_culling.numbatches - 1;
+		cs->firstindex = numindices;
+		cs->numindices = R_NumTriangleIndicesForSurf (s);
+
+		R_TriangleIndicesForSurf (s, &source_indices[numindices]);
+		numindices += cs->numindices;
+		batch->numindices += cs->numindices;
+		batch->numsurfaces++;
+	}
+
+	for (i = 0, batch = world_culling.batches; i < world_culling.numbatches; i++, batch++)
+	{
+		draws[i].indexCount = 0;
+		draws[i].instanceCount = 1;
+		draws[i].firstIndex = batch->firstindex;
+		draws[i].vertexOffset = 0;
+		draws[i].firstInstance = 0;
+	}
+
+	// leafs, numbered like the PVS bits, so leafs[1] is 0
+	numleafrefs = 0;
+	for (i = 0, leaf = &model->leafs[1]; i < model->numleafs; i++, leaf++)
+	{
+		if (leaf->contents == CONTENTS_SKY)
+			world_culling.skyleafs[i >> 3] |= 1 << (i & 7);
+
+		for (j = 0, mark = leaf->firstmarksurface; j < leaf->nummarksurfaces; j++, mark++)
+			if (surfacemap[*mark - model->surfaces] >= 0)
+			{
+				cullsurfaces[surfacemap[*mark - model->surfaces]].numleafs++;
+				numleafrefs++;
+			}
+	}
+
+	leafrefs = (uint32_t *) malloc (q_max(numleafrefs, 1) * sizeof(uint32_t));
+	if (!leafrefs)
+		Sys_Error ("R_CreateWorldCulling: out of memory");
+
+	numleafrefs = 0;
+	for (i = 0, cs = cullsurfaces; i < numsurfaces; i++, cs++)
+	{
+		cs->firstleaf = numleafrefs;
+		numleafrefs += cs->numleafs;
+		cs->numleafs = 0;
+	}
+
+	for (i = 0, leaf = &model->leafs[1]; i < model->numleafs; i++, leaf++)
+		for (j = 0, mark = leaf->firstmarksurface; j < leaf->nummarksurfaces; j++, mark++)
+			if (surfacemap[*mark - model->surfaces] >= 0)
+			{
+				cs = &cullsurfaces[surfacemap[*mark - model->surfaces]];
+				leafrefs[cs->firstleaf + cs->numleafs++] = i;
+			}
+
+	// buffers
+	R_CreateCullBuffer (&world_culling.surfaces, numsurfaces * sizeof(cullsurface_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	R_CreateCullBuffer (&world_culling.leafs, numleafrefs * sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	R_CreateCullBuffer (&world_culling.source_indices, numindices * sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	R_CreateCullBuffer (&world_culling.indices, numindices * sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	R_CreateCullBuffer (&world_culling.cleared_draws, world_culling.numbatches * sizeof(VkDrawIndexedIndirectCommand), VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	R_CreateCullBuffer (&world_culling.draws, world_culling.numbatches * sizeof(VkDrawIndexedIndirectCommand), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	for (i = 0; i < 2; ++i)
+	{
+		R_CreateCullBuffer (&world_culling.pvs[i], world_culling.pvsbytes, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+		if (vkMapMemory(vulkan_globals.device, world_culling.pvs[i].memory, 0, world_culling.pvsbytes, 0, (void **)&world_culling.pvsdata[i]) != VK_SUCCESS)
+			Sys_Error("vkMapMemory failed");
+	}
+
+	R_UploadCullBuffer (&world_culling.surfaces, cullsurfaces, numsurfaces * sizeof(cullsurface_t));
+	R_UploadCullBuffer (&world_culling.leafs, leafrefs, numleafrefs * sizeof(uint32_t));
+	R_UploadCullBuffer (&world_culling.source_indices, source_indices, numindices * sizeof(uint32_t));
+	R_UploadCullBuffer (&world_culling.cleared_draws, draws, world_culling.numbatches * sizeof(VkDrawIndexedIndirectCommand));
+
+	R_UpdateWorldCullingSets ();
+
+	world_culling.numsurfaces = numsurfaces;
+
+	free (leafrefs);
+	free (draws);
+	free (source_indices);
+	free (cullsurfaces);
+	free (surfacemap);
+	free (surfaces);
+}
+
+/*
+================
+R_CullWorldOnGPU
+
+Records the culling dispatch ahead of the main render pass. Returns true if
+the world surfaces of R_DrawTextureChains_Multitexture are culled on the GPU
+this frame, in which case R_CullSurfaces leaves them alone.
+================
+*/
+static qboolean R_CullWorldOnGPU (void)
+{
+	int			i, visbytes;
+	byte		*pvs;
+	VkCommandBuffer	command_buffer = vulkan_globals.command_buffer;
+
+	if (!vulkan_globals.gpu_culling || !r_gpuculling.value || isHeadless)
+		return false;
+
+	if (world_culling.model != cl.worldmodel)
+	{
+		// the uploads are submitted with the next frame, cull on the CPU until then
+		R_FreeWorldCulling ();
+		R_CreateWorldCulling (cl.worldmodel);
+		return false;
+	}
+
+	if (!world_culling.numsurfaces)
+		return false;
+
+	// the buffer not used by the previous frame was last read two frames
+	// ago at the latest, which GL_BeginRendering has already waited for
+	world_culling.current ^= 1;
+	pvs = world_culling.pvsdata[world_culling.current];
+	visbytes = (cl.worldmodel->numleafs + 7) >> 3;
+	if (r_oldskyleaf.value)
+		memcpy (pvs, world_vis, visbytes);
+	else
+		for (i = 0; i < visbytes; i++)
+			pvs[i] = world_vis[i] & ~world_culling.skyleafs[i];
+	memset (pvs + visbytes, 0, world_culling.pvsbytes - visbytes);
+
+	struct
+	{
+		float		frustum[4][4];
+		float		vieworg[3];
+		uint32_t	numsurfaces;
+	} push_constants;
+
+	for (i = 0; i < 4; i++)
+	{
+		VectorCopy (frustum[i].normal, push_constants.frustum[i]);
+		push_constants.frustum[i][3] = frustum[i].dist;
+	}
+	VectorCopy (r_refdef.vieworg, push_constants.vieworg);
+	push_constants.numsurfaces = world_culling.numsurfaces;
+
+	// the previous frame may still be drawing from the indices and draws,
+	// and the first frame needs the staging copies
+	VkMemoryBarrier memory_barrier;
+	memset(&memory_barrier, 0, sizeof(memory_barrier));
+	memory_barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	memory_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	memory_barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_READ_BIT;
+	vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+		VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &memory_barrier, 0, NULL, 0, NULL);
+
+	VkBufferCopy region;
+	region.srcOffset = 0;
+	region.dstOffset = 0;
+	region.size = world_culling.numbatches * sizeof(VkDrawIndexedIndirectCommand);
+	vkCmdCopyBuffer(command_buffer, world_culling.cleared_draws.buffer, world_culling.draws.buffer, 1, &region);
+
+	memory_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	memory_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+	vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &memory_barrier, 0, NULL, 0, NULL);
+
+	vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, vulkan_globals.world_cull_pipeline);
+	vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, vulkan_globals.world_cull_pipeline_layout, 0, 1, &world_culling_sets[world_culling.current], 0, NULL);
+	vkCmdPushConstants(command_buffer, vulkan_globals.world_cull_pipeline_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(push_constants), &push_constants);
+	vkCmdDispatch(command_buffer, (world_culling.numsurfaces + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE, 1, 1);
+	COUNT (CNT_PIPELINEBINDS, 1);
+
+	memory_barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	memory_barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_INDEX_READ_BIT;
+	vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, 0, 1, &memory_barrier, 0, NULL, 0, NULL);
+
+	world_culling.active = true;
+	world_cache.valid = false;
+	return true;
+}
+
+/*
+================
+R_DrawCulledWorld
+================
+*/
+static void R_DrawCulledWorld (void)
+{
+	world_draw.batches = world_culling.batches;
+	world_draw.numbatches = world_culling.numbatches;
+	world_draw.index_buffer = world_culling.indices.buffer;
+	world_draw.indirect_buffer = world_culling.draws.buffer;
+	R_DrawWorldBatches ();
+}
+
 /*
 ================
 R_DrawTextureChains_NoTexture -- johnfitz
@@ -600,6 +1573,7 @@ void R_DrawTextureChains_Water (qmodel_t *model, entity_t *ent, texchain_t chain
 	float color[3] = { 1.0f, 1.0f, 1.0f };
 
 	vkCmdBindPipeline(vulkan_globals.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkan_globals.water_pipeline);
+	COUNT (CNT_PIPELINEBINDS, 1);
 
 	for (i=0 ; i<model->numtextures ; i++)
 	{
@@ -617,6 +1591,7 @@ void R_DrawTextureChains_Water (qmodel_t *model, entity_t *ent, texchain_t chain
 					R_BeginTransparentDrawing (entalpha);
 					vkCmdBindDescriptorSets(vulkan_globals.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkan_globals.basic_pipeline_layout, 0, 1, t->warpimage->sampler_set, 0, NULL);
 					vkCmdBindDescriptorSets(vulkan_globals.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkan_globals.basic_pipeline_layout, 1, 1, &t->warpimage->descriptor_set, 0, NULL);
+					COUNT (CNT_DESCRIPTORSETS, 2);
 
 					if (model != cl.worldmodel)
 					{
@@ -709,11 +1684,39 @@ void R_DrawTextureChains_Multitexture (qmodel_t *model, entity_t *ent, texchain_
 	qboolean	bound;
 	int		lastlightmap;
 	gltexture_t	*fullbright = NULL;
-	
+
+	if (chain == chain_world && ent == NULL)
+	{
+		if (world_culling.active)
+		{
+			R_DrawCulledWorld ();
+			return;
+		}
+		if (r_worldcache.value)
+		{
+			R_DrawWorldCache (model);
+			return;
+		}
+		world_cache.valid = false;
+	}
+
 	VkDeviceSize offset = 0;
 	vkCmdBindVertexBuffers(vulkan_globals.command_buffer, 0, 1, &bmodel_vertex_buffer, &offset);
-	vkCmdBindPipeline(vulkan_globals.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkan_globals.world_pipeline);
-	VkPipeline current_pipeline = vulkan_globals.world_pipeline;
+	VkPipeline current_pipeline = VK_NULL_HANDLE;
+	VkDescriptorSet *sampler_set = NULL;
+	int32_t texture_indices[3];
+	qboolean bindless = R_UseBindlessWorld ();
+	if (bindless)
+	{
+		R_BeginBindlessWorld (vulkan_globals.command_buffer);
+		COUNT (CNT_PIPELINEBINDS, 1);
+	}
+	else
+	{
+		vkCmdBindPipeline(vulkan_globals.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkan_globals.world_pipeline);
+		COUNT (CNT_PIPELINEBINDS, 1);
+		current_pipeline = vulkan_globals.world_pipeline;
+	}
 
 	for (i=0 ; i<model->numtextures ; i++)
 	{
@@ -723,19 +1726,24 @@ void R_DrawTextureChains_Multitexture (qmodel_t *model, entity_t *ent, texchain_
 			continue;
 
 	// Enable/disable TMU 2 (fullbrights)
-		if (gl_fullbrights.value && (fullbright = R_TextureAnimation(t, ent != NULL ? ent->frame : 0)->fullbright))
+		if (bindless)
+			fullbright = gl_fullbrights.value ? R_TextureAnimation(t, ent != NULL ? ent->frame : 0)->fullbright : NULL;
+		else if (gl_fullbrights.value && (fullbright = R_TextureAnimation(t, ent != NULL ? ent->frame : 0)->fullbright))
 		{
 			if (current_pipeline != vulkan_globals.world_fullbright_pipeline)
 			{
 				vkCmdBindPipeline(vulkan_globals.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkan_globals.world_fullbright_pipeline);
+				COUNT (CNT_PIPELINEBINDS, 1);
 				current_pipeline = vulkan_globals.world_fullbright_pipeline;
 			}
 
 			vkCmdBindDescriptorSets(vulkan_globals.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkan_globals.world_pipeline_layout, 3, 1, &fullbright->descriptor_set, 0, NULL);
+			COUNT (CNT_DESCRIPTORSETS, 1);
 		}
 		else if (current_pipeline != vulkan_globals.world_pipeline)
 		{
 			vkCmdBindPipeline(vulkan_globals.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkan_globals.world_pipeline);
+			COUNT (CNT_PIPELINEBINDS, 1);
 			current_pipeline = vulkan_globals.world_pipeline;
 		}
 
@@ -750,23 +1758,37 @@ void R_DrawTextureChains_Multitexture (qmodel_t *model, entity_t *ent, texchain_
 				{
 					texture_t * texture = R_TextureAnimation(t, ent != NULL ? ent->frame : 0);
 					gltexture_t * gl_texture = texture->gltexture;
-					vkCmdBindDescriptorSets(vulkan_globals.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkan_globals.world_pipeline_layout, 0, 1, gl_texture->sampler_set, 0, NULL);
-					vkCmdBindDescriptorSets(vulkan_globals.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkan_globals.world_pipeline_layout, 1, 1, &gl_texture->descriptor_set, 0, NULL);
+					if (bindless)
+						R_BindlessWorldTexture (vulkan_globals.command_buffer, gl_texture, fullbright, &sampler_set, texture_indices);
+					else
+					{
+						vkCmdBindDescriptorSets(vulkan_globals.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkan_globals.world_pipeline_layout, 0, 1, gl_texture->sampler_set, 0, NULL);
+						vkCmdBindDescriptorSets(vulkan_globals.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkan_globals.world_pipeline_layout, 1, 1, &gl_texture->descriptor_set, 0, NULL);
+						COUNT (CNT_DESCRIPTORSETS, 2);
+					}
 
 					//if (t->texturechains[chain]->flags & SURF_DRAWFENCE)
 					//	glEnable (GL_ALPHA_TEST); // Flip alpha test back on
 										
 					bound = true;
-					lastlightmap = s->lightmaptexturenum;
+					lastlightmap = -1;
 				}
-				
+
 				if (s->lightmaptexturenum != lastlightmap)
+				{
 					R_FlushBatch ();
 
-				gltexture_t * lightmap_texture = lightmap_textures[s->lightmaptexturenum];
-				vkCmdBindDescriptorSets(vulkan_globals.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkan_globals.world_pipeline_layout, 2, 1, &lightmap_texture->descriptor_set, 0, NULL);
+					if (bindless)
+						R_BindlessWorldLightmap (vulkan_globals.command_buffer, s->lightmaptexturenum, texture_indices);
+					else
+					{
+						gltexture_t * lightmap_texture = lightmap_textures[s->lightmaptexturenum];
+						vkCmdBindDescriptorSets(vulkan_globals.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkan_globals.world_pipeline_layout, 2, 1, &lightmap_texture->descriptor_set, 0, NULL);
+						COUNT (CNT_DESCRIPTORSETS, 1);
+					}
+					lastlightmap = s->lightmaptexturenum;
+				}
 
-				lastlightmap = s->lightmaptexturenum;
 				R_BatchSurface (s);
 
 				rs_brushpasses++;
@@ -1113,7 +1113,7 @@ void Sbar_DeathmatchOverlay (void)
 
 	x = 80; //johnfitz -- simplified becuase some positioning is handled elsewhere
 	y = 40;
-	for (i = 0; i < l; i++)
+	for (i = 0; i < l && y <= 200 - 8; i++) // stop at the bottom of the canvas on big servers
 	{
 		k = fragsort[i];
 		s = &cl.scores[k];
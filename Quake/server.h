@@ -74,6 +74,8 @@ typedef struct
 	byte		signon_buf[MAX_MSGLEN-2]; //johnfitz -- was 8192, now uses MAX_MSGLEN
 
 	unsigned	protocol; //johnfitz
+
+	int			hunkmark;			// while loading with other instances running, see SV_AbortSpawn
 } server_t;
 
 
@@ -97,7 +99,7 @@ typedef struct client_s
 
 	sizebuf_t		message;			// can be added to at any time,
 										// copied and clear once per frame
-	byte			msgbuf[MAX_MSGLEN];
+										// grows from the message pool up to MAX_MSGLEN
 	edict_t			*edict;				// EDICT_NUM(clientnum+1)
 	char			name[32];			// for printing to other people
 	int				colors;
@@ -181,8 +183,59 @@ extern	cvar_t	coop;
 extern	cvar_t	fraglimit;
 extern	cvar_t	timelimit;
 
-extern	server_static_t	svs;				// persistant server info
-extern	server_t		sv;					// local server
+//============================================================================
+
+typedef struct areanode_s
+{
+	int		axis;		// -1 = leaf node
+	float	dist;
+	struct areanode_s	*children[2];
+	link_t	trigger_edicts;
+	link_t	solid_edicts;
+} areanode_t;
+
+#define	AREA_DEPTH	4
+#define	AREA_NODES	32
+
+// everything that belongs to one game.  A dedicated server can run several
+// (see sv_inst.c), sv_context points at the one being run and the names
+// below are how the rest of the engine gets at its fields.
+typedef struct
+{
+	server_static_t	serverstatic;
+	server_t		server;
+
+	areanode_t		areanodes[AREA_NODES];		// world.c
+	int				numareanodes;
+
+	globalvars_t	*globalstruct;				// pr_edict.c
+	float			*globals;
+	const char		**knownstrings;
+	int				maxknownstrings;
+	int				numknownstrings;
+	void			*allocstrings;
+
+	byte			checkclientpvs[MAX_MAP_LEAFS/8];	// pr_cmds.c
+
+	sizebuf_t		cmdtext;					// cmd.c
+	qboolean		cmdwait;
+
+	int				currentskill;				// host_cmd.c
+	int				hostport;					// net_main.c
+	int				activeconnections;
+} svcontext_t;
+
+extern	svcontext_t	*sv_context;
+
+#define	svs						(sv_context->serverstatic)	// persistant server info
+#define	sv						(sv_context->server)		// local server
+#define	pr_global_struct		(sv_context->globalstruct)
+#define	pr_globals				(sv_context->globals)		// same as pr_global_struct
+#define	cmd_text				(sv_context->cmdtext)
+#define	cmd_wait				(sv_context->cmdwait)
+#define	current_skill			(sv_context->currentskill)	// skill of the loaded level, not the cvar
+#define	net_hostport			(sv_context->hostport)
+#define	net_activeconnections	(sv_context->activeconnections)
 
 extern	client_t	*host_client;
 
@@ -226,6 +279,26 @@ void SV_CheckForNewClients (void);
 void SV_RunClients (void);
 void SV_SaveSpawnparms ();
 void SV_SpawnServer (const char *server);
+void SV_AbortSpawn (void);
+
+// sv_inst.c
+void SV_InitInstances (void);
+int SV_NumInstances (void);
+int SV_CurrentInstance (void);
+void SV_SwitchInstance (int num);
+void SV_RunInstances (void);
+void SV_ShutdownInstances (void);
+
+// sv_replay.c
+void SV_InitReplay (void);
+qboolean SV_Replaying (void);
+void SV_RecordSpawn (const char *mapname);
+qboolean SV_RecordFrame (void);
+void SV_RecordFrameEnd (void);
+void SV_RecordConnect (int clientnum);
+void SV_RecordMessage (int clientnum, int ret);
+void SV_RecordShutdown (void);
+struct qsocket_s *SV_ReplayConnection (void);
 
 #endif	/* _QUAKE_SERVER_H */
 
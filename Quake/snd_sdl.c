@@ -32,6 +32,10 @@
 
 static int	buffersize;
 
+/* -headless mixes into a buffer nobody plays, paced by the clock */
+static qboolean	nulldevice;
+static double	nullstarttime;
+
 
 static void paint_audio (void *unused, Uint8 *stream, int len)
 {
@@ -74,12 +78,42 @@ static void paint_audio (void *unused, Uint8 *stream, int len)
 		shm->samplepos = 0;
 }
 
+static qboolean SNDDMA_InitNull (dma_t *dma)
+{
+	memset ((void *) dma, 0, sizeof(dma_t));
+	shm = dma;
+
+	shm->samplebits = 16;
+	shm->speed = snd_mixspeed.value;
+	shm->channels = 2;
+	shm->samples = 32768;
+	shm->samplepos = 0;
+	shm->submission_chunk = 1;
+
+	buffersize = shm->samples * (shm->samplebits / 8);
+	shm->buffer = (unsigned char *) calloc (1, buffersize);
+	if (!shm->buffer)
+	{
+		shm = NULL;
+		Con_Printf ("Failed allocating memory for null sound device\n");
+		return false;
+	}
+
+	Con_Printf ("Null sound device: %d Hz, %d bytes buffer\n", shm->speed, buffersize);
+	nulldevice = true;
+	nullstarttime = Sys_DoubleTime ();
+	return true;
+}
+
 qboolean SNDDMA_Init (dma_t *dma)
 {
 	SDL_AudioSpec desired, obtained;
 	int		tmp, val;
 	char	drivername[128];
 
+	if (isHeadless)
+		return SNDDMA_InitNull (dma);
+
 	if (SDL_InitSubSystem(SDL_INIT_AUDIO) < 0)
 	{
 		Con_Printf("Couldn't init SDL audio: %s\n", SDL_GetError());
@@ -178,11 +212,20 @@ qboolean SNDDMA_Init (dma_t *dma)
 
 int SNDDMA_GetDMAPos (void)
 {
+	if (nulldevice)
+		shm->samplepos = (int)((Sys_DoubleTime () - nullstarttime) * shm->speed * shm->channels) & (shm->samples - 1);
 	return shm->samplepos;
 }
 
 void SNDDMA_Shutdown (void)
 {
+	if (shm && nulldevice)
+	{
+		free (shm->buffer);
+		shm->buffer = NULL;
+		shm = NULL;
+		nulldevice = false;
+	}
 	if (shm)
 	{
 		Con_Printf ("Shutting down SDL sound\n");
@@ -197,21 +240,25 @@ void SNDDMA_Shutdown (void)
 
 void SNDDMA_LockBuffer (void)
 {
-	SDL_LockAudio ();
+	if (!nulldevice)
+		SDL_LockAudio ();
 }
 
 void SNDDMA_Submit (void)
 {
-	SDL_UnlockAudio();
+	if (!nulldevice)
+		SDL_UnlockAudio();
 }
 
 void SNDDMA_BlockSound (void)
 {
-	SDL_PauseAudio(1);
+	if (!nulldevice)
+		SDL_PauseAudio(1);
 }
 
 void SNDDMA_UnblockSound (void)
 {
-	SDL_PauseAudio(0);
+	if (!nulldevice)
+		SDL_PauseAudio(0);
 }
 
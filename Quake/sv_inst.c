@@ -0,0 +1,413 @@
+/*
+Copyright (C) 1996-2001 Id Software, Inc.
+Copyright (C) 2002-2009 John Fitzgibbons and others
+Copyright (C) 2010-2014 QuakeSpasm developers
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+// sv_inst.c -- several independent games in one dedicated server process
+
+#include "quakedef.h"
+
+/*
+==============================================================================
+
+Everything that belongs to one game (sv, svs, the progs globals, the area
+nodes, the command buffer...) lives in an svcontext_t, and the names the
+engine uses for it go through sv_context.  SV_SwitchInstance points
+sv_context at another instance's context, nothing is copied.  State that
+is kept from one frame to the next and is not in svcontext_t is shared by
+all instances.
+
+Instance 0 is the regular server.  On dedicated servers instance_start
+adds more, each listening on its own port with its own clients, edicts,
+progs globals and game cvars.  Models, paks and the loaded progs.dat image
+are shared; while extra instances run the hunk is never cleared, and a map
+that does not fit in what is left is refused (see SV_SpawnServer).
+
+==============================================================================
+*/
+
+#define	MAX_INSTANCES		16
+#define	INSTANCE_CMDSIZE	8192
+
+// game settings every instance keeps for itself
+static const char	*sv_instcvarnames[] =
+{
+	"hostname", "deathmatch", "coop", "skill", "teamplay", "fraglimit",
+	"timelimit", "noexit", "samelevel", "pausable", "nomonsters",
+	"sv_gravity", "sv_friction", "sv_maxspeed"
+};
+#define	NUM_INSTANCECVARS	((int)(sizeof(sv_instcvarnames) / sizeof(sv_instcvarnames[0])))
+
+static cvar_t	*sv_instcvars[NUM_INSTANCECVARS];
+
+typedef struct
+{
+	qboolean	inuse;
+	svcontext_t	*context;
+	const char	*cvarstrings[NUM_INSTANCECVARS];	// cvar strings while not active
+	struct netlisten_s	*listen;
+	byte		*cmdbuf;
+} serverinstance_t;
+
+static serverinstance_t	sv_instances[MAX_INSTANCES];
+static int		sv_current;
+static int		sv_numinstances;	// running besides instance 0
+
+int SV_NumInstances (void)
+{
+	return sv_numinstances;
+}
+
+int SV_CurrentInstance (void)
+{
+	return sv_current;
+}
+
+static void SV_SaveCvars (serverinstance_t *inst)
+{
+	int		i;
+
+	// the strings are Z_Malloc'd by cvar.c, so just hand them over
+	for (i = 0; i < NUM_INSTANCECVARS; i++)
+	{
+		if (sv_instcvars[i])
+			inst->cvarstrings[i] = sv_instcvars[i]->string;
+	}
+}
+
+static void SV_LoadCvars (serverinstance_t *inst)
+{
+	int		i;
+
+	// no Cvar_Set, that would run the change notifications
+	for (i = 0; i < NUM_INSTANCECVARS; i++)
+	{
+		if (sv_instcvars[i])
+		{
+			sv_instcvars[i]->string = inst->cvarstrings[i];
+			sv_instcvars[i]->value = Q_atof (inst->cvarstrings[i]);
+		}
+	}
+}
+
+/*
+================
+SV_SwitchInstance
+
+Makes instance num the one sv_context and the game cvars belong to
+================
+*/
+void SV_SwitchInstance (int num)
+{
+	if (num == sv_current)
+		return;
+
+	SV_SaveCvars (&sv_instances[sv_current]);
+
+	// accept sockets are traded through instance 0, see Datagram_SwapListen
+	if (sv_current)
+		NET_SwapListen (sv_instances[sv_current].listen);
+	if (num)
+		NET_SwapListen (sv_instances[num].listen);
+
+	SV_LoadCvars (&sv_instances[num]);
+	sv_context = sv_instances[num].context;
+	sv_current = num;
+}
+
+/*
+================
+SV_RunInstances
+
+Runs the queued commands and a server frame for every extra instance
+================
+*/
+void SV_RunInstances (void)
+{
+	int		i;
+
+	if (!sv_numinstances)
+		return;
+
+	for (i = 1; i < MAX_INSTANCES; i++)
+	{
+		if (!sv_instances[i].inuse)
+			continue;
+
+		SV_SwitchInstance (i);
+		Cbuf_Execute ();
+		if (sv.active)
+			Host_ServerFrame ();
+	}
+
+	SV_SwitchInstance (0);
+}
+
+static void SV_StopInstance (int num)
+{
+	serverinstance_t	*inst;
+	int		i;
+
+	inst = &sv_instances[num];
+
+	SV_SwitchInstance (num);
+	Host_ShutdownServer (false);
+	for (i = 0; i < svs.maxclientslimit; i++)
+		Pool_Free (svs.clients[i].message.data);
+	free (svs.clients);
+	free (sv.edicts);
+	PR_ReleaseProgs ();
+	SV_SwitchInstance (0);
+
+	NET_CloseListen (inst->listen);
+	for (i = 0; i < NUM_INSTANCECVARS; i++)
+	{
+		if (inst->cvarstrings[i])
+			Z_Free ((void *)inst->cvarstrings[i]);
+	}
+	free (inst->context);
+	free (inst->cmdbuf);
+	memset (inst, 0, sizeof(*inst));
+	sv_numinstances--;
+}
+
+/*
+================
+SV_ShutdownInstances
+
+Disconnects the players of all extra instances, called when quitting
+================
+*/
+void SV_ShutdownInstances (void)
+{
+	int		i;
+
+	SV_SwitchInstance (0);
+	for (i = 1; i < MAX_INSTANCES; i++)
+	{
+		if (sv_instances[i].inuse)
+			SV_StopInstance (i);
+	}
+}
+
+/*
+================
+SV_InstanceStart_f
+
+instance_start <port> [maxplayers]
+================
+*/
+static void SV_InstanceStart_f (void)
+{
+	serverinstance_t	*inst;
+	struct netlisten_s	*listen;
+	int		i, num, port, maxplayers;
+
+	if (cls.state != ca_dedicated)
+	{
+		Con_Printf ("server instances need a dedicated server\n");
+		return;
+	}
+	if (Cmd_Argc () < 2 || Cmd_Argc () > 3)
+	{
+		Con_Printf ("instance_start <port> [maxplayers]\n");
+		return;
+	}
+	if (sv_current)
+	{
+		Con_Printf ("instance_start: only instance 0 can start instances\n");
+		return;
+	}
+
+	port = Q_atoi (Cmd_Argv (1));
+	if (port < 1 || port > 65534)
+	{
+		Con_Printf ("Bad port, must be between 1 and 65534\n");
+		return;
+	}
+	maxplayers = (Cmd_Argc () == 3) ? Q_atoi (Cmd_Argv (2)) : svs.maxclients;
+	maxplayers = CLAMP (1, maxplayers, MAX_SCOREBOARD);
+
+	for (num = 1; num < MAX_INSTANCES; num++)
+	{
+		if (!sv_instances[num].inuse)
+			break;
+	}
+	if (num == MAX_INSTANCES)
+	{
+		Con_Printf ("instance_start: all %i instances are in use\n", MAX_INSTANCES - 1);
+		return;
+	}
+
+	listen = NET_OpenListen (port, maxplayers);
+	if (!listen)
+		return;
+
+	if (!sv_numinstances)
+	{
+		for (i = 0; i < NUM_INSTANCECVARS; i++)
+			sv_instcvars[i] = Cvar_FindVar (sv_instcvarnames[i]);
+	}
+
+	inst = &sv_instances[num];
+	inst->context = (svcontext_t *) calloc (1, sizeof(svcontext_t));
+	inst->cmdbuf = (byte *) malloc (INSTANCE_CMDSIZE);
+	if (!inst->context || !inst->cmdbuf)
+		Sys_Error ("SV_InstanceStart_f: out of memory");
+	for (i = 0; i < NUM_INSTANCECVARS; i++)
+	{
+		if (sv_instcvars[i])
+			inst->cvarstrings[i] = Z_Strdup (sv_instcvars[i]->string);
+	}
+	inst->listen = listen;
+	inst->inuse = true;
+	sv_numinstances++;
+
+// the new context is all zeros, fill in what a fresh game needs
+	SV_SwitchInstance (num);
+
+	svs.maxclients = svs.maxclientslimit = maxplayers;
+	svs.clients = (struct client_s *) calloc (maxplayers, sizeof(client_t));
+	if (!svs.clients)
+		Sys_Error ("SV_InstanceStart_f: out of memory");
+
+	cmd_text.data = inst->cmdbuf;
+	cmd_text.maxsize = INSTANCE_CMDSIZE;
+	net_hostport = port;
+
+	if (maxplayers == 1)
+		Cvar_Set ("deathmatch", "0");
+	else if (!coop.value)
+		Cvar_Set ("deathmatch", "1");
+
+	SV_SwitchInstance (0);
+
+	Con_Printf ("instance %i: port %i, %i players\n", num, port, maxplayers);
+}
+
+/*
+================
+SV_InstanceStop_f
+================
+*/
+static void SV_InstanceStop_f (void)
+{
+	int		num;
+
+	if (Cmd_Argc () != 2)
+	{
+		Con_Printf ("instance_stop <instance>\n");
+		return;
+	}
+	if (sv_current)
+	{
+		Con_Printf ("instance_stop: only instance 0 can stop instances\n");
+		return;
+	}
+
+	num = Q_atoi (Cmd_Argv (1));
+	if (num < 1 || num >= MAX_INSTANCES || !sv_instances[num].inuse)
+	{
+		Con_Printf ("instance_stop: no instance %i\n", num);
+		return;
+	}
+
+	SV_StopInstance (num);
+	Con_Printf ("instance %i stopped\n", num);
+}
+
+/*
+================
+SV_Instance_f
+
+instance <instance> <command>: queues a command for an instance, it runs
+before that instance's next frame
+================
+*/
+static void SV_Instance_f (void)
+{
+	const char	*args;
+	int		num, prev;
+
+	if (Cmd_Argc () < 3)
+	{
+		Con_Printf ("instance <instance> <command>\n");
+		return;
+	}
+
+	num = Q_atoi (Cmd_Argv (1));
+	if (num < 0 || num >= MAX_INSTANCES || (num && !sv_instances[num].inuse))
+	{
+		Con_Printf ("instance: no instance %i\n", num);
+		return;
+	}
+
+	// skip the instance number
+	args = Cmd_Args ();
+	while (*args && *args <= ' ')
+		args++;
+	while (*args > ' ')
+		args++;
+	while (*args && *args <= ' ')
+		args++;
+
+	prev = sv_current;
+	SV_SwitchInstance (num);
+	Cbuf_AddText (args);
+	Cbuf_AddText ("\n");
+	SV_SwitchInstance (prev);
+}
+
+/*
+================
+SV_Instances_f
+================
+*/
+static void SV_Instances_f (void)
+{
+	int		i, prev;
+
+	prev = sv_current;
+	for (i = 0; i < MAX_INSTANCES; i++)
+	{
+		if (i && !sv_instances[i].inuse)
+			continue;
+
+		SV_SwitchInstance (i);
+		Con_Printf ("%2i: port %5i %-16s %3i/%i players\n", i, net_hostport,
+				sv.active ? sv.name : "(no map)", net_activeconnections, svs.maxclients);
+	}
+	SV_SwitchInstance (prev);
+}
+
+/*
+================
+SV_InitInstances
+================
+*/
+void SV_InitInstances (void)
+{
+	sv_instances[0].context = sv_context;
+	sv_instances[0].inuse = true;
+
+	Cmd_AddCommand ("instance_start", SV_InstanceStart_f);
+	Cmd_AddCommand ("instance_stop", SV_InstanceStop_f);
+	Cmd_AddCommand ("instance", SV_Instance_f);
+	Cmd_AddCommand ("instances", SV_Instances_f);
+}
@@ -23,8 +23,8 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "quakedef.h"
 
-server_t	sv;
-server_static_t	svs;
+static svcontext_t	sv_maincontext;		// instance 0, the only one outside dedicated servers
+svcontext_t	*sv_context = &sv_maincontext;
 
 static char	localmodels[MAX_MODELS][8];	// inline model names for precache
 
@@ -106,6 +106,9 @@ void SV_Init (void)
 
 	for (i=0 ; i<MAX_MODELS ; i++)
 		sprintf (localmodels[i], "*%i", i);
+
+	SV_InitInstances ();
+	SV_InitReplay ();
 }
 
 /*
@@ -335,6 +338,8 @@ void SV_ConnectClient (int clientnum)
 // set up the client_t
 	netconnection = client->netconnection;
 
+	Pool_Free (client->message.data);
+
 	if (sv.loadgame)
 		memcpy (spawn_parms, client->spawn_parms, sizeof(spawn_parms));
 	memset (client, 0, sizeof(*client));
@@ -344,8 +349,7 @@ void SV_ConnectClient (int clientnum)
 	client->active = true;
 	client->spawned = false;
 	client->edict = ent;
-	client->message.data = client->msgbuf;
-	client->message.maxsize = sizeof(client->msgbuf);
+	client->message.growsize = MAX_MSGLEN;		// buffer comes from the pool on first write
 	client->message.allowoverflow = true;		// we can catch it
 
 	if (sv.loadgame)
@@ -378,7 +382,10 @@ void SV_CheckForNewClients (void)
 //
 	while (1)
 	{
-		ret = NET_CheckNewConnections ();
+		if (SV_Replaying ())
+			ret = SV_ReplayConnection ();
+		else
+			ret = NET_CheckNewConnections ();
 		if (!ret)
 			break;
 
@@ -393,6 +400,7 @@ void SV_CheckForNewClients (void)
 
 		svs.clients[i].netconnection = ret;
 		SV_ConnectClient (i);
+		SV_RecordConnect (i);
 
 		net_activeconnections++;
 	}
@@ -919,6 +927,7 @@ qboolean SV_SendClientDatagram (client_t *client)
 	msg.data = buf;
 	msg.maxsize = sizeof(buf);
 	msg.cursize = 0;
+	msg.growsize = 0;
 
 	//johnfitz -- if client is nonlocal, use smaller max size so packets aren't fragmented
 	if (Q_strcmp(NET_QSocketGetAddressString(client->netconnection), "LOCAL") != 0)
@@ -1002,6 +1011,7 @@ void SV_SendNop (client_t *client)
 	msg.data = buf;
 	msg.maxsize = sizeof(buf);
 	msg.cursize = 0;
+	msg.growsize = 0;
 
 	MSG_WriteChar (&msg, svc_nop);
 
@@ -1019,6 +1029,8 @@ void SV_SendClientMessages (void)
 {
 	int			i;
 
+	PROF_BEGIN ("SV_SendClientMessages");
+
 // update frags, names, etc
 	SV_UpdateToReliableMessages ();
 
@@ -1083,6 +1095,8 @@ void SV_SendClientMessages (void)
 
 // clear muzzle flashes
 	SV_CleanupEnts ();
+
+	PROF_END ();
 }
 
 
@@ -1235,6 +1249,7 @@ void SV_SendReconnect (void)
 	msg.data = data;
 	msg.cursize = 0;
 	msg.maxsize = sizeof(data);
+	msg.growsize = 0;
 
 	MSG_WriteChar (&msg, svc_stufftext);
 	MSG_WriteString (&msg, "reconnect\n");
@@ -1273,6 +1288,29 @@ void SV_SaveSpawnparms (void)
 }
 
 
+// what the running games need from the hunk besides their maps: the
+// temporary arrays of SV_PushMove, and their block headers
+#define	SV_HUNKRESERVE	(MAX_EDICTS * (int)(sizeof(edict_t *) + sizeof(vec3_t)) + 1024)
+
+/*
+================
+SV_AbortSpawn
+
+Called by Host_Error, drops whatever a failed SV_SpawnServer put on the hunk
+while other server instances were running
+================
+*/
+void SV_AbortSpawn (void)
+{
+	if (!sv.hunkmark)
+		return;
+
+	Hunk_SetReserve (0);
+	Mod_ClearAbove (sv.hunkmark);
+	Hunk_FreeToLowMark (sv.hunkmark);
+	sv.hunkmark = 0;
+}
+
 /*
 ================
 SV_SpawnServer
@@ -1295,6 +1333,8 @@ void SV_SpawnServer (const char *server)
 	Con_DPrintf ("SpawnServer: %s\n",server);
 	svs.changelevel_issued = false;		// now safe to issue another
 
+	SV_RecordSpawn (server);
+
 //
 // tell all connected clients that we are going to a new level
 //
@@ -1329,10 +1369,20 @@ void SV_SpawnServer (const char *server)
 // load progs to get entity field count
 	PR_LoadProgs ();
 
+// while other server instances run the hunk is not cleared, so what this map
+// loads is there to stay; if it does not fit, only this game is lost
+	if (SV_NumInstances ())
+	{
+		sv.hunkmark = Hunk_LowMark ();
+		Hunk_SetReserve (SV_HUNKRESERVE);
+	}
+
 // allocate server memory
 	/* Host_ClearMemory() called above already cleared the whole sv structure */
 	sv.max_edicts = CLAMP (MIN_EDICTS,(int)max_edicts.value,MAX_EDICTS); //johnfitz -- max_edicts cvar
-	sv.edicts = (edict_t *) Hunk_AllocName (sv.max_edicts*pr_edict_size, "edicts");
+	sv.edicts = (edict_t *) calloc (sv.max_edicts, pr_edict_size);	// not on the hunk, server instances come and go
+	if (!sv.edicts)
+		Sys_Error ("SV_SpawnServer: couldn't allocate %i edicts", sv.max_edicts);
 
 	sv.datagram.maxsize = sizeof(sv.datagram_buf);
 	sv.datagram.cursize = 0;
@@ -1366,6 +1416,7 @@ void SV_SpawnServer (const char *server)
 	{
 		Con_Printf ("Couldn't spawn server %s\n", sv.modelname);
 		sv.active = false;
+		SV_AbortSpawn ();
 		return;
 	}
 	sv.models[1] = sv.worldmodel;
@@ -1381,7 +1432,10 @@ void SV_SpawnServer (const char *server)
 	for (i=1 ; i<sv.worldmodel->numsubmodels ; i++)
 	{
 		sv.model_precache[1+i] = localmodels[i];
-		sv.models[i+1] = Mod_ForName (localmodels[i], false);
+		if (sv.worldmodel->inlinemodels)
+			sv.models[i+1] = &sv.worldmodel->inlinemodels[i];
+		else
+			sv.models[i+1] = Mod_ForName (localmodels[i], false);
 	}
 
 //
@@ -1408,6 +1462,11 @@ void SV_SpawnServer (const char *server)
 	ED_LoadFromFile (sv.worldmodel->entities);
 
 	sv.active = true;
+	if (sv.hunkmark)
+	{
+		Hunk_SetReserve (0);
+		sv.hunkmark = 0;
+	}
 
 // all setup is completed, any further precache statements are errors
 	sv.state = ss_active;
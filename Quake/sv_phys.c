@@ -1176,6 +1176,8 @@ void SV_Physics (void)
 	int	entity_cap; // For sv_freezenonclients 
 	edict_t	*ent;
 
+	PROF_BEGIN ("SV_Physics");
+
 // let the progs know that a new frame has started
 	pr_global_struct->self = EDICT_TO_PROG(sv.edicts);
 	pr_global_struct->other = EDICT_TO_PROG(sv.edicts);
@@ -1229,4 +1231,6 @@ void SV_Physics (void)
 
 	if (!sv_freezenonclients.value) 
 	  sv.time += host_frametime;
+
+	PROF_END ();
 }
@@ -0,0 +1,758 @@
+/*
+Copyright (C) 1996-2001 Id Software, Inc.
+Copyright (C) 2002-2009 John Fitzgibbons and others
+Copyright (C) 2010-2014 QuakeSpasm developers
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+// sv_replay.c -- record a dedicated server's input and replay it offline
+
+#include "q_stdinc.h"
+#include "arch_def.h"
+#include "net_sys.h"
+#include "quakedef.h"
+#include "net_defs.h"
+#include "sv_replay.h"
+
+/*
+==============================================================================
+
+A game depends only on its map, its settings, the random numbers it
+draws and what the clients send, so that is all that gets recorded.
+"sv_record <file>" starts with the next map that begins without clients
+(a "map" command, not a changelevel) and stops when the server shuts
+down.  Every server frame stores its host_frametime and reseeds rand()
+with a recorded seed; every client message the server reads is stored
+whole, with the result NET_GetMessage returned, as are new connections.
+
+"sv_replay <file> [quit]" loads the map and feeds the recording back
+through the Replay net driver, which hands out the recorded messages and
+throws away whatever the server sends.  Frames run back to back, and at
+the end the distribution of Host_ServerFrame times is printed.
+
+Console commands typed on the recording server are not recorded.  Only
+the regular server (instance 0) is recorded.
+
+The file is a header followed by records:
+	'S' map spawn: seed, map name, game cvars
+	'F' server frame: host_frametime (a raw double), seed
+	'C' connection: client slot
+	'M' message: client slot, NET_GetMessage result, length, data
+
+==============================================================================
+*/
+
+#define	REPLAY_MAGIC	(('P'<<24)+('R'<<16)+('V'<<8)+'S')	// "SVRP"
+#define	REPLAY_VERSION	1
+
+// settings a recording restores before each map
+static const char	*replay_cvarnames[] =
+{
+	"deathmatch", "coop", "skill", "teamplay", "fraglimit", "timelimit",
+	"noexit", "samelevel", "pausable", "nomonsters", "sv_gravity",
+	"sv_friction", "sv_stopspeed", "sv_maxspeed", "sv_accelerate",
+	"sv_maxvelocity", "sv_nostep", "edgefriction", "sv_aim"
+};
+#define	NUM_REPLAYCVARS	((int)(sizeof(replay_cvarnames) / sizeof(replay_cvarnames[0])))
+
+typedef struct
+{
+	int		slot;
+	int		ret;		// NET_GetMessage result, 0 once handed out
+	int		length;
+	int		ofs;		// into replay_data
+} replaymsg_t;
+
+static FILE		*record_file;
+static qboolean	record_started;		// header written
+static int		record_frames;
+
+static FILE		*replay_file;
+static qboolean	replay_quit;
+static int		replay_driver = -1;
+
+// messages and connections of the current frame
+static replaymsg_t	*replay_msgs;
+static int		replay_nummsgs, replay_maxmsgs;
+static byte		*replay_data;
+static int		replay_datasize, replay_maxdata;
+static int		replay_connects[MAX_SCOREBOARD];
+static int		replay_numconnects, replay_nextconnect;
+
+// tick times
+static double	*replay_times;
+static int		replay_numtimes, replay_maxtimes;
+static double	replay_gametime;
+static double	replay_framestart;
+static double	replay_start;
+
+//==============================================================================
+
+static void Record_WriteLong (int l)
+{
+	l = LittleLong (l);
+	fwrite (&l, 4, 1, record_file);
+}
+
+static void Record_WriteString (const char *s)
+{
+	fwrite (s, strlen (s) + 1, 1, record_file);
+}
+
+static int Replay_ReadLong (void)
+{
+	int		l;
+
+	if (fread (&l, 4, 1, replay_file) != 1)
+		return -1;
+	return LittleLong (l);
+}
+
+static const char *Replay_ReadString (void)
+{
+	static char	string[256];
+	int		c, len;
+
+	len = 0;
+	while ((c = fgetc (replay_file)) != EOF && c)
+	{
+		if (len < (int)sizeof(string) - 1)
+			string[len++] = c;
+	}
+	string[len] = 0;
+
+	return string;
+}
+
+//==============================================================================
+
+static int Replay_CompareTimes (const void *a, const void *b)
+{
+	double	da = *(const double *)a, db = *(const double *)b;
+
+	return (da > db) - (da < db);
+}
+
+/*
+=================
+Replay_Finish
+
+Prints the tick time distribution, stops the replay and shuts the
+server down.
+=================
+*/
+static void Replay_Finish (void)
+{
+	static const double	bounds[] = { 0.125, 0.25, 0.5, 1, 2, 4, 8, 16 };
+	double	total, lo;
+	int		i, j, count, width;
+	char	bar[41];
+
+	fclose (replay_file);
+	replay_file = NULL;
+
+	Cbuf_AddText ("disconnect\n");
+	if (replay_quit)
+		Cbuf_AddText ("quit\n");
+
+	if (!replay_numtimes)
+	{
+		Con_Printf ("sv_replay: no frames replayed\n");
+		return;
+	}
+
+	for (i = 0, total = 0; i < replay_numtimes; i++)
+		total += replay_times[i];
+	qsort (replay_times, replay_numtimes, sizeof(double), Replay_CompareTimes);
+
+	Con_Printf ("\n%i server frames, %.1f s of game time in %.2f s\n",
+				replay_numtimes, replay_gametime, Sys_DoubleTime () - replay_start);
+	Con_Printf ("Host_ServerFrame ms: min %.3f  mean %.3f  p50 %.3f  p90 %.3f  p99 %.3f  max %.3f\n",
+				replay_times[0] * 1000, total * 1000 / replay_numtimes,
+				replay_times[replay_numtimes / 2] * 1000,
+				replay_times[(int)(replay_numtimes * 0.9)] * 1000,
+				replay_times[(int)(replay_numtimes * 0.99)] * 1000,
+				replay_times[replay_numtimes - 1] * 1000);
+
+	// the times are sorted, so each bucket is a run
+	for (i = 0, j = 0, lo = 0; i <= (int)(sizeof(bounds) / sizeof(bounds[0])); i++)
+	{
+		for (count = 0; j < replay_numtimes; j++, count++)
+			if (i < (int)(sizeof(bounds) / sizeof(bounds[0])) && replay_times[j] * 1000 >= bounds[i])
+				break;
+
+		width = (int)(40.0 * count / replay_numtimes + 0.5);
+		memset (bar, '#', width);
+		bar[width] = 0;
+		if (i < (int)(sizeof(bounds) / sizeof(bounds[0])))
+			Con_Printf ("%7.3f - %7.3f ms %7i %s\n", lo, bounds[i], count, bar);
+		else
+			Con_Printf ("%7.3f -         ms %7i %s\n", lo, count, bar);
+		if (i < (int)(sizeof(bounds) / sizeof(bounds[0])))
+			lo = bounds[i];
+	}
+
+	replay_numtimes = 0;
+}
+
+/*
+=================
+Replay_Abort
+=================
+*/
+static void Replay_Abort (const char *reason)
+{
+	Con_Printf ("sv_replay: %s, stopping\n", reason);
+	Replay_Finish ();
+}
+
+qboolean SV_Replaying (void)
+{
+	return replay_file != NULL;
+}
+
+/*
+=================
+SV_RecordSpawn
+
+Called at the start of SV_SpawnServer, before the settings are used.
+=================
+*/
+void SV_RecordSpawn (const char *mapname)
+{
+	int		i, seed;
+	cvar_t	*var;
+
+	if (SV_CurrentInstance ())
+		return;
+
+	if (replay_file)
+	{
+		if (fgetc (replay_file) != 'S')
+		{
+			Replay_Abort ("map change not in the recording");
+			return;
+		}
+		seed = Replay_ReadLong ();
+		if (strcmp (Replay_ReadString (), mapname))
+			Con_Printf ("sv_replay: recorded on a different map\n");
+		for (i = fgetc (replay_file); i > 0; i--)
+		{
+			var = Cvar_FindVar (Replay_ReadString ());
+			if (var)
+				Cvar_Set (var->name, Replay_ReadString ());
+			else
+				Replay_ReadString ();
+		}
+		srand (seed);
+		return;
+	}
+
+	if (!record_file)
+		return;
+
+	if (!record_started)
+	{
+		for (i = 0; i < svs.maxclients; i++)
+			if (svs.clients[i].active)
+			{
+				Con_Printf ("sv_record: waiting for a map without clients\n");
+				return;
+			}
+
+		Record_WriteLong (REPLAY_MAGIC);
+		Record_WriteLong (REPLAY_VERSION);
+		Record_WriteLong (svs.maxclients);
+		Record_WriteString (mapname);
+		record_started = true;
+		record_frames = 0;
+		Con_Printf ("sv_record: recording from %s\n", mapname);
+	}
+
+	seed = rand ();
+	srand (seed);
+
+	fputc ('S', record_file);
+	Record_WriteLong (seed);
+	Record_WriteString (mapname);
+	fputc (NUM_REPLAYCVARS, record_file);
+	for (i = 0; i < NUM_REPLAYCVARS; i++)
+	{
+		Record_WriteString (replay_cvarnames[i]);
+		Record_WriteString (Cvar_VariableString (replay_cvarnames[i]));
+	}
+}
+
+/*
+=================
+Replay_ReadFrame
+
+Reads an 'F' record and the connections and messages after it.
+=================
+*/
+static qboolean Replay_ReadFrame (void)
+{
+	replaymsg_t	*msg;
+	int		c, slot, seed;
+
+	c = fgetc (replay_file);
+	if (c == EOF)
+		return false;
+	if (c != 'F')
+	{
+		ungetc (c, replay_file);
+		Replay_Abort ("expected a server frame");
+		return false;
+	}
+
+	if (fread (&host_frametime, sizeof(double), 1, replay_file) != 1)
+		return false;
+	seed = Replay_ReadLong ();
+
+	replay_nummsgs = replay_datasize = 0;
+	replay_numconnects = replay_nextconnect = 0;
+
+	while ((c = fgetc (replay_file)) != EOF)
+	{
+		if (c == 'C')
+		{
+			slot = fgetc (replay_file);
+			if (replay_numconnects < MAX_SCOREBOARD)
+				replay_connects[replay_numconnects++] = slot;
+		}
+		else if (c == 'M')
+		{
+			if (replay_nummsgs == replay_maxmsgs)
+			{
+				replay_maxmsgs = q_max(64, replay_maxmsgs * 2);
+				replay_msgs = (replaymsg_t *) realloc (replay_msgs, replay_maxmsgs * sizeof(replaymsg_t));
+				if (!replay_msgs)
+					Sys_Error ("Replay_ReadFrame: out of memory");
+			}
+			msg = &replay_msgs[replay_nummsgs++];
+			msg->slot = fgetc (replay_file);
+			msg->ret = (signed char) fgetc (replay_file);
+			msg->length = Replay_ReadLong ();
+			if (msg->length < 0 || msg->length > NET_MAXMESSAGE)
+			{
+				Replay_Abort ("bad message");
+				return false;
+			}
+			if (replay_datasize + msg->length > replay_maxdata)
+			{
+				replay_maxdata = q_max(replay_datasize + msg->length, replay_maxdata * 2);
+				replay_data = (byte *) realloc (replay_data, replay_maxdata);
+				if (!replay_data)
+					Sys_Error ("Replay_ReadFrame: out of memory");
+			}
+			msg->ofs = replay_datasize;
+			if (fread (replay_data + replay_datasize, 1, msg->length, replay_file) != (size_t)msg->length)
+				return false;
+			replay_datasize += msg->length;
+		}
+		else
+		{
+			ungetc (c, replay_file);
+			break;
+		}
+	}
+
+	srand (seed);
+	return true;
+}
+
+/*
+=================
+SV_RecordFrame
+
+Called at the start of Host_ServerFrame.  When replaying, sets up the
+next recorded frame, or returns false at the end of the recording.
+=================
+*/
+qboolean SV_RecordFrame (void)
+{
+	int		seed;
+
+	if (SV_CurrentInstance ())
+		return true;
+
+	if (replay_file)
+	{
+		if (!Replay_ReadFrame ())
+		{
+			if (replay_file)
+				Replay_Finish ();
+			return false;
+		}
+		replay_gametime += host_frametime;
+		replay_framestart = Sys_DoubleTime ();
+		return true;
+	}
+
+	if (record_file && record_started)
+	{
+		seed = rand ();
+		srand (seed);
+
+		fputc ('F', record_file);
+		fwrite (&host_frametime, sizeof(double), 1, record_file);
+		Record_WriteLong (seed);
+		record_frames++;
+	}
+
+	return true;
+}
+
+/*
+=================
+SV_RecordFrameEnd
+=================
+*/
+void SV_RecordFrameEnd (void)
+{
+	if (!replay_file || SV_CurrentInstance ())
+		return;
+
+	if (replay_numtimes == replay_maxtimes)
+	{
+		replay_maxtimes = q_max(4096, replay_maxtimes * 2);
+		replay_times = (double *) realloc (replay_times, replay_maxtimes * sizeof(double));
+		if (!replay_times)
+			Sys_Error ("SV_RecordFrameEnd: out of memory");
+	}
+	replay_times[replay_numtimes++] = Sys_DoubleTime () - replay_framestart;
+}
+
+/*
+=================
+SV_RecordConnect
+
+Called after SV_ConnectClient.
+=================
+*/
+void SV_RecordConnect (int clientnum)
+{
+	if (SV_CurrentInstance ())
+		return;
+
+	if (replay_file)
+	{
+		if (replay_nextconnect && clientnum != replay_connects[replay_nextconnect - 1])
+			Con_Printf ("sv_replay: client %i connected in slot %i\n", replay_connects[replay_nextconnect - 1], clientnum);
+		return;
+	}
+
+	if (record_file && record_started)
+	{
+		fputc ('C', record_file);
+		fputc (clientnum, record_file);
+	}
+}
+
+/*
+=================
+SV_RecordMessage
+
+Called after every NET_GetMessage of SV_ReadClientMessage, with the
+message in net_message.
+=================
+*/
+void SV_RecordMessage (int clientnum, int ret)
+{
+	if (!ret || !record_file || !record_started || SV_CurrentInstance ())
+		return;
+
+	fputc ('M', record_file);
+	fputc (clientnum, record_file);
+	fputc (ret, record_file);
+	if (ret > 0)
+	{
+		Record_WriteLong (net_message.cursize);
+		fwrite (net_message.data, 1, net_message.cursize, record_file);
+	}
+	else
+		Record_WriteLong (0);
+}
+
+/*
+=================
+SV_ReplayConnection
+
+Stands in for NET_CheckNewConnections during a replay.
+=================
+*/
+struct qsocket_s *SV_ReplayConnection (void)
+{
+	qsocket_t	*sock;
+
+	if (replay_nextconnect >= replay_numconnects)
+		return NULL;
+	replay_nextconnect++;
+
+	net_driverlevel = replay_driver;
+	sock = NET_NewQSocket ();
+	if (!sock)
+	{
+		Con_Printf ("sv_replay: no free sockets\n");
+		return NULL;
+	}
+	q_strlcpy (sock->address, "replay", sizeof(sock->address));
+
+	return sock;
+}
+
+/*
+=================
+SV_RecordShutdown
+
+Called from Host_ShutdownServer.
+=================
+*/
+void SV_RecordShutdown (void)
+{
+	if (SV_CurrentInstance ())
+		return;
+
+	if (replay_file)
+		Replay_Abort ("server shut down");
+
+	if (record_file && record_started)
+	{
+		fclose (record_file);
+		record_file = NULL;
+		Con_Printf ("sv_record: %i frames recorded\n", record_frames);
+	}
+}
+
+//==============================================================================
+
+static void SV_Record_f (void)
+{
+	char	name[MAX_OSPATH];
+
+	if (Cmd_Argc () != 2)
+	{
+		Con_Printf ("sv_record <file> : record client input from the next map\n");
+		return;
+	}
+	if (!isDedicated)
+	{
+		Con_Printf ("sv_record only works on a dedicated server\n");
+		return;
+	}
+	if (record_file)
+	{
+		Con_Printf ("Already recording, use sv_stoprecord first\n");
+		return;
+	}
+
+	q_snprintf (name, sizeof(name), "%s/%s", com_gamedir, Cmd_Argv (1));
+	COM_AddExtension (name, ".svr", sizeof(name));
+	record_file = fopen (name, "wb");
+	if (!record_file)
+	{
+		Con_Printf ("ERROR: couldn't create %s\n", name);
+		return;
+	}
+	record_started = false;
+
+	Con_Printf ("Recording to %s when the next map starts\n", name);
+}
+
+static void SV_StopRecord_f (void)
+{
+	if (!record_file)
+	{
+		Con_Printf ("Not recording\n");
+		return;
+	}
+
+	fclose (record_file);
+	record_file = NULL;
+	if (record_started)
+		Con_Printf ("sv_record: %i frames recorded\n", record_frames);
+}
+
+static void SV_Replay_f (void)
+{
+	char	name[MAX_OSPATH];
+	char	mapname[MAX_QPATH];
+	int		maxclients, i;
+
+	if (Cmd_Argc () < 2)
+	{
+		Con_Printf ("sv_replay <file> [quit] : replay a recorded server as fast as possible\n");
+		return;
+	}
+	if (!isDedicated)
+	{
+		Con_Printf ("sv_replay only works on a dedicated server\n");
+		return;
+	}
+	if (replay_file)
+	{
+		Con_Printf ("Already replaying\n");
+		return;
+	}
+	if (SV_CurrentInstance ())
+	{
+		Con_Printf ("sv_replay only runs on the first server instance\n");
+		return;
+	}
+
+	for (i = 0; i < net_numdrivers; i++)
+		if (net_drivers[i].Init == Replay_Init)
+			replay_driver = i;
+	if (replay_driver < 0)
+	{
+		Con_Printf ("sv_replay: no replay net driver\n");
+		return;
+	}
+
+	q_snprintf (name, sizeof(name), "%s/%s", com_gamedir, Cmd_Argv (1));
+	COM_AddExtension (name, ".svr", sizeof(name));
+	replay_file = fopen (name, "rb");
+	if (!replay_file)
+	{
+		Con_Printf ("ERROR: couldn't open %s\n", name);
+		return;
+	}
+
+	if (Replay_ReadLong () != REPLAY_MAGIC || Replay_ReadLong () != REPLAY_VERSION)
+	{
+		Con_Printf ("%s is not a server recording\n", name);
+		fclose (replay_file);
+		replay_file = NULL;
+		return;
+	}
+	maxclients = Replay_ReadLong ();
+	q_strlcpy (mapname, Replay_ReadString (), sizeof(mapname));
+	replay_quit = (Cmd_Argc () > 2 && !q_strcasecmp (Cmd_Argv (2), "quit"));
+
+	// SV_RecordShutdown must not take the old server's shutdown for
+	// the end of the replay
+	if (sv.active)
+	{
+		FILE	*f = replay_file;
+		replay_file = NULL;
+		Host_ShutdownServer (false);
+		replay_file = f;
+	}
+
+	replay_numtimes = 0;
+	replay_gametime = 0;
+	replay_start = Sys_DoubleTime ();
+
+	Cmd_ExecuteString (va("maxplayers %i", maxclients), src_command);
+	Cmd_ExecuteString (va("map %s", mapname), src_command);
+}
+
+void SV_InitReplay (void)
+{
+	Cmd_AddCommand ("sv_record", SV_Record_f);
+	Cmd_AddCommand ("sv_stoprecord", SV_StopRecord_f);
+	Cmd_AddCommand ("sv_replay", SV_Replay_f);
+}
+
+/*
+==============================================================================
+
+REPLAY NET DRIVER
+
+Only ever holds the sockets SV_ReplayConnection makes.  Init fails so
+the driver is left out of listening, host searches and connects.
+
+==============================================================================
+*/
+
+int Replay_Init (void)
+{
+	return -1;
+}
+
+void Replay_Listen (qboolean state)
+{
+}
+
+void Replay_SearchForHosts (qboolean xmit)
+{
+}
+
+qsocket_t *Replay_Connect (const char *host)
+{
+	return NULL;
+}
+
+qsocket_t *Replay_CheckNewConnections (void)
+{
+	return NULL;
+}
+
+int Replay_GetMessage (qsocket_t *sock)
+{
+	replaymsg_t	*msg;
+	int		i, slot, ret;
+
+	for (slot = 0; slot < svs.maxclients; slot++)
+		if (svs.clients[slot].netconnection == sock)
+			break;
+
+	for (i = 0, msg = replay_msgs; i < replay_nummsgs; i++, msg++)
+	{
+		if (msg->slot != slot || !msg->ret)
+			continue;
+
+		ret = msg->ret;
+		msg->ret = 0;
+		if (ret > 0)
+		{
+			SZ_Clear (&net_message);
+			SZ_Write (&net_message, replay_data + msg->ofs, msg->length);
+		}
+		return ret;
+	}
+
+	return 0;
+}
+
+int Replay_SendMessage (qsocket_t *sock, sizebuf_t *data)
+{
+	return 1;
+}
+
+int Replay_SendUnreliableMessage (qsocket_t *sock, sizebuf_t *data)
+{
+	return 1;
+}
+
+qboolean Replay_CanSendMessage (qsocket_t *sock)
+{
+	return true;
+}
+
+qboolean Replay_CanSendUnreliableMessage (qsocket_t *sock)
+{
+	return true;
+}
+
+void Replay_Close (qsocket_t *sock)
+{
+}
+
+void Replay_Shutdown (void)
+{
+}
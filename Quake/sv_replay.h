@@ -0,0 +1,39 @@
+/*
+Copyright (C) 1996-2001 Id Software, Inc.
+Copyright (C) 2010-2014 QuakeSpasm developers
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#ifndef __SV_REPLAY_H
+#define __SV_REPLAY_H
+
+// sv_replay.h -- the net driver sv_replay feeds recorded client messages through
+int		Replay_Init (void);
+void		Replay_Listen (qboolean state);
+void		Replay_SearchForHosts (qboolean xmit);
+qsocket_t	*Replay_Connect (const char *host);
+qsocket_t	*Replay_CheckNewConnections (void);
+int		Replay_GetMessage (qsocket_t *sock);
+int		Replay_SendMessage (qsocket_t *sock, sizebuf_t *data);
+int		Replay_SendUnreliableMessage (qsocket_t *sock, sizebuf_t *data);
+qboolean	Replay_CanSendMessage (qsocket_t *sock);
+qboolean	Replay_CanSendUnreliableMessage (qsocket_t *sock);
+void		Replay_Close (qsocket_t *sock);
+void		Replay_Shutdown (void);
+
+#endif	/* __SV_REPLAY_H */
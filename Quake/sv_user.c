@@ -492,6 +492,7 @@ qboolean SV_ReadClientMessage (void)
 	{
 nextmsg:
 		ret = NET_GetMessage (host_client->netconnection);
+		SV_RecordMessage (host_client - svs.clients, ret);
 		if (ret == -1)
 		{
 			Sys_Printf ("SV_ReadClientMessage: NET_GetMessage failed\n");
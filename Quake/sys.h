@@ -60,6 +60,13 @@ const char *Sys_ConsoleInput (void);
 void Sys_Sleep (unsigned long msecs);
 // yield for about 'msecs' milliseconds.
 
+void Sys_WatchSocket (int sock, qboolean watch);
+// add or remove a socket from the set Sys_WaitForEvents wakes up on
+
+qboolean Sys_WaitForEvents (double timeout);
+// dedicated server: block until a watched socket or stdin has input or
+// 'timeout' seconds pass.  returns false if it timed out.
+
 void Sys_SendKeyEvents (void);
 // Perform Key_Event () callbacks until the input que is empty
 
@@ -37,6 +37,9 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #ifdef DO_USERDIRS
 #include <pwd.h>
 #endif
+#ifdef __linux__
+#include <sys/epoll.h>
+#endif
 
 #if defined(SDL_FRAMEWORK) || defined(NO_SDL_CONFIG)
 #if defined(USE_SDL2)
@@ -50,6 +53,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 
 qboolean		isDedicated;
+qboolean		isHeadless;
 cvar_t		sys_throttle = {"sys_throttle", "0.02", CVAR_ARCHIVE};
 
 #define	MAX_HANDLES		32	/* johnfitz -- was 10 */
@@ -467,6 +471,112 @@ void Sys_Sleep (unsigned long msecs)
 	SDL_Delay (msecs);
 }
 
+#ifdef __linux__
+static int	sys_epollfd = -1;
+
+static void Sys_InitEpoll (void)
+{
+	struct epoll_event	ev;
+
+	sys_epollfd = epoll_create1 (EPOLL_CLOEXEC);
+	if (sys_epollfd == -1)
+		Sys_Error ("epoll_create1: %s", strerror (errno));
+
+	// edge triggered, so data left for the next tick doesn't keep waking us
+	memset (&ev, 0, sizeof(ev));
+	ev.events = EPOLLIN | EPOLLET;
+	ev.data.fd = 0;
+	epoll_ctl (sys_epollfd, EPOLL_CTL_ADD, 0, &ev);	// fails harmlessly if stdin is /dev/null
+}
+
+void Sys_WatchSocket (int sock, qboolean watch)
+{
+	struct epoll_event	ev;
+
+	if (!isDedicated)
+		return;
+	if (sys_epollfd == -1)
+		Sys_InitEpoll ();
+
+	memset (&ev, 0, sizeof(ev));
+	ev.events = EPOLLIN | EPOLLET;
+	ev.data.fd = sock;
+	if (epoll_ctl (sys_epollfd, watch ? EPOLL_CTL_ADD : EPOLL_CTL_DEL, sock, &ev) == -1 && watch)
+		Con_DPrintf ("Sys_WatchSocket: %s\n", strerror (errno));
+}
+
+qboolean Sys_WaitForEvents (double timeout)
+{
+	struct epoll_event	events[16];
+	int		n;
+
+	if (sys_epollfd == -1)
+		Sys_InitEpoll ();
+
+	n = epoll_wait (sys_epollfd, events, sizeof(events) / sizeof(events[0]), (int) ceil (timeout * 1000));
+	return n > 0;
+}
+#else
+#define MAX_WATCHED_SOCKETS	16
+
+static int	sys_watchedsockets[MAX_WATCHED_SOCKETS];
+static int	sys_numwatchedsockets;
+
+void Sys_WatchSocket (int sock, qboolean watch)
+{
+	int		i;
+
+	if (!isDedicated)
+		return;
+
+	for (i = 0; i < sys_numwatchedsockets; i++)
+	{
+		if (sys_watchedsockets[i] == sock)
+			break;
+	}
+
+	if (!watch)
+	{
+		if (i < sys_numwatchedsockets)
+			sys_watchedsockets[i] = sys_watchedsockets[--sys_numwatchedsockets];
+	}
+	else if (i == sys_numwatchedsockets)
+	{
+		if (sys_numwatchedsockets == MAX_WATCHED_SOCKETS)
+			Con_DPrintf ("Sys_WatchSocket: too many sockets\n");
+		else
+			sys_watchedsockets[sys_numwatchedsockets++] = sock;
+	}
+}
+
+qboolean Sys_WaitForEvents (double timeout)
+{
+	fd_set		set;
+	struct timeval	tv;
+	int		i, maxfd;
+
+	// no epoll: select is level triggered, so stdin is only watched when it
+	// is a terminal, a closed pipe would wake us up all the time
+	FD_ZERO (&set);
+	maxfd = -1;
+	if (isatty (0))
+	{
+		FD_SET (0, &set);
+		maxfd = 0;
+	}
+	for (i = 0; i < sys_numwatchedsockets; i++)
+	{
+		FD_SET (sys_watchedsockets[i], &set);
+		maxfd = q_max (maxfd, sys_watchedsockets[i]);
+	}
+
+	tv.tv_sec = (long) timeout;
+	tv.tv_usec = (long) ((timeout - tv.tv_sec) * 1000000);
+
+	return select (maxfd + 1, &set, NULL, NULL, &tv) > 0;
+}
+#endif
+
 void Sys_SendKeyEvents (void)
 {
 	IN_SendKeyEvents();
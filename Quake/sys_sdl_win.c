@@ -42,6 +42,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 
 qboolean		isDedicated;
+qboolean		isHeadless;
 qboolean	Win95, Win95old, WinNT, WinVista;
 cvar_t		sys_throttle = {"sys_throttle", "0.02", CVAR_ARCHIVE};
 
@@ -437,6 +438,18 @@ void Sys_Sleep (unsigned long msecs)
 	SDL_Delay (msecs);
 }
 
+void Sys_WatchSocket (int sock, qboolean watch)
+{
+}
+
+qboolean Sys_WaitForEvents (double timeout)
+{
+	// no sockets are watched here: sleep it out and report a timeout, so
+	// an idle server keeps its once a second frames
+	SDL_Delay ((Uint32) ceil (timeout * 1000));
+	return false;
+}
+
 void Sys_SendKeyEvents (void)
 {
 	IN_SendKeyEvents();
@@ -854,7 +854,8 @@ void V_RenderView (void)
 {
 	if (con_forcedup)
 	{
-		vkCmdBeginRenderPass(vulkan_globals.command_buffer, &vulkan_globals.main_render_pass_begin_info, VK_SUBPASS_CONTENTS_INLINE);
+		if (!isHeadless)
+			vkCmdBeginRenderPass(vulkan_globals.command_buffer, &vulkan_globals.main_render_pass_begin_info, VK_SUBPASS_CONTENTS_INLINE);
 		return;
 	}
 
@@ -867,7 +868,8 @@ void V_RenderView (void)
 
 	R_RenderView ();
 
-	V_PolyBlend (); //johnfitz -- moved here from R_Renderview ();
+	if (!isHeadless)
+		V_PolyBlend (); //johnfitz -- moved here from R_Renderview ();
 }
 
 /*
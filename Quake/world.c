@@ -181,20 +181,9 @@ ENTITY AREA CHECKING
 ===============================================================================
 */
 
-typedef struct areanode_s
-{
-	int		axis;		// -1 = leaf node
-	float	dist;
-	struct areanode_s	*children[2];
-	link_t	trigger_edicts;
-	link_t	solid_edicts;
-} areanode_t;
-
-#define	AREA_DEPTH	4
-#define	AREA_NODES	32
-
-static	areanode_t	sv_areanodes[AREA_NODES];
-static	int			sv_numareanodes;
+// the area nodes belong to a server instance, see svcontext_t
+#define	sv_areanodes	(sv_context->areanodes)
+#define	sv_numareanodes	(sv_context->numareanodes)
 
 /*
 ===============
@@ -860,6 +849,8 @@ trace_t SV_Move (vec3_t start, vec3_t mins, vec3_t maxs, vec3_t end, int type, e
 	moveclip_t	clip;
 	int			i;
 
+	COUNT (CNT_TRACES, 1);
+
 	memset ( &clip, 0, sizeof ( moveclip_t ) );
 
 // clip to world
@@ -303,6 +303,8 @@ int		hunk_high_used;
 qboolean	hunk_tempactive;
 int		hunk_tempmark;
 
+static int	hunk_reserve;		// see Hunk_SetReserve
+
 /*
 ==============
 Hunk_Check
@@ -438,8 +440,12 @@ void *Hunk_AllocName (int size, const char *name)
 
 	size = sizeof(hunk_t) + ((size+15)&~15);
 
-	if (hunk_size - hunk_low_used - hunk_high_used < size)
+	if (hunk_size - hunk_low_used - hunk_high_used < size + hunk_reserve)
+	{
+		if (hunk_reserve)
+			Host_Error ("Hunk_Alloc: failed on %i bytes, %i are kept free", size, hunk_reserve);
 		Sys_Error ("Hunk_Alloc: failed on %i bytes",size);
+	}
 
 	h = (hunk_t *)(hunk_base + hunk_low_used);
 	hunk_low_used += size;
@@ -478,6 +484,20 @@ void Hunk_FreeToLowMark (int mark)
 	hunk_low_used = mark;
 }
 
+/*
+===================
+Hunk_SetReserve
+
+While a reserve is set, an allocation that would leave less than that free
+between the low and the high hunk is a Host_Error instead of a Sys_Error.
+SV_SpawnServer sets one while other server instances share the hunk.
+===================
+*/
+void Hunk_SetReserve (int size)
+{
+	hunk_reserve = size;
+}
+
 int	Hunk_HighMark (void)
 {
 	if (hunk_tempactive)
@@ -527,8 +547,10 @@ void *Hunk_HighAllocName (int size, const char *name)
 
 	size = sizeof(hunk_t) + ((size+15)&~15);
 
-	if (hunk_size - hunk_low_used - hunk_high_used < size)
+	if (hunk_size - hunk_low_used - hunk_high_used < size + hunk_reserve)
 	{
+		if (hunk_reserve)
+			Host_Error ("Hunk_HighAlloc: failed on %i bytes, %i are kept free", size, hunk_reserve);
 		Con_Printf ("Hunk_HighAlloc: failed on %i bytes\n",size);
 		return NULL;
 	}
@@ -937,6 +959,192 @@ void *Cache_Alloc (cache_user_t *c, int size, const char *name)
 
 //============================================================================
 
+/*
+==============================================================================
+
+						MESSAGE BUFFER POOL
+
+==============================================================================
+*/
+
+#define	POOLID			0x1b00f5
+#define	POOL_HEADERSIZE	16		// keeps the data 16 byte aligned
+#define	POOL_NUMCLASSES	5
+#define	POOL_MAXFREE	16		// free blocks kept per class before going back to the system
+
+typedef struct poolblock_s
+{
+	int		id;			// should be POOLID
+	int		sizeclass;
+	struct poolblock_s	*next;	// free list link
+} poolblock_t;
+
+typedef struct
+{
+	int			size;
+	int			numfree;
+	int			inuse;
+	int			peak;
+	int			allocs;		// requests satisfied from the system
+	int			reuses;		// requests satisfied from the free list
+	poolblock_t	*freelist;
+} poolclass_t;
+
+static poolclass_t	pool_classes[POOL_NUMCLASSES] =
+{
+	{512}, {2048}, {8192}, {32768}, {65536}
+};
+
+static poolblock_t *Pool_Block (const void *ptr)
+{
+	poolblock_t	*block;
+
+	block = (poolblock_t *)((byte *)ptr - POOL_HEADERSIZE);
+	if (block->id != POOLID)
+		Sys_Error ("Pool_Block: pointer without POOLID");
+	return block;
+}
+
+/*
+========================
+Pool_Alloc
+
+Returns a block of at least size bytes, rounded up to the next size class.
+The contents are not cleared.
+========================
+*/
+void *Pool_Alloc (int size)
+{
+	poolclass_t	*pc;
+	poolblock_t	*block;
+	int			i;
+
+	for (i = 0; i < POOL_NUMCLASSES; i++)
+	{
+		if (size <= pool_classes[i].size)
+			break;
+	}
+	if (i == POOL_NUMCLASSES)
+		Sys_Error ("Pool_Alloc: %i bytes is larger than the largest size class", size);
+
+	pc = &pool_classes[i];
+	if (pc->freelist)
+	{
+		block = pc->freelist;
+		pc->freelist = block->next;
+		pc->numfree--;
+		pc->reuses++;
+	}
+	else
+	{
+		block = (poolblock_t *) malloc (POOL_HEADERSIZE + pc->size);
+		if (!block)
+			Sys_Error ("Pool_Alloc: failed on allocation of %i bytes", pc->size);
+		block->id = POOLID;
+		block->sizeclass = i;
+		pc->allocs++;
+	}
+	block->next = NULL;
+
+	pc->inuse++;
+	if (pc->inuse > pc->peak)
+		pc->peak = pc->inuse;
+
+	return (byte *)block + POOL_HEADERSIZE;
+}
+
+/*
+========================
+Pool_Free
+
+Returns a block to its size class; NULL is ignored
+========================
+*/
+void Pool_Free (void *ptr)
+{
+	poolclass_t	*pc;
+	poolblock_t	*block;
+
+	if (!ptr)
+		return;
+
+	block = Pool_Block (ptr);
+	pc = &pool_classes[block->sizeclass];
+	pc->inuse--;
+
+	if (pc->numfree >= POOL_MAXFREE)
+	{
+		block->id = 0;
+		free (block);
+		return;
+	}
+
+	block->next = pc->freelist;
+	pc->freelist = block;
+	pc->numfree++;
+}
+
+/*
+========================
+Pool_Size
+
+Usable size of a pool block
+========================
+*/
+int Pool_Size (const void *ptr)
+{
+	return pool_classes[Pool_Block(ptr)->sizeclass].size;
+}
+
+/*
+========================
+Pool_Realloc
+
+Makes sure ptr can hold size bytes, moving it to a larger size class if
+needed.  Only the first used bytes are preserved.  ptr may be NULL.
+========================
+*/
+void *Pool_Realloc (void *ptr, int used, int size)
+{
+	void	*newptr;
+
+	if (!ptr)
+		return Pool_Alloc (size);
+
+	if (size <= Pool_Size (ptr))
+		return ptr;
+
+	newptr = Pool_Alloc (size);
+	if (used > 0)
+		memcpy (newptr, ptr, used);
+	Pool_Free (ptr);
+
+	return newptr;
+}
+
+/*
+========================
+Pool_Report
+========================
+*/
+void Pool_Report (void)
+{
+	poolclass_t	*pc;
+	int			i, total;
+
+	Con_Printf ("message buffer pool:\n");
+	Con_Printf ("   size  inuse   free   peak  allocs  reuses\n");
+	for (i = 0, total = 0; i < POOL_NUMCLASSES; i++)
+	{
+		pc = &pool_classes[i];
+		Con_Printf ("%7i %6i %6i %6i %7i %7i\n", pc->size, pc->inuse, pc->numfree, pc->peak, pc->allocs, pc->reuses);
+		total += (pc->inuse + pc->numfree) * (pc->size + POOL_HEADERSIZE);
+	}
+	Con_Printf ("%4.1f kb resident\n", total / 1024.0);
+}
+
+
+//============================================================================
 
 static void Memory_InitZone (memzone_t *zone, int size)
 {
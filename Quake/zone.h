@@ -56,6 +56,11 @@ Temp_??? Temp memory is used for file loading and surface caching.  The size
 of the cache memory is adjusted so that there is a minimum of 512k remaining
 for temp memory.
 
+Pool_??? Pool memory holds network message buffers.  Blocks come from the
+system heap in a few fixed size classes and are recycled through per-class
+free lists, so connections can grow their buffers on demand and hand them
+back on disconnect.
+
 
 ------ Top of Memory -------
 
@@ -103,6 +108,7 @@ char *Hunk_Strdup (const char *s, const char *name);
 
 int	Hunk_LowMark (void);
 void Hunk_FreeToLowMark (int mark);
+void Hunk_SetReserve (int size);
 
 int	Hunk_HighMark (void);
 void Hunk_FreeToHighMark (int mark);
@@ -130,5 +136,12 @@ void *Cache_Alloc (cache_user_t *c, int size, const char *name);
 
 void Cache_Report (void);
 
+void *Pool_Alloc (int size);
+void *Pool_Realloc (void *ptr, int used, int size);
+// keeps the first used bytes; ptr may be NULL
+void Pool_Free (void *ptr);
+int Pool_Size (const void *ptr);
+void Pool_Report (void);
+
 #endif	/* __ZZONE_H */
 
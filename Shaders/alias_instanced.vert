@@ -0,0 +1,52 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+#extension GL_ARB_shading_language_420pack : enable
+#extension GL_GOOGLE_include_directive : enable
+
+layout(push_constant) uniform PushConsts {
+	mat4 view_projection_matrix;
+} push_constants;
+
+layout (location = 0) in vec2 in_texcoord;
+layout (location = 1) in vec4 in_pose1_position;
+layout (location = 2) in vec3 in_pose1_normal;
+layout (location = 3) in vec4 in_pose2_position;
+layout (location = 4) in vec3 in_pose2_normal;
+
+// per instance
+layout (location = 5) in mat4 in_model_matrix;
+layout (location = 9) in vec4 in_shade_vector_blend;
+layout (location = 10) in vec4 in_light_color;
+
+layout (location = 0) out vec2 out_texcoord;
+layout (location = 1) out vec4 out_color;
+layout (location = 2) out float out_fog_frag_coord;
+
+out gl_PerVertex {
+	vec4 gl_Position;
+};
+
+float r_avertexnormal_dot(vec3 vertexnormal) // from MH
+{
+	float dot = dot(vertexnormal, in_shade_vector_blend.xyz);
+	// wtf - this reproduces anorm_dots within as reasonable a degree of tolerance as the >= 0 case
+	if (dot < 0.0)
+		return 1.0 + dot * (13.0 / 44.0);
+	else
+		return 1.0 + dot;
+}
+
+void main()
+{
+	float blend_factor = in_shade_vector_blend.w;
+
+	out_texcoord = in_texcoord;
+
+	vec4 lerped_position = mix(in_pose1_position, in_pose2_position, blend_factor);
+	vec4 model_space_position = in_model_matrix * lerped_position;
+	gl_Position = push_constants.view_projection_matrix * model_space_position;
+
+	float dot1 = r_avertexnormal_dot(in_pose1_normal);
+	float dot2 = r_avertexnormal_dot(in_pose2_normal);
+	out_color = in_light_color * vec4(vec3(mix(dot1, dot2, blend_factor)), 1.0);
+}
@@ -18,10 +18,14 @@ cl.exe /nologo bintoc.c
 %VULKAN_SDK%\bin\glslangValidator.exe -V world.vert -o Compiled/world.vspv
 %VULKAN_SDK%\bin\glslangValidator.exe -V world.frag -o Compiled/world.fspv
 %VULKAN_SDK%\bin\glslangValidator.exe -V world_fullbright.frag -o Compiled/world_fullbright.fspv
+%VULKAN_SDK%\bin\glslangValidator.exe -V world_bindless.frag -o Compiled/world_bindless.fspv
 %VULKAN_SDK%\bin\glslangValidator.exe -V alias.vert -o Compiled/alias.vspv
+%VULKAN_SDK%\bin\glslangValidator.exe -V alias_instanced.vert -o Compiled/alias_instanced.vspv
 %VULKAN_SDK%\bin\glslangValidator.exe -V alias.frag -o Compiled/alias.fspv
 %VULKAN_SDK%\bin\glslangValidator.exe -V sky_layer.vert -o Compiled/sky_layer.vspv
 %VULKAN_SDK%\bin\glslangValidator.exe -V sky_layer.frag -o Compiled/sky_layer.fspv
+%VULKAN_SDK%\bin\glslangValidator.exe -V world_cull.comp -o Compiled/world_cull.cspv
+%VULKAN_SDK%\bin\glslangValidator.exe -V particle.comp -o Compiled/particle.cspv
 
 bintoc.exe Compiled/basic.vspv basic_vert_spv > Compiled/basic_vert.c
 bintoc.exe Compiled/basic.fspv basic_frag_spv > Compiled/basic_frag.c
@@ -30,7 +34,11 @@ bintoc.exe Compiled/basic_alphatest.fspv basic_alphatest_frag_spv > Compiled/bas
 bintoc.exe Compiled/world.vspv world_vert_spv > Compiled/world_vert.c
 bintoc.exe Compiled/world.fspv world_frag_spv > Compiled/world_frag.c
 bintoc.exe Compiled/world_fullbright.fspv world_fullbright_frag_spv > Compiled/world_fullbright_frag.c
+bintoc.exe Compiled/world_bindless.fspv world_bindless_frag_spv > Compiled/world_bindless_frag.c
 bintoc.exe Compiled/alias.vspv alias_vert_spv > Compiled/alias_vert.c
+bintoc.exe Compiled/alias_instanced.vspv alias_instanced_vert_spv > Compiled/alias_instanced_vert.c
 bintoc.exe Compiled/alias.fspv alias_frag_spv > Compiled/alias_frag.c
 bintoc.exe Compiled/sky_layer.vspv sky_layer_vert_spv > Compiled/sky_layer_vert.c
 bintoc.exe Compiled/sky_layer.fspv sky_layer_frag_spv > Compiled/sky_layer_frag.c
+bintoc.exe Compiled/world_cull.cspv world_cull_comp_spv > Compiled/world_cull_comp.c
+bintoc.exe Compiled/particle.cspv particle_comp_spv > Compiled/particle_comp.c
@@ -35,13 +35,21 @@ extern unsigned char world_frag_spv[];
 extern int world_frag_spv_size;
 extern unsigned char world_fullbright_frag_spv[];
 extern int world_fullbright_frag_spv_size;
+extern unsigned char world_bindless_frag_spv[];
+extern int world_bindless_frag_spv_size;
 extern unsigned char alias_vert_spv[];
 extern int alias_vert_spv_size;
+extern unsigned char alias_instanced_vert_spv[];
+extern int alias_instanced_vert_spv_size;
 extern unsigned char alias_frag_spv[];
 extern int alias_frag_spv_size;
 extern unsigned char sky_layer_vert_spv[];
 extern int sky_layer_vert_spv_size;
 extern unsigned char sky_layer_frag_spv[];
 extern int sky_layer_frag_spv_size;
+extern unsigned char world_cull_comp_spv[];
+extern int world_cull_comp_spv_size;
+extern unsigned char particle_comp_spv[];
+extern int particle_comp_spv_size;
 
 #endif
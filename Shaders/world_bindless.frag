@@ -0,0 +1,27 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+#extension GL_ARB_shading_language_420pack : enable
+#extension GL_EXT_nonuniform_qualifier : enable
+
+layout(push_constant) uniform PushConsts {
+	layout(offset = 64) int diffuse_index;
+	int lightmap_index;
+	int fullbright_index;
+} push_constants;
+
+layout(set = 0, binding = 0) uniform sampler diffuse_sampler;
+layout(set = 0, binding = 1) uniform sampler lightmap_sampler;
+layout(set = 1, binding = 0) uniform texture2D textures[];
+
+layout (location = 0) in vec4 in_texcoords;
+
+layout (location = 0) out vec4 out_frag_color;
+
+void main() 
+{
+	vec4 diffuse = texture(sampler2D(textures[push_constants.diffuse_index], diffuse_sampler), in_texcoords.xy);
+	vec4 light = texture(sampler2D(textures[push_constants.lightmap_index], lightmap_sampler), in_texcoords.zw) * 2.0f;
+	out_frag_color = diffuse * light;
+	if (push_constants.fullbright_index >= 0)
+		out_frag_color += texture(sampler2D(textures[push_constants.fullbright_index], lightmap_sampler), in_texcoords.xy);
+}